@@ -16,6 +16,11 @@
 #include "modules/display/vis_dev_transform.h"
 #include "modules/display/bg_clipping.h"
 
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+#include "modules/util/OpRegion.h"
+#include "modules/hardcore/timer/optimer.h"
+#endif // DISPLAY_COALESCE_INVALIDATIONS
+
 #ifdef SELFTEST
 class CoreView;
 class ST_CoreViewHacks // Use this class only inside selftests!
@@ -380,6 +385,9 @@ class CoreViewContainer : public CoreView, public OpPaintListener
 #ifdef DRAG_SUPPORT
 ,public OpDragListener
 #endif // DRAG_SUPPORT
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+,public OpTimerListener
+#endif // DISPLAY_COALESCE_INVALIDATIONS
 {
 	friend class CoreView;
 public:
@@ -406,7 +414,38 @@ public:
 	 *	The rectangle is limited only to the part that is visible through top view (may be empty). */
 	virtual OpRect GetScreenRect();
 
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+	virtual void Invalidate(const OpRect& rect) {AddPendingInvalidation(rect);}
+
+	/** Statistics for one frame, from one flush of the pending invalidations
+		to the next. Meant for performance overlays. */
+	struct FrameStatistics
+	{
+		FrameStatistics() : invalidated_rects(0), painted_rects(0), painted_area(0), paint_count(0), paint_time(0) {}
+
+		unsigned int invalidated_rects;	///< Number of rects passed to Invalidate before they were coalesced.
+		unsigned int painted_rects;		///< Number of rects passed on to the OpView.
+		unsigned int painted_area;		///< Total area of the rects passed on to the OpView.
+		unsigned int paint_count;		///< Number of OnPaint calls.
+		double paint_time;				///< Time spent in OnPaint, in ms.
+	};
+
+	/** Pass the pending invalidations on to the OpView now, instead of
+		waiting for the next tick. */
+	void			FlushPendingInvalidations();
+
+	/** Returns the statistics of the frame started by the last flush that
+		had pending invalidations. Painting may still add to them. */
+	const FrameStatistics& GetFrameStatistics() const { return m_frame_stats; }
+
+	/** Returns the statistics of the last complete frame. */
+	const FrameStatistics& GetLastFrameStatistics() const { return m_last_frame_stats; }
+
+	// == OpTimerListener ======================================
+	virtual void	OnTimeOut(OpTimer* timer);
+#else
 	virtual void Invalidate(const OpRect& rect) {m_opview->Invalidate(rect);}
+#endif // DISPLAY_COALESCE_INVALIDATIONS
 
 	/** Returns TRUE if this coreview is currently being painted. */
 	BOOL			IsPainting() { return m_painter ? TRUE : FALSE; }
@@ -502,7 +541,25 @@ protected:
 #endif // TOUCH_EVENTS_SUPPORT
 	Head			plugin_intersections;///< List of PluginAreaIntersection
 
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+	OpRegion		m_pending_region;		///< Invalidated area not yet passed on to the OpView.
+	OpTimer			m_flush_timer;
+	BOOL			m_flush_scheduled;
+	unsigned int	m_pending_invalidations;
+	FrameStatistics	m_frame_stats;			///< The frame being painted now.
+	FrameStatistics	m_last_frame_stats;
+
+	virtual void	InvalidateInternal(OpRect& rect) {AddPendingInvalidation(rect);}
+
+	/** Add rect to the pending region and schedule a flush on the next
+		tick. Rects are merged into their bounding box when the region gets
+		more than DISPLAY_COALESCE_MAX_RECTS rects, or when at most
+		DISPLAY_COALESCE_AREA_WASTE percent of the bounding box is outside
+		the region. */
+	void			AddPendingInvalidation(const OpRect& rect);
+#else
 	virtual void	InvalidateInternal(OpRect& rect) {m_opview->Invalidate(rect);}
+#endif // DISPLAY_COALESCE_INVALIDATIONS
 
 	/** Update the calculated visible region for the given plugin area. */
 	void			UpdatePluginArea(const OpRect &rect, PluginAreaIntersection* info);
@@ -11,6 +11,7 @@
 #include "modules/display/coreview/coreview.h"
 #include "modules/hardcore/mem/mem_man.h"
 #include "modules/pi/OpPainter.h"
+#include "modules/pi/OpTimeInfo.h"
 #include "modules/prefs/prefsmanager/collections/pc_display.h"
 #include "modules/widgets/WidgetContainer.h"
 
@@ -74,6 +75,10 @@ CoreViewContainer::CoreViewContainer()
 	, m_last_click_button(MOUSE_BUTTON_1)
 	, m_emulated_n_click(0)
 #endif
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+	, m_flush_scheduled(FALSE)
+	, m_pending_invalidations(0)
+#endif // DISPLAY_COALESCE_INVALIDATIONS
 {
 	packed5.is_container = TRUE;
 	// We will get paint events from the OpView and call Paint, so we don't want CoreView to call paint too.
@@ -82,6 +87,9 @@ CoreViewContainer::CoreViewContainer()
 #ifdef TOUCH_EVENTS_SUPPORT
 	op_memset(&m_touch_captured_view, 0, sizeof(m_touch_captured_view));
 #endif // TOUCH_EVENTS_SUPPORT
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+	m_flush_timer.SetTimerListener(this);
+#endif // DISPLAY_COALESCE_INVALIDATIONS
 }
 
 CoreViewContainer::~CoreViewContainer()
@@ -195,6 +203,10 @@ void CoreViewContainer::OnPaint(const OpRect &rect, OpView* view)
 		view->UseDoublebuffer(g_pcdisplay->GetIntegerPref(PrefsCollectionDisplay::SmoothDisplay));
 #endif
 
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+		double start = g_op_time_info->GetRuntimeMS();
+#endif // DISPLAY_COALESCE_INVALIDATIONS
+
 		GetPainter(rect);
 		if (!m_painter)
 		{
@@ -206,12 +218,108 @@ void CoreViewContainer::OnPaint(const OpRect &rect, OpView* view)
 
 		ReleasePainter(rect);
 
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+		m_frame_stats.paint_count++;
+		m_frame_stats.paint_time += g_op_time_info->GetRuntimeMS() - start;
+#endif // DISPLAY_COALESCE_INVALIDATIONS
+
 #ifdef _PLUGIN_SUPPORT_
 		UpdateAndDeleteAllPluginAreas(rect);
 #endif
 	}
 }
 
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+
+void CoreViewContainer::AddPendingInvalidation(const OpRect& rect)
+{
+	if (rect.IsEmpty())
+		return;
+
+	m_pending_invalidations++;
+
+	if (!m_pending_region.IncludeRect(rect))
+	{
+		// OOM. Nothing is lost by invalidating the OpView directly.
+		FlushPendingInvalidations();
+		m_opview->Invalidate(rect);
+		return;
+	}
+
+	int count = m_pending_region.GetRectCount();
+	if (count > 1)
+	{
+		OpRect bounds = m_pending_region.GetUnionOfRects();
+		BOOL merge = count > DISPLAY_COALESCE_MAX_RECTS;
+
+		if (!merge)
+		{
+			// The rects in the region never overlap, so their areas add up
+			// to the covered area.
+			double covered = 0;
+			OpRegionIterator iterator = m_pending_region.GetIterator();
+			for (BOOL more = iterator.First(); more; more = iterator.Next())
+				covered += (double) iterator.GetRect().width * iterator.GetRect().height;
+
+			double total = (double) bounds.width * bounds.height;
+			merge = (total - covered) * 100 <= total * DISPLAY_COALESCE_AREA_WASTE;
+		}
+
+		if (merge)
+		{
+			m_pending_region.Empty();
+			if (!m_pending_region.IncludeRect(bounds))
+			{
+				m_opview->Invalidate(bounds);
+				return;
+			}
+		}
+	}
+
+	if (!m_flush_scheduled)
+	{
+		m_flush_scheduled = TRUE;
+		m_flush_timer.Start(DISPLAY_COALESCE_INTERVAL);
+	}
+}
+
+void CoreViewContainer::FlushPendingInvalidations()
+{
+	if (m_flush_scheduled)
+	{
+		m_flush_timer.Stop();
+		m_flush_scheduled = FALSE;
+	}
+	else if (m_pending_region.IsEmpty() && !m_pending_invalidations)
+		// Nothing to flush, so the frame being painted goes on.
+		return;
+
+	// Painting the previous flush is done by now, so this starts a new frame.
+	m_last_frame_stats = m_frame_stats;
+	m_frame_stats = FrameStatistics();
+	m_frame_stats.invalidated_rects = m_pending_invalidations;
+	m_pending_invalidations = 0;
+
+	OpRegionIterator iterator = m_pending_region.GetIterator();
+	for (BOOL more = iterator.First(); more; more = iterator.Next())
+	{
+		const OpRect& rect = iterator.GetRect();
+		m_frame_stats.painted_rects++;
+		m_frame_stats.painted_area += rect.width * rect.height;
+		m_opview->Invalidate(rect);
+	}
+	m_pending_region.Empty();
+}
+
+void CoreViewContainer::OnTimeOut(OpTimer* timer)
+{
+	OP_ASSERT(timer == &m_flush_timer);
+	m_flush_scheduled = FALSE;
+	FlushPendingInvalidations();
+}
+
+#endif // DISPLAY_COALESCE_INVALIDATIONS
+
 // == OpMoustListener ======================================
 
 #ifndef MOUSELESS
@@ -500,13 +608,23 @@ void CoreViewContainer::SetSize(INT32 w, INT32 h)
 
 void CoreViewContainer::ScrollRect(const OpRect &rect, INT32 dx, INT32 dy)
 {
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+	// The pending rects are in unscrolled coordinates.
+	FlushPendingInvalidations();
+#endif // DISPLAY_COALESCE_INVALIDATIONS
 	m_opview->ScrollRect(rect, dx, dy);
 }
 
 void CoreViewContainer::Sync()
 {
 	if (m_getpainter_count == 0 && !m_before_painting && !m_paint_lock) // Never sync while already painting.
+	{
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+		// Sync means paint now, so don't wait for the next tick.
+		FlushPendingInvalidations();
+#endif // DISPLAY_COALESCE_INVALIDATIONS
 		GetOpView()->Sync();
+	}
 }
 
 void CoreViewContainer::LockUpdate(BOOL lock)
@@ -516,6 +634,11 @@ void CoreViewContainer::LockUpdate(BOOL lock)
 
 void CoreViewContainer::Scroll(INT32 dx, INT32 dy)
 {
+#ifdef DISPLAY_COALESCE_INVALIDATIONS
+	// The pending rects are in unscrolled coordinates.
+	FlushPendingInvalidations();
+#endif // DISPLAY_COALESCE_INVALIDATIONS
+
 	// Just update the position of the children. (No onmove called)
 	MoveChildren(dx, dy, FALSE);
 
@@ -24,13 +24,26 @@
 
 #include "modules/display/styl_man.h"
 #include "modules/doc/frm_doc.h"
+#include "modules/probetools/probepoints.h"
 
 #ifdef SVG_SUPPORT
 # include "modules/svg/SVGManager.h"
 #endif // SVG_SUPPORT
 
+FontCache::FontCache() :
+	time(0),
+	num_cached_fonts(0)
+{
+	for (unsigned int i = 0; i < HASH_SIZE; ++i)
+		buckets[i] = NULL;
+}
+
 FontCache::~FontCache()
 {
+	OP_NEW_DBG("FontCache::~FontCache", "fontcache");
+	OP_DBG(("hits: %u misses: %u evictions: %u peak size: %u",
+			stats.hits, stats.misses, stats.evictions, stats.peak_size));
+
 	Clear();
 
 	// We shouldn't have any cached fonts now.
@@ -81,11 +94,55 @@ FontCache::ClearSVGFonts()
 #endif // SVG_SUPPORT
 }
 
+/* static */ UINT32
+FontCache::Hash(const FontAtt& fontatt, UINT32 scale)
+{
+	// The attributes compared by FontAtt::IsFontSpecificAttEqual.
+	UINT32 hash = fontatt.GetFontNumber();
+	hash = hash * 31 + fontatt.GetHeight();
+	hash = hash * 31 + fontatt.GetWeight();
+	hash = hash * 31 + fontatt.GetBlurRadius();
+	hash = hash * 31 + scale;
+	hash = hash * 4 + (fontatt.GetItalic() ? 2 : 0) + (fontatt.GetHasOutline() ? 1 : 0);
+	return hash ^ (hash >> 16);
+}
+
+FontCacheElement*
+FontCache::FindElement(OpFont* font) const
+{
+	FontCacheElement* font_elm;
+	if (OpStatus::IsSuccess(font_elements.GetData(font, &font_elm)))
+		return font_elm;
+	return NULL;
+}
+
+FontCacheElement*
+FontCache::FindLeastRecentlyUnused() const
+{
+	// The list is ordered by use, so the first unreferenced element
+	// from the end is the one.
+	for (FontCacheElement* font_elm = (FontCacheElement*)cached_fonts.Last();
+		 font_elm;
+		 font_elm = (FontCacheElement*)font_elm->Pred())
+		if (font_elm->ref_count == 0)
+			return font_elm;
+	return NULL;
+}
+
 void FontCache::DeleteFontCacheElement(FontCacheElement* font_elm)
 {
 	OP_ASSERT(font_elm->ref_count == 0);
 	font_elm->Out();
 
+	FontCacheElement** link = &buckets[font_elm->hash & (HASH_SIZE - 1)];
+	while (*link != font_elm)
+		link = &(*link)->hash_next;
+	*link = font_elm->hash_next;
+
+	FontCacheElement* removed;
+	OpStatus::Ignore(font_elements.Remove(font_elm->font, &removed));
+	OP_ASSERT(removed == font_elm);
+
 	// If this was the last cached instance of a font with this
 	// fontnumber, and the webfont manager no longer has a registered
 	// font with this number, the font number can be released.
@@ -106,13 +163,13 @@ void FontCache::DeleteFontCacheElement(FontCacheElement* font_elm)
 OpFont*
 FontCache::GetFont(FontAtt &fontatt, UINT32 scale, FramesDocument* doc /* = NULL */)
 {
-	FontCacheElement* font_elm = (FontCacheElement*)cached_fonts.First();
-	FontCacheElement* oldest_unused_font_elm = NULL;
 	Window* window = doc ? doc->GetWindow() : NULL;
+	UINT32 hash = Hash(fontatt, scale);
+	FontCacheElement*& bucket = buckets[hash & (HASH_SIZE - 1)];
 
-	while (font_elm)
+	for (FontCacheElement* font_elm = bucket; font_elm; font_elm = font_elm->hash_next)
 	{
-		if (!font_elm->packed.is_marked_for_purge && font_elm->fontatt.IsFontSpecificAttEqual(fontatt) && ((font_elm->packed.scale == scale))
+		if (font_elm->hash == hash && !font_elm->packed.is_marked_for_purge && font_elm->fontatt.IsFontSpecificAttEqual(fontatt) && ((font_elm->packed.scale == scale))
 #ifdef FONTCACHE_PER_WINDOW
 			&& font_elm->window == window
 #endif // FONTCACHE_PER_WINDOW
@@ -120,6 +177,7 @@ FontCache::GetFont(FontAtt &fontatt, UINT32 scale, FramesDocument* doc /* = NULL
 				font_elm->doc == doc)) // only allow the document that instantiated a webfont to access it
 		{
 			// Cache hit
+			++stats.hits;
 			++font_elm->ref_count;
 			font_elm->last_use = ++time;
 			if (font_elm != cached_fonts.First())
@@ -146,26 +204,25 @@ FontCache::GetFont(FontAtt &fontatt, UINT32 scale, FramesDocument* doc /* = NULL
 
 			return font_elm->font;
 		}
-
-		if (font_elm->ref_count == 0)
-			if (!oldest_unused_font_elm || font_elm->last_use < oldest_unused_font_elm->last_use)
-				oldest_unused_font_elm = font_elm;
-
-		font_elm = (FontCacheElement*)font_elm->Suc();
 	}
 
-	// Delete the oldest unused font, if we hit FONTCACHESIZE.
-	if (num_cached_fonts >= FONTCACHESIZE && oldest_unused_font_elm)
-	{
-		DeleteFontCacheElement(oldest_unused_font_elm);
-	}
+	++stats.misses;
+
+	// Delete the least recently used unreferenced font, if we hit FONTCACHESIZE.
+	if (num_cached_fonts >= FONTCACHESIZE)
+		if (FontCacheElement* oldest_unused_font_elm = FindLeastRecentlyUnused())
+		{
+			DeleteFontCacheElement(oldest_unused_font_elm);
+			++stats.evictions;
+		}
 
 	// Not found in cache. Create font.
 
 	OpFont* font = NULL;
 
-	if(font == NULL)
 	{
+		OP_PROBE6(OP_PROBE_FONTCACHE_CREATEFONT);
+
 		font = g_webfont_manager->CreateFont((uni_char*)fontatt.GetFaceName(),
 											   fontatt.GetSize() * scale / 100,
 											   (UINT8)fontatt.GetWeight(),
@@ -178,18 +235,26 @@ FontCache::GetFont(FontAtt &fontatt, UINT32 scale, FramesDocument* doc /* = NULL
 	if (font == NULL)
 		return NULL;
 
-	font_elm = OP_NEW(FontCacheElement, (font, fontatt, ++time, scale, window, doc));
+	FontCacheElement* font_elm = OP_NEW(FontCacheElement, (font, fontatt, ++time, scale, hash, window, doc));
 
-	if (font_elm)
+	if (font_elm && OpStatus::IsSuccess(font_elements.Add(font, font_elm)))
 	{
 		num_cached_fonts++;
+		if (num_cached_fonts > stats.peak_size)
+			stats.peak_size = num_cached_fonts;
+
 		font_elm->IntoStart(&cached_fonts);
+		font_elm->hash_next = bucket;
+		bucket = font_elm;
 		OP_ASSERT(num_cached_fonts == cached_fonts.Cardinal()); ///< Should be synchronized
 		return font;
 	}
 
 	g_memory_manager->RaiseCondition(OpStatus::ERR_NO_MEMORY);
-	OP_DELETE(font);
+	if (font_elm)
+		OP_DELETE(font_elm); // Deletes the font too.
+	else
+		OP_DELETE(font);
 	return NULL;
 }
 
@@ -198,19 +263,10 @@ FontCache::ReferenceFont(OpFont* font)
 {
 	OP_ASSERT(font);
 
-	// Try to find font in cache
-	for (FontCacheElement* font_elm = (FontCacheElement*)cached_fonts.First();
-		 font_elm;
-		 font_elm = (FontCacheElement*)font_elm->Suc())
-	{
-		if (font_elm->font == font)
-		{
-			++ font_elm->ref_count;
-			return;
-		}
-	}
-
-	OP_ASSERT(!"FontCache::ReferenceFont passed an OpFont that is not in the cache");
+	if (FontCacheElement* font_elm = FindElement(font))
+		++ font_elm->ref_count;
+	else
+		OP_ASSERT(!"FontCache::ReferenceFont passed an OpFont that is not in the cache");
 }
 
 void
@@ -219,27 +275,20 @@ FontCache::ReleaseFont(OpFont* font, BOOL force_removal)
 	if (font == NULL)
 		return;
 
-	// Try to find font in cache
-	FontCacheElement* font_elm = (FontCacheElement*)cached_fonts.First();
-	while (font_elm)
+	if (FontCacheElement* font_elm = FindElement(font))
 	{
-		if (font_elm->font == font)
-		{
-			if (font_elm->ref_count > 0)
-				--font_elm->ref_count;
+		if (font_elm->ref_count > 0)
+			--font_elm->ref_count;
 
-			// Delete the font if it is not referenced and we have more than FONTCACHESIZE fonts in the cache.
+		// Delete the font if it is not referenced and we have more than FONTCACHESIZE fonts in the cache.
 
-			OP_ASSERT(num_cached_fonts == cached_fonts.Cardinal()); ///< Should be synchronized
-			if (font_elm->ref_count == 0 && (force_removal || num_cached_fonts > FONTCACHESIZE))
-			{
-				DeleteFontCacheElement(font_elm);
-			}
-
-			return;
+		OP_ASSERT(num_cached_fonts == cached_fonts.Cardinal()); ///< Should be synchronized
+		if (font_elm->ref_count == 0 && (force_removal || num_cached_fonts > FONTCACHESIZE))
+		{
+			DeleteFontCacheElement(font_elm);
 		}
 
-		font_elm = (FontCacheElement*)font_elm->Suc();
+		return;
 	}
 
 	if(!force_removal)
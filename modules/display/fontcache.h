@@ -18,6 +18,7 @@
 #define _FONTCACHE_H_
 
 # include "modules/util/simset.h"
+# include "modules/util/OpHashTable.h"
 
 #include "modules/pi/OpFont.h"
 
@@ -29,14 +30,18 @@ class Window;
 /**
  * FontCacheElement's are stored in the font cache.
  * Every element has a reference counter and a timestamp for the last use.
+ * Elements are kept in a list ordered by use, most recently used first,
+ * and in a hash bucket chosen by the font attributes and scale.
  */
 class FontCacheElement : public Link
 {
 public:
-	FontCacheElement(OpFont* font, const FontAtt &fontatt, UINT32 time, UINT32 scale, Window* window, FramesDocument* doc) :
+	FontCacheElement(OpFont* font, const FontAtt &fontatt, UINT32 time, UINT32 scale, UINT32 hash, Window* window, FramesDocument* doc) :
 		font(font),
 		last_use(time),
 		ref_count(1),
+		hash(hash),
+		hash_next(NULL),
 		packed_init(0),
 		doc(doc)
 #ifdef FONTCACHE_PER_WINDOW
@@ -58,6 +63,12 @@ public:
 	UINT32 last_use;
 	UINT32 ref_count;
 
+	/** Hash of the font specific attributes and the scale. */
+	UINT32 hash;
+
+	/** Next element in the same hash bucket. */
+	FontCacheElement* hash_next;
+
 	union
 	{
 		struct
@@ -77,15 +88,38 @@ public:
  * FontCache. This is a cache of created OpFont-objects.
  * The size of the cache is tweakable, and it can also be tweaked so there is one cache per window,
  * instead of one global cache.
+ *
+ * Fonts are looked up by a hash of the font specific attributes and the
+ * scale, and by the OpFont when they are referenced or released. When the
+ * cache is full, the least recently used font that is not referenced is
+ * thrown out.
  */
 class FontCache
 {
 public:
+	/** Counters for how well the cache works. */
+	struct Statistics
+	{
+		Statistics() : hits(0), misses(0), evictions(0), peak_size(0) {}
+
+		/** GetFont() calls that found the font in the cache. */
+		unsigned int hits;
+
+		/** GetFont() calls that had to create the font. */
+		unsigned int misses;
+
+		/** Unreferenced fonts thrown out to make room for new ones. */
+		unsigned int evictions;
+
+		/** The largest number of fonts that have been in the cache at once. */
+		unsigned int peak_size;
+	};
+
 	/**
 	 * Constructs a new font cache.
 	 * The size will be set to FONTCACHESIZE.
 	 */
-	FontCache() : time(0), num_cached_fonts(0) {}
+	FontCache();
 
 	/**
 	 * Destroys the font cache.
@@ -161,10 +195,34 @@ public:
 	void ClearForWindow(Window *window);
 #endif // FONTCACHE_PER_WINDOW
 
+	/**
+	 * @return The hit, miss and eviction counters of the cache.
+	 */
+	const Statistics& GetStatistics() const { return stats; }
+
+	/**
+	 * @return The number of fonts in the cache, referenced or not.
+	 */
+	unsigned int GetSize() const { return num_cached_fonts; }
+
 private:
+	/** Number of hash buckets. Must be a power of two. */
+	enum { HASH_SIZE = 64 };
+
+	static UINT32 Hash(const FontAtt& fontatt, UINT32 scale);
+
+	/** @return The element of a font in the cache, or NULL. */
+	FontCacheElement* FindElement(OpFont* font) const;
+
+	/** @return The least recently used element that isn't referenced, or NULL. */
+	FontCacheElement* FindLeastRecentlyUnused() const;
+
 	UINT32 time;
 	Head cached_fonts;
 	unsigned int num_cached_fonts;
+	FontCacheElement* buckets[HASH_SIZE]; /* ARRAY OK 2012-10-19 */
+	OpPointerHashTable<OpFont, FontCacheElement> font_elements;
+	Statistics stats;
 	void DeleteFontCacheElement(FontCacheElement* font_elm);
 };
 
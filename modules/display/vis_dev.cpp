@@ -1886,6 +1886,10 @@ void VisualDevice::ScrollRect(const OpRect &rect, INT32 dx, INT32 dy)
 	if (GetView() == NULL)
 		return;
 
+#ifdef DISPLAY_OPACITY_LAYERS
+	RemoveOpacityLayers();
+#endif // DISPLAY_OPACITY_LAYERS
+
 	OpRect invalid_rect(rect);
 	BOOL enlarged = EnlargeWithIntersectingOutlines(invalid_rect);
 
@@ -2114,6 +2118,10 @@ void VisualDevice::SetScale(UINT32 scale, BOOL updatesize)
 
 	UpdateScaleOffset();
 
+#ifdef DISPLAY_OPACITY_LAYERS
+	RemoveOpacityLayers();
+#endif // DISPLAY_OPACITY_LAYERS
+
 	logfont.SetChanged();
 
 #ifdef _PLUGIN_SUPPORT_
@@ -2447,6 +2455,10 @@ void VisualDevice::Free(BOOL destructing)
 	OP_DELETE(m_cachedBB);
 	m_cachedBB = NULL;
 
+#ifdef DISPLAY_OPACITY_LAYERS
+	opacity_layers.Clear();
+#endif // DISPLAY_OPACITY_LAYERS
+
 	box_shadow_corners.Clear();
 }
 
@@ -2520,6 +2532,9 @@ VisualDevice::VisualDevice()
 	, m_layout_scale_multiplier(1)
 	, m_layout_scale_divider(1)
 	, m_cachedBB(NULL)
+#ifdef DISPLAY_OPACITY_LAYERS
+	, m_keep_opacity_layers(FALSE)
+#endif // DISPLAY_OPACITY_LAYERS
 	, m_hidden_by_lock(FALSE)
 	, m_hidden(FALSE)
 	, m_lock_count(0)
@@ -3190,6 +3205,10 @@ void VisualDevice::UpdateAll()
 
 	m_update_all = TRUE;
 
+#ifdef DISPLAY_OPACITY_LAYERS
+	RemoveOpacityLayers();
+#endif // DISPLAY_OPACITY_LAYERS
+
 	if (IsLocked())
 		return;
 
@@ -3407,6 +3426,11 @@ void VisualDevice::Update(int x, int y, int iwidth, int iheight, BOOL timed)
 	if (rect.IsEmpty())
 		return;
 
+#ifdef DISPLAY_OPACITY_LAYERS
+	if (!m_keep_opacity_layers)
+		RemoveOpacityLayers(&rect);
+#endif // DISPLAY_OPACITY_LAYERS
+
 	if (painter && timed) // We are painting and get Update from layout engine.
 	{
 		// During paint something might Update new areas. That is allright, but we know that the area we are currently
@@ -5899,26 +5923,58 @@ OP_STATUS VisualDevice::ImageOut(Image& img, const OpRect& src, const OpRect& ds
 		dsttranslated.y += translation_y;
 	}
 
+#ifdef IMG_SCALED_DECODING
+	INT32 downscale = 0;
+	OpBitmap* bitmap = img.GetDownscaledBitmap(image_listener, downscale);
+#else
 	OpBitmap* bitmap = img.GetBitmap(image_listener);
+#endif // IMG_SCALED_DECODING
 	if (bitmap)
 	{
 		OpPoint bitmapoffset = img.GetBitmapOffset();
 		OpRect bitmap_src = src;
-
-		dsttranslated.y += bitmapoffset.y * dst.height / src.height;
+#ifdef IMG_SCALED_DECODING
+		if (downscale)
+		{
+			// The bitmap is decoded to a reduced size, so the source rect
+			// and the offset are reduced too.
+			int round = (1 << downscale) - 1;
+			bitmap_src.x = src.x >> downscale;
+			bitmap_src.y = src.y >> downscale;
+			bitmap_src.width = MAX(((src.x + src.width + round) >> downscale) - bitmap_src.x, 1);
+			bitmap_src.height = MAX(((src.y + src.height + round) >> downscale) - bitmap_src.y, 1);
+			bitmapoffset.x >>= downscale;
+			bitmapoffset.y >>= downscale;
+
+			// The rounding made the source rect larger, so the destination
+			// rect must grow with it to keep the scale.
+			OpRect rounded_src(bitmap_src.x << downscale, bitmap_src.y << downscale,
+							   bitmap_src.width << downscale, bitmap_src.height << downscale);
+			dsttranslated.x -= (src.x - rounded_src.x) * dst.width / src.width;
+			dsttranslated.y -= (src.y - rounded_src.y) * dst.height / src.height;
+			dsttranslated.width = rounded_src.width * dst.width / src.width;
+			dsttranslated.height = rounded_src.height * dst.height / src.height;
+		}
+#endif // IMG_SCALED_DECODING
+		const int src_width = bitmap_src.width;
+		const int src_height = bitmap_src.height;
+		const int dst_width = dsttranslated.width;
+		const int dst_height = dsttranslated.height;
+
+		dsttranslated.y += bitmapoffset.y * dst_height / src_height;
 		if (bitmap_src.y + bitmap_src.height > (INT32)bitmap->Height())
 		{
 			int diff = bitmap_src.y + bitmap_src.height - bitmap->Height();
 			bitmap_src.height -= diff;
-			dsttranslated.height -= diff * dst.height / src.height;
+			dsttranslated.height -= diff * dst_height / src_height;
 		}
 
-		dsttranslated.x += bitmapoffset.x * dst.width / src.width;
+		dsttranslated.x += bitmapoffset.x * dst_width / src_width;
 		if (bitmap_src.x + bitmap_src.width > (INT32)bitmap->Width())
 		{
 			int diff = bitmap_src.x + bitmap_src.width - bitmap->Width();
 			bitmap_src.width -= diff;
-			dsttranslated.width -= diff * dst.width / src.width;
+			dsttranslated.width -= diff * dst_width / src_width;
 		}
 
 		OP_ASSERT(bitmap_src.width <= (INT32)bitmap->Width());
@@ -5931,6 +5987,14 @@ OP_STATUS VisualDevice::ImageOut(Image& img, const OpRect& src, const OpRect& ds
 		ResetImageInterpolation();
 
 		img.ReleaseBitmap();
+#ifdef IMG_SCALED_DECODING
+		// Have the image decoded again if it is drawn larger than the size
+		// it was decoded for. That is done from a message, and the reduced
+		// bitmap is drawn until then.
+		if (downscale)
+			img.SetDecodeSizeHint(ScaleToScreen(dst.width) * (INT32)img.Width() / src.width,
+								  ScaleToScreen(dst.height) * (INT32)img.Height() / src.height);
+#endif // IMG_SCALED_DECODING
 		return status;
 	}
 #ifdef OOM_SAFE_API
@@ -8479,6 +8543,10 @@ void VisualDevice::SetRenderingViewPos(INT32 x, INT32 y, BOOL allow_sync, const
 	if (!changed)
 		return;
 
+#ifdef DISPLAY_OPACITY_LAYERS
+	RemoveOpacityLayers();
+#endif // DISPLAY_OPACITY_LAYERS
+
 	UpdateScaleOffset();
 
 	if (!doc_manager)
@@ -8992,6 +9060,10 @@ void VisualDevice::OnVisibilityChanged(BOOL vis)
 		OP_DELETE(m_cachedBB);
 		m_cachedBB = NULL;
 
+#ifdef DISPLAY_OPACITY_LAYERS
+		opacity_layers.Clear();
+#endif // DISPLAY_OPACITY_LAYERS
+
 		box_shadow_corners.Clear();
 	}
 }
@@ -325,6 +325,31 @@ public:
 	VD_TEXT_HIGHLIGHT_TYPE m_type;
 };
 
+#ifdef DISPLAY_OPACITY_LAYERS
+
+/** Painted content of an element with animated opacity, kept between paints
+	so that the next frames only have to draw it with the new opacity.
+	See VisualDevice::BeginOpacityLayer. */
+
+class VisualDeviceLayer : public Link
+{
+public:
+	VisualDeviceLayer(const void* key) : key(key), bitmap(NULL), opacity(255), outdated(FALSE) {}
+	~VisualDeviceLayer() { OP_DELETE(bitmap); }
+
+private:
+	friend class VisualDevice;
+	const void*		key;			///< What the content is, typically the element.
+	OpRect			doc_rect;		///< Bounding box of the rect passed to BeginOpacityLayer, in document coordinates.
+	OpRect			rect;			///< Painted area. Same coordinates as VisualDeviceBackBuffer::rect.
+	OpRect			bitmap_rect;	///< Rect in the bitmap with the content.
+	OpBitmap*		bitmap;
+	UINT8			opacity;
+	BOOL			outdated;		///< Set if the content changed while it was being painted.
+};
+
+#endif // DISPLAY_OPACITY_LAYERS
+
 /** Backbuffer for layered drawing operations. (Opacity, effects and SVG's foreign object).
 	Used by VisualDevice to temporarily redirect painting to a buffer, and when done manipulate that buffer and blit it to screen. */
 
@@ -367,6 +392,12 @@ private:
 
 	// Rect in the bitmap where the user of this backbuffer should paint.
 	OpRect			bitmap_rect;
+
+#ifdef DISPLAY_OPACITY_LAYERS
+	// The layer that keeps the bitmap when the backbuffer ends, if any.
+	VisualDeviceLayer*
+					layer;
+#endif // DISPLAY_OPACITY_LAYERS
 };
 
 /** Some drawing state info used in VisualDevice::PushState and VisualDevice::PopState.
@@ -1580,6 +1611,40 @@ public:
 	/** End opacity layer. */
 	void			EndOpacity();
 
+#ifdef DISPLAY_OPACITY_LAYERS
+	/** Begins a layer of opacity whose content is kept after EndOpacity, for
+	 * content whose opacity is animated. If the kept content for key is
+	 * still valid, it is drawn with the new opacity right away and painted
+	 * is set to TRUE. The caller must then skip painting the content, and
+	 * must not call EndOpacity. Otherwise this works like BeginOpacity.
+	 *
+	 * Kept content is thrown away when anything in its area is updated,
+	 * except with UpdateOpacityLayer.
+	 *
+	 * @param key Identifies the content, typically the element.
+	 * @param rect A rect in document coordinates.
+	 * @param opacity value 0-255. 0 is invisible, 255 is fully solid.
+	 * @param painted Set to TRUE if the kept content was drawn.
+	 */
+	OP_STATUS		BeginOpacityLayer(const void* key, const OpRect& rect, UINT8 opacity, BOOL& painted);
+
+	/** Like Update, for an area where only the opacity of an opacity layer
+	 * changed. The content kept for other layers in the area stays valid,
+	 * except for layers that contain the changed one, which the caller must
+	 * remove with RemoveOpacityLayer. */
+	void			UpdateOpacityLayer(int x, int y, int iwidth, int iheight);
+
+	/** Throw away the content kept for key, if any. */
+	void			RemoveOpacityLayer(const void* key);
+
+	/** Throw away the content kept for all layers intersecting rect (in
+	 * document coordinates), or for all layers if rect is NULL. */
+	void			RemoveOpacityLayers(const OpRect* rect = NULL);
+
+	/** Returns TRUE if content is kept for any layer. */
+	BOOL			HasOpacityLayers() const { return !opacity_layers.Empty(); }
+#endif // DISPLAY_OPACITY_LAYERS
+
 	/** Begins a layer of effect.
 		The rect may be adjusted so that the effect is fully visible. (F.ex blur will make rect bigger with the blur radius) */
 	OP_STATUS		BeginEffect(const OpRect& rect, const DisplayEffect& display_effect);
@@ -2060,6 +2125,13 @@ public:
 
 protected:
 	Head			backbuffers;		///< List of VisualDeviceBackBuffer
+#ifdef DISPLAY_OPACITY_LAYERS
+	AutoDeleteHead	opacity_layers;		///< List of VisualDeviceLayer, most recently used first
+	BOOL			m_keep_opacity_layers;	///< Set while updating from UpdateOpacityLayer
+
+	/** Draw the kept content of layer with its opacity. */
+	void			DrawOpacityLayer(VisualDeviceLayer* layer);
+#endif // DISPLAY_OPACITY_LAYERS
 	Head			outlines;			///< List of VisualDeviceOutline
 	OpPointerHashTable<HTML_Element, VisualDeviceOutline>
 					outlines_hash;		///< Hashtable representation of outlines with element identifiers
@@ -39,6 +39,9 @@ VisualDeviceBackBuffer::VisualDeviceBackBuffer()
 	, use_painter_opacity(FALSE)
 	, display_effect(DisplayEffect::EFFECT_TYPE_NONE, 0)
 	, oom_fallback(FALSE)
+#ifdef DISPLAY_OPACITY_LAYERS
+	, layer(NULL)
+#endif // DISPLAY_OPACITY_LAYERS
 {
 }
 
@@ -205,6 +208,147 @@ void VisualDevice::EndOpacity()
 	EndBackbuffer(TRUE);
 }
 
+#ifdef DISPLAY_OPACITY_LAYERS
+
+OP_STATUS VisualDevice::BeginOpacityLayer(const void* key, const OpRect& rect, UINT8 opacity, BOOL& painted)
+{
+	painted = FALSE;
+
+	if (!painter)
+		return OpStatus::ERR;
+
+	/* Inside other backbuffers or transforms, what ends up in the bitmap
+	   depends on more than the content, so only keep top level layers.
+	   Printer painters don't draw bitmaps with opacity. */
+	if (backbuffers.First() || IsPrinter()
+#ifdef CSS_TRANSFORMS
+		|| HasTransform()
+#endif // CSS_TRANSFORMS
+		)
+		return BeginOpacity(rect, opacity);
+
+	OpRect bbox = ToBBox(rect);
+
+	VisualDeviceLayer* layer;
+	for (layer = (VisualDeviceLayer*) opacity_layers.First(); layer; layer = (VisualDeviceLayer*) layer->Suc())
+		if (layer->key == key)
+			break;
+
+	if (layer)
+	{
+		// The area to paint, in the same coordinates as the backbuffer rect.
+		OpRect doc_rect = bbox;
+		doc_rect.SafeIntersectWith(doc_display_rect);
+
+		OpRect screen_rect = OffsetToContainerAndScroll(ScaleToScreen(doc_rect));
+		OpRect cliprect;
+		painter->GetClipRect(&cliprect);
+		screen_rect.SafeIntersectWith(cliprect);
+		screen_rect.x -= offset_x;
+		screen_rect.y -= offset_y;
+
+		if (layer->doc_rect.Equals(bbox) && layer->rect.Contains(screen_rect))
+		{
+			FlushBackgrounds(rect);
+
+			layer->Out();
+			layer->IntoStart(&opacity_layers);
+			layer->opacity = opacity;
+			DrawOpacityLayer(layer);
+
+			painted = TRUE;
+			return OpStatus::OK;
+		}
+
+		// Moved, or more of it is visible. Paint it again.
+		layer->Out();
+		OP_DELETE(layer);
+	}
+
+	layer = OP_NEW(VisualDeviceLayer, (key));
+	if (!layer)
+		return BeginOpacity(rect, opacity);
+
+	/* Paint the content without opacity and without the background, so
+	   the bitmap can be drawn with any opacity later. */
+	VisualDeviceBackBuffer* bb;
+	if (OpStatus::IsError(BeginBackbuffer(rect, 255, TRUE, FALSE, bb)))
+	{
+		OP_DELETE(layer);
+		return BeginOpacity(rect, opacity);
+	}
+
+	if (bb->oom_fallback)
+	{
+		EndBackbuffer(FALSE);
+		OP_DELETE(layer);
+		return BeginOpacity(rect, opacity);
+	}
+
+	layer->doc_rect = bbox;
+	layer->opacity = opacity;
+	bb->layer = layer;
+
+	return OpStatus::OK;
+}
+
+void VisualDevice::DrawOpacityLayer(VisualDeviceLayer* layer)
+{
+	OpRect dst = OffsetToContainer(layer->rect);
+	if (!painter->DrawBitmapClippedOpacity(layer->bitmap, layer->bitmap_rect, OpPoint(dst.x, dst.y), layer->opacity))
+	{
+		// Not perfect, like the OOM fallback in BeginBackbuffer.
+		UINT8 pre_alpha = painter->GetPreAlpha();
+		painter->SetPreAlpha(layer->opacity);
+		BlitImage(layer->bitmap, layer->bitmap_rect, layer->rect);
+		painter->SetPreAlpha(pre_alpha);
+	}
+}
+
+void VisualDevice::UpdateOpacityLayer(int x, int y, int iwidth, int iheight)
+{
+	m_keep_opacity_layers = TRUE;
+	Update(x, y, iwidth, iheight, TRUE);
+	m_keep_opacity_layers = FALSE;
+}
+
+void VisualDevice::RemoveOpacityLayer(const void* key)
+{
+	for (VisualDeviceLayer* layer = (VisualDeviceLayer*) opacity_layers.First(); layer; layer = (VisualDeviceLayer*) layer->Suc())
+		if (layer->key == key)
+		{
+			layer->Out();
+			OP_DELETE(layer);
+			break;
+		}
+
+	for (VisualDeviceBackBuffer* bb = (VisualDeviceBackBuffer*) backbuffers.First(); bb; bb = (VisualDeviceBackBuffer*) bb->Suc())
+		if (bb->layer && bb->layer->key == key)
+			bb->layer->outdated = TRUE;
+}
+
+void VisualDevice::RemoveOpacityLayers(const OpRect* rect)
+{
+	VisualDeviceLayer* layer = (VisualDeviceLayer*) opacity_layers.First();
+	while (layer)
+	{
+		VisualDeviceLayer* next = (VisualDeviceLayer*) layer->Suc();
+		if (!rect || layer->doc_rect.Intersecting(*rect))
+		{
+			layer->Out();
+			OP_DELETE(layer);
+		}
+		layer = next;
+	}
+
+	// Layers being painted now are thrown away when they are done.
+	for (VisualDeviceBackBuffer* bb = (VisualDeviceBackBuffer*) backbuffers.First(); bb; bb = (VisualDeviceBackBuffer*) bb->Suc())
+		if (bb->layer && (!rect || bb->layer->doc_rect.Intersecting(*rect)))
+			bb->layer->outdated = TRUE;
+}
+
+#endif // DISPLAY_OPACITY_LAYERS
+
 OP_STATUS VisualDevice::BeginBackbuffer(const OpRect& rect, UINT8 opacity, BOOL clip, BOOL copy_background, VisualDeviceBackBuffer*& bb, int clip_rect_inset)
 {
 	if (!painter)
@@ -744,6 +888,37 @@ void VisualDevice::EndBackbuffer(BOOL paint)
 		}
 	}
 
+#ifdef DISPLAY_OPACITY_LAYERS
+	if (bb->layer)
+	{
+		// The layer takes over the bitmap and draws it with its opacity.
+		VisualDeviceLayer* layer = bb->layer;
+		bb->layer = NULL;
+
+		layer->bitmap = bb->bitmap;
+		layer->bitmap_rect = bb->bitmap_rect;
+		layer->rect = bb->rect;
+		bb->bitmap = NULL;
+
+		DrawOpacityLayer(layer);
+		paint = FALSE;
+
+		if (layer->outdated)
+			OP_DELETE(layer);
+		else
+		{
+			layer->IntoStart(&opacity_layers);
+
+			if (opacity_layers.Cardinal() > DISPLAY_OPACITY_LAYERS_MAX)
+			{
+				VisualDeviceLayer* last = (VisualDeviceLayer*) opacity_layers.Last();
+				last->Out();
+				OP_DELETE(last);
+			}
+		}
+	}
+#endif // DISPLAY_OPACITY_LAYERS
+
 	if (paint)
 	{
 		if (bb->has_background)
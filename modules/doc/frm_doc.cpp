@@ -11901,6 +11901,10 @@ BOOL FramesDocument::HandleInlineDataLoaded(LoadInlineElm* lie)
 					if (!css_loaded && hld_profile->GetIsOutOfMemory())
 						out_of_memory = TRUE;
 
+#ifdef CSS_SLICED_PARSING
+					// A stylesheet parsed in slices sends the load event when it is added.
+					if (!hld_profile->GetCSSCollection()->IsSlicedParsing(helm->HElm()))
+#endif // CSS_SLICED_PARSING
 					if (OpStatus::IsMemoryError(HandleEvent(ONLOAD, NULL, helm->HElm(), SHIFTKEY_NONE)))
 						out_of_memory = TRUE;
 				}
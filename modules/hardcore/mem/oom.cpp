@@ -461,6 +461,7 @@ static void flush_memory( BOOL known_stack_content, BOOL stop_loading, BOOL clea
 		mdiff += imgManager->GetUsedCacheMem();
 		g_memory_manager->SetMaxImgMemory(0);
 		imgManager->FreeMemory();
+		imgManager->FreeInvisibleImages();
 		g_memory_manager->SetMaxImgMemory(m);
 		mdiff -= imgManager->GetUsedCacheMem();
 	}
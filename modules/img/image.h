@@ -451,6 +451,9 @@ struct ImageFrameData
 					   transparent_index(0),
 					   num_colors(0),
 					   bottom_to_top(FALSE)
+#ifdef IMG_SCALED_DECODING
+					   , downscale(0)
+#endif // IMG_SCALED_DECODING
 	{
 	}
 
@@ -527,6 +530,15 @@ struct ImageFrameData
 	INT32 num_colors;
 
 	BOOL bottom_to_top;
+
+#ifdef IMG_SCALED_DECODING
+	/**
+	 * The frame is decoded to a reduced size, 1/2^downscale of the size given to
+	 * ImageDecoderListener::OnInitMainFrame(). rect and the decoded lines are in the
+	 * reduced size. Only used for images with one frame.
+	 */
+	INT32 downscale;
+#endif // IMG_SCALED_DECODING
 };
 
 /**
@@ -675,6 +687,17 @@ public:
 	 * @param imageDecoderListener will receive the information from the decoder.
 	 */
 	virtual void SetImageDecoderListener(ImageDecoderListener* imageDecoderListener) = 0;
+
+#ifdef IMG_SCALED_DECODING
+	/**
+	 * Tells the decoder the size the image is going to be shown in. A decoder which can decode to a reduced
+	 * size cheaply may then give a smaller frame, see ImageFrameData::downscale. Must be called before the
+	 * first call to DecodeData(). Decoders which can not decode to a reduced size ignore the hint.
+	 * @param width the width the image is shown in, 0 if not known.
+	 * @param height the height the image is shown in, 0 if not known.
+	 */
+	virtual void SetDecodeSizeHint(UINT32 width, UINT32 height) {}
+#endif // IMG_SCALED_DECODING
 };
 
 /**
@@ -1063,6 +1086,31 @@ public:
 	 */
 	void ReleaseBitmap();
 
+#ifdef IMG_SCALED_DECODING
+	/**
+	 * Tells the image that it is going to be shown in the given size (in screen pixels). An image which
+	 * is only shown smaller than its size may then be decoded to a reduced size, which is faster and
+	 * needs less memory. Should be called before IncVisible(). If the image is shown in several sizes,
+	 * the largest one is used. If the image is already decoded to a size smaller than needed, it is
+	 * queued to be decoded again, and the smaller bitmap is kept until that is done.
+	 * @param width the width the image is shown in.
+	 * @param height the height the image is shown in.
+	 */
+	void SetDecodeSizeHint(UINT32 width, UINT32 height);
+
+	/**
+	 * Gets an OpBitmap representing the image, which may be decoded to a reduced size, and locks it
+	 * into memory. Only for users which scale the bitmap when drawing it. All other users should use
+	 * GetBitmap(), which queues the image to be decoded in full size again if needed, and until then
+	 * gives out the reduced bitmap scaled up to the full size.
+	 * The lock is released with ReleaseBitmap().
+	 * @return the bitmap, or NULL in the same cases as GetBitmap().
+	 * @param image_listener the ImageListener that the returned bitmap will belong to.
+	 * @param downscale set to how many times the bitmap is halved compared to Width() and Height(), 0 for the full size.
+	 */
+	OpBitmap* GetDownscaledBitmap(ImageListener* image_listener, INT32& downscale);
+#endif // IMG_SCALED_DECODING
+
 	/**
 	 * Gets a tiled representation of the image, and locks the bitmap into memory.
 	 * If the original bitmap is tiny, the image code will create and cache a larger (but not too large) bitmap and return that bitmap.
@@ -1335,6 +1383,14 @@ public:
 	 */
 	virtual void FreeMemory() = 0;
 
+	/**
+	 * Frees the decoded data of all images that are neither visible nor
+	 * locked, regardless of the cache size and of grace time. Meant to be
+	 * called when memory is low. The images are decoded again from their
+	 * data when they become visible.
+	 */
+	virtual void FreeInvisibleImages() = 0;
+
 	/**
 	 * Sets the cache size and the cache policy for the ImageManager.
 	 * @param cache_size the size of the cache used by the img module in bytes.
@@ -1418,6 +1474,8 @@ public:
 #endif
 
 	virtual INT32 GetCacheSize() = 0;
+	/** @return the cache policy given to SetCacheSize(). */
+	virtual ImageCachePolicy GetCachePolicy() = 0;
 	virtual INT32 GetUsedCacheMem() = 0;
 #ifdef IMG_CACHE_MULTIPLE_ANIMATION_FRAMES
 	virtual INT32 GetAnimCacheSize() = 0;
@@ -113,7 +113,13 @@ public:
 	 * Profiles may be disposed of/deleted after a color transform was
 	 * successfully created.
 	 *
-	 * @param[out] transform The color transform.
+	 * Transforms to the device profile may be shared with other images
+	 * using a profile with the same data, and if the transform would
+	 * leave all colors as they are no transform is created at all.
+	 *
+	 * @param[out] transform The color transform. Set to NULL (with
+	 *                       OpStatus::OK returned) if the transform
+	 *                       would not change any colors.
 	 * @param[in] src The input/source profile.
 	 * @param[in] dst The output/destination profile, NULL means use the device profile.
 	 *
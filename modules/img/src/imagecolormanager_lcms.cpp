@@ -15,25 +15,75 @@
 #include "modules/img/src/imagemanagerimp.h"
 #include "modules/liblcms/include/lcms2.h"
 
+/**
+ * A transform from one profile to another, shared by the
+ * LCMS_ColorTransform objects using it. Transforms to the device profile
+ * are also kept in the cache of LCMS_ColorManager, and found again from
+ * the data of the source profile.
+ */
+class LCMS_SharedTransform : public Link
+{
+public:
+	LCMS_SharedTransform() : m_transform(0), m_identity(FALSE), m_data(NULL), m_datalen(0), m_hash(0), m_ref_count(1) {}
+
+	void AddRef() { m_ref_count++; }
+	void Release() { if (--m_ref_count == 0) OP_DELETE(this); }
+
+	BOOL Matches(UINT32 hash, const UINT8* data, unsigned datalen) const
+	{
+		return m_hash == hash && m_datalen == datalen && op_memcmp(m_data, data, datalen) == 0;
+	}
+
+	cmsHTRANSFORM m_transform;
+	/** TRUE if the transform leaves all colors as they are. */
+	BOOL m_identity;
+
+	/** The source profile data, if the transform is cached. */
+	UINT8* m_data;
+	unsigned m_datalen;
+	UINT32 m_hash;
+
+private:
+	~LCMS_SharedTransform();
+
+	/** The number of LCMS_ColorTransform and LCMS_ICCProfile objects
+		using the transform, plus one while it is in the cache. */
+	int m_ref_count;
+};
+
 class LCMS_ICCProfile : public ICCProfile
 {
 public:
-	LCMS_ICCProfile() : m_profile(0) {}
+	LCMS_ICCProfile() : m_profile(0), m_data(NULL), m_datalen(0), m_hash(0), m_cached(NULL) {}
 	virtual ~LCMS_ICCProfile();
 
+	/** @return the opened profile, opening it from the data of the cached
+		transform if it was not opened when created. 0 on OOM. */
+	cmsHPROFILE GetProfile();
+
 	cmsHPROFILE m_profile;
+
+	/** Copy of the profile data, kept to add the transform to the cache. */
+	UINT8* m_data;
+	unsigned m_datalen;
+	UINT32 m_hash;
+
+	/** The cached transform to the device profile, if the same profile
+		data has been seen before. m_profile is then only opened if the
+		profile is used for another transform, see GetProfile(). */
+	LCMS_SharedTransform* m_cached;
 };
 
 class LCMS_ColorTransform : public ImageColorTransform
 {
 public:
-	LCMS_ColorTransform() : m_transform(0) {}
+	LCMS_ColorTransform(LCMS_SharedTransform* shared) : m_shared(shared) { m_shared->AddRef(); }
 	virtual ~LCMS_ColorTransform();
 
 	void Apply(UINT32* dst, const UINT32* src, unsigned length);
 	UINT32* Apply(const UINT32* src, unsigned length);
 
-	cmsHTRANSFORM m_transform;
+	LCMS_SharedTransform* m_shared;
 };
 
 class LCMS_ColorManager : public ImageColorManager
@@ -50,33 +100,106 @@ public:
 private:
 	LCMS_ICCProfile* GetDeviceProfile();
 
+	/** Adds a transform to the device profile to the cache, removing
+		the least recently used one if the cache is full. */
+	void AddToCache(LCMS_SharedTransform* shared, LCMS_ICCProfile* src);
+
 	LCMS_ICCProfile* m_srgb_profile;
+
+	/** Cached transforms to the device profile, most recently used first. */
+	Head m_transform_cache;
 };
 
+/** Profiles larger than this are not cached, to not keep a large copy of
+	the data around. Common embedded profiles are a few kilobytes. */
+#define LCMS_MAX_CACHED_PROFILE_SIZE (64 * 1024)
+
+static UINT32 HashProfileData(const UINT8* data, unsigned datalen)
+{
+	// FNV-1a
+	UINT32 hash = 2166136261u;
+	for (unsigned i = 0; i < datalen; ++i)
+		hash = (hash ^ data[i]) * 16777619u;
+	return hash;
+}
+
+#ifdef IMG_SKIP_IDENTITY_COLOR_TRANSFORMS
+/**
+ * Checks if a transform leaves a grid of colors covering the whole
+ * color cube as they are, allowing one step for rounding.
+ */
+static BOOL IsIdentityTransform(cmsHTRANSFORM transform)
+{
+	const int steps = 9;
+	UINT32 src[steps * steps]; /* ARRAY OK 2012-11-05 timj */
+	UINT32 dst[steps * steps]; /* ARRAY OK 2012-11-05 timj */
+
+	for (int r = 0; r < steps; ++r)
+	{
+		for (int g = 0; g < steps; ++g)
+			for (int b = 0; b < steps; ++b)
+				src[g * steps + b] = (0xffu << 24) | ((r * 255 / (steps - 1)) << 16) |
+					((g * 255 / (steps - 1)) << 8) | (b * 255 / (steps - 1));
+
+		cmsDoTransform(transform, src, dst, steps * steps);
+
+		for (int i = 0; i < steps * steps; ++i)
+			for (int shift = 0; shift < 24; shift += 8)
+			{
+				int diff = (int)((src[i] >> shift) & 0xff) - (int)((dst[i] >> shift) & 0xff);
+				if (diff < -1 || diff > 1)
+					return FALSE;
+			}
+	}
+
+	return TRUE;
+}
+#endif // IMG_SKIP_IDENTITY_COLOR_TRANSFORMS
+
 ImageColorManager* ImageColorManager::Create()
 {
 	return OP_NEW(LCMS_ColorManager, ());
 }
 
+LCMS_SharedTransform::~LCMS_SharedTransform()
+{
+	OP_ASSERT(!InList());
+
+	if (m_transform)
+		cmsDeleteTransform(m_transform);
+
+	OP_DELETEA(m_data);
+}
+
 LCMS_ICCProfile::~LCMS_ICCProfile()
 {
+	if (m_cached)
+		m_cached->Release();
+
+	OP_DELETEA(m_data);
+
 	if (m_profile == 0)
 		return;
 
 	cmsCloseProfile(m_profile);
 }
 
-LCMS_ColorTransform::~LCMS_ColorTransform()
+cmsHPROFILE LCMS_ICCProfile::GetProfile()
 {
-	if (m_transform == 0)
-		return;
+	if (m_profile == 0 && m_cached)
+		m_profile = cmsOpenProfileFromMem(m_cached->m_data, m_cached->m_datalen);
+
+	return m_profile;
+}
 
-	cmsDeleteTransform(m_transform);
+LCMS_ColorTransform::~LCMS_ColorTransform()
+{
+	m_shared->Release();
 }
 
 void LCMS_ColorTransform::Apply(UINT32* dst, const UINT32* src, unsigned length)
 {
-	cmsDoTransform(m_transform, src, dst, length);
+	cmsDoTransform(m_shared->m_transform, src, dst, length);
 
 	if (dst != src)
 	{
@@ -107,6 +230,12 @@ UINT32* LCMS_ColorTransform::Apply(const UINT32* src, unsigned length)
 
 LCMS_ColorManager::~LCMS_ColorManager()
 {
+	while (LCMS_SharedTransform* shared = static_cast<LCMS_SharedTransform*>(m_transform_cache.First()))
+	{
+		shared->Out();
+		shared->Release();
+	}
+
 	OP_DELETE(m_srgb_profile);
 }
 
@@ -141,6 +270,33 @@ OP_STATUS LCMS_ColorManager::CreateProfile(ICCProfile** profile, const UINT8* da
 	if (!p)
 		return OpStatus::ERR_NO_MEMORY;
 
+	if (IMG_COLOR_TRANSFORM_CACHE_SIZE > 0 && datalen <= LCMS_MAX_CACHED_PROFILE_SIZE)
+	{
+		p->m_hash = HashProfileData(data, datalen);
+
+		for (LCMS_SharedTransform* shared = static_cast<LCMS_SharedTransform*>(m_transform_cache.First());
+			 shared; shared = static_cast<LCMS_SharedTransform*>(shared->Suc()))
+			if (shared->Matches(p->m_hash, data, datalen))
+			{
+				// Seen before, no need to parse the profile again.
+				shared->Out();
+				shared->IntoStart(&m_transform_cache);
+				shared->AddRef();
+				p->m_cached = shared;
+
+				*profile = p;
+				return OpStatus::OK;
+			}
+
+		// Keep the data, to add the transform to the cache if one is created.
+		p->m_data = OP_NEWA(UINT8, datalen);
+		if (p->m_data)
+		{
+			op_memcpy(p->m_data, data, datalen);
+			p->m_datalen = datalen;
+		}
+	}
+
 	p->m_profile = cmsOpenProfileFromMem(data, datalen);
 	if (!p->m_profile)
 	{
@@ -152,41 +308,85 @@ OP_STATUS LCMS_ColorManager::CreateProfile(ICCProfile** profile, const UINT8* da
 	return OpStatus::OK;
 }
 
-OP_STATUS LCMS_ColorManager::CreateTransform(ImageColorTransform** transform, ICCProfile* src, ICCProfile* dst)
+void LCMS_ColorManager::AddToCache(LCMS_SharedTransform* shared, LCMS_ICCProfile* src)
 {
-	LCMS_ColorTransform* xfrm = OP_NEW(LCMS_ColorTransform, ());
-	if (!xfrm)
+	shared->m_data = src->m_data;
+	shared->m_datalen = src->m_datalen;
+	shared->m_hash = src->m_hash;
+	src->m_data = NULL;
+	src->m_datalen = 0;
+
+	if ((int)m_transform_cache.Cardinal() >= IMG_COLOR_TRANSFORM_CACHE_SIZE)
 	{
-		return OpStatus::ERR_NO_MEMORY;
+		LCMS_SharedTransform* oldest = static_cast<LCMS_SharedTransform*>(m_transform_cache.Last());
+		oldest->Out();
+		oldest->Release();
 	}
 
-	do
+	shared->AddRef();
+	shared->IntoStart(&m_transform_cache);
+}
+
+OP_STATUS LCMS_ColorManager::CreateTransform(ImageColorTransform** transform, ICCProfile* src, ICCProfile* dst)
+{
+	LCMS_ICCProfile* lcms_src = static_cast<LCMS_ICCProfile*>(src);
+	LCMS_SharedTransform* shared = NULL;
+
+	if (!dst && lcms_src->m_cached)
 	{
+		shared = lcms_src->m_cached;
+		shared->AddRef();
+	}
+	else
+	{
+		shared = OP_NEW(LCMS_SharedTransform, ());
+		if (!shared)
+			return OpStatus::ERR_NO_MEMORY;
+
 		LCMS_ICCProfile* lcms_dst = static_cast<LCMS_ICCProfile*>(dst);
 		if (!lcms_dst)
 			lcms_dst = GetDeviceProfile();
 
-		if (!lcms_dst)
-			break;
-
-		cmsHPROFILE dst_profile = lcms_dst->m_profile;
-		OP_ASSERT(dst_profile);
+		// Profiles found in the cache are opened here, when used with
+		// another profile than the device profile.
+		cmsHPROFILE src_profile = lcms_src->GetProfile();
+		cmsHPROFILE dst_profile = lcms_dst ? lcms_dst->GetProfile() : 0;
+		if (src_profile && dst_profile)
+		{
+			shared->m_transform = cmsCreateTransform(src_profile, TYPE_BGRA_8,
+													 dst_profile, TYPE_BGRA_8,
+													 INTENT_PERCEPTUAL, 0);
+		}
 
-		xfrm->m_transform = cmsCreateTransform(static_cast<LCMS_ICCProfile*>(src)->m_profile, TYPE_BGRA_8,
-											   dst_profile, TYPE_BGRA_8,
-											   INTENT_PERCEPTUAL, 0);
+		if (!shared->m_transform)
+		{
+			shared->Release();
+			return OpStatus::ERR_NO_MEMORY;
+		}
 
-		if (!xfrm->m_transform)
-			break;
+#ifdef IMG_SKIP_IDENTITY_COLOR_TRANSFORMS
+		shared->m_identity = IsIdentityTransform(shared->m_transform);
+#endif // IMG_SKIP_IDENTITY_COLOR_TRANSFORMS
 
-		*transform = xfrm;
+		if (!dst && lcms_src->m_data)
+			AddToCache(shared, lcms_src);
+	}
 
+	if (shared->m_identity)
+	{
+		// The colors would stay the same, decode without a transform.
+		shared->Release();
+		*transform = NULL;
 		return OpStatus::OK;
-	} while(0);
+	}
 
-	OP_DELETE(xfrm);
+	LCMS_ColorTransform* xfrm = OP_NEW(LCMS_ColorTransform, (shared));
+	shared->Release();
+	if (!xfrm)
+		return OpStatus::ERR_NO_MEMORY;
 
-	return OpStatus::ERR_NO_MEMORY;
+	*transform = xfrm;
+	return OpStatus::OK;
 }
 
 #endif // EMBEDDED_ICC_SUPPORT && LCMS_3P_SUPPORT
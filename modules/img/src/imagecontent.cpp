@@ -79,18 +79,30 @@ void FrameElm::DecRefCount(AnimatedImageContent* animated_image_content)
 	ref_count--;
 	if (ref_count <= 0)
 	{
+#ifdef IMG_COMPACT_ANIMATION
+		// Keep the frame that the frame after a restore previous frame is
+		// drawn on.
+		FrameElm* next_elm = (FrameElm*)Suc();
+		if (next_elm && next_elm->disposal_method == DISPOSAL_METHOD_RESTORE_PREVIOUS)
+			return;
+#endif // IMG_COMPACT_ANIMATION
+		ReleaseBuffer(animated_image_content);
+	}
+}
+
+void FrameElm::ReleaseBuffer(AnimatedImageContent* animated_image_content)
+{
 #ifdef IMG_CACHE_MULTIPLE_ANIMATION_FRAMES
-		if (animated_image_content->IsLarge() || animated_image_content->NrOfRepeats() == 1)
+	if (animated_image_content->IsLarge() || animated_image_content->NrOfRepeats() == 1)
 #else
-		if (TRUE)
+	if (TRUE)
 #endif // IMG_CACHE_MULTIPLE_ANIMATION_FRAMES
-		{
-			OP_ASSERT(ref_count == 0);
-			((ImageManagerImp*)imgManager)->DecAnimMemUsed(mem_used);
-			mem_used = 0;
-			OP_DELETE(bitmap_buffer);
-			bitmap_buffer = NULL;
-		}
+	{
+		OP_ASSERT(ref_count == 0);
+		((ImageManagerImp*)imgManager)->DecAnimMemUsed(mem_used);
+		mem_used = 0;
+		OP_DELETE(bitmap_buffer);
+		bitmap_buffer = NULL;
 	}
 }
 
@@ -102,6 +114,24 @@ void FrameElm::ClearBuffer()
 	bitmap_buffer = NULL;
 }
 
+#ifdef IMG_COMPACT_ANIMATION
+void FrameElm::TakeBuffer(FrameElm* from_elm)
+{
+	OP_ASSERT(bitmap_buffer == NULL && mem_used == 0);
+	bitmap_buffer = from_elm->bitmap_buffer;
+	mem_used = from_elm->mem_used;
+	from_elm->bitmap_buffer = NULL;
+	from_elm->mem_used = 0;
+}
+
+void FrameElm::ReleaseKeptBuffer(AnimatedImageContent* animated_image_content)
+{
+	FrameElm* next_elm = (FrameElm*)Suc();
+	if (ref_count <= 0 && bitmap_buffer && next_elm && next_elm->disposal_method == DISPOSAL_METHOD_RESTORE_PREVIOUS)
+		ReleaseBuffer(animated_image_content);
+}
+#endif // IMG_COMPACT_ANIMATION
+
 ImageContentType NullImageContent::Type()
 {
 	return NULL_IMAGE_CONTENT;
@@ -243,12 +273,19 @@ void BitmapImageContent::ReleaseEffectBitmap()
 
 StaticImageContent::StaticImageContent(OpBitmap* bitmap, INT32 width, INT32 height, const OpRect& rect,
 									   BOOL transparent, BOOL alpha, BOOL interlaced, INT32 bits_per_pixel,
-									   BOOL bottom_to_top)
+									   BOOL bottom_to_top
+#ifdef IMG_SCALED_DECODING
+									   , INT32 downscale
+#endif // IMG_SCALED_DECODING
+									   )
 									   : bitmap(bitmap), bitmap_tile(NULL), bitmap_effect(NULL),
 										 rect(rect), total_width(width), total_height(height),
 										 bits_per_pixel(bits_per_pixel), last_decoded_line(0),
 										 is_transparent(transparent), is_alpha(alpha), is_interlaced(interlaced),
 										 bottom_to_top(bottom_to_top), lowest_decoded_line(0)
+#ifdef IMG_SCALED_DECODING
+										 , downscale(downscale)
+#endif // IMG_SCALED_DECODING
 {
 	OP_ASSERT(width > 0);
 	OP_ASSERT(height > 0);
@@ -273,7 +310,11 @@ ImageContentType StaticImageContent::Type()
 
 OpPoint StaticImageContent::GetBitmapOffset()
 {
+#ifdef IMG_SCALED_DECODING
+	return OpPoint(rect.x << downscale, rect.y << downscale);
+#else
 	return OpPoint(rect.x, rect.y);
+#endif // IMG_SCALED_DECODING
 }
 
 OpBitmap* StaticImageContent::GetBitmap(ImageListener* image_listener)
@@ -314,7 +355,11 @@ INT32 StaticImageContent::GetBitsPerPixel()
 INT32 StaticImageContent::GetLastDecodedLine()
 {
 	if (last_decoded_line < rect.height)
+#ifdef IMG_SCALED_DECODING
+		return MIN((last_decoded_line + rect.y) << downscale, total_height);
+#else
 		return last_decoded_line + rect.y;
+#endif // IMG_SCALED_DECODING
 	else
 		return total_height;
 }
@@ -327,6 +372,9 @@ void StaticImageContent::ReplaceBitmap(OpBitmap* new_bitmap)
 	total_height = bitmap->Height();
 	rect.width = total_width;
 	rect.height = total_height;
+#ifdef IMG_SCALED_DECODING
+	downscale = 0;
+#endif // IMG_SCALED_DECODING
 	OP_DELETE(bitmap_tile);
 	bitmap_tile = NULL;
 	last_decoded_line = total_height;
@@ -493,7 +541,11 @@ BOOL StaticImageContent::IsBottomToTop()
 UINT32 StaticImageContent::GetLowestDecodedLine()
 {
 	if (lowest_decoded_line > 0)
+#ifdef IMG_SCALED_DECODING
+		return (lowest_decoded_line + rect.y) << downscale;
+#else
 		return lowest_decoded_line + rect.y;
+#endif // IMG_SCALED_DECODING
 	else
 		return 0;
 }
@@ -1357,13 +1409,16 @@ OpBitmap* AnimatedImageContent::GetBitmap(ImageListener* image_listener)
 
 		if (OpStatus::IsError(ret_val))
 		{
-			OP_DELETE(frame_elm->bitmap_buffer);
-			frame_elm->bitmap_buffer = NULL;
+			frame_elm->ClearBuffer();
 			return NULL; // return a bitmap?
 		}
-		INT32 memused = g_op_screen_info->GetBitmapAllocationSize(total_width, total_height,
-																  TRUE, FALSE, 0);
-		frame_elm->IncMemUsed(this, memused);
+		// A buffer taken over from an earlier frame is already accounted for.
+		if (frame_elm->mem_used == 0)
+		{
+			INT32 memused = g_op_screen_info->GetBitmapAllocationSize(total_width, total_height,
+																	  TRUE, FALSE, 0);
+			frame_elm->IncMemUsed(this, memused);
+		}
 	}
 	frame_elm->ref_count++;
 	if (elm->last_frame)
@@ -1684,6 +1739,24 @@ BOOL AnimatedImageContent::CanLoop(AnimationListenerElm* elm)
 	return is_decoded && (nr_of_repeats == 0 || elm->loop_nr + 1 < nr_of_repeats);
 }
 
+#ifdef IMG_COMPACT_ANIMATION
+BOOL AnimatedImageContent::CanTakeBuffer(AnimationListenerElm* elm, FrameElm* comb_elm, FrameElm* frame_elm, BOOL is_transparent, BOOL use_alpha)
+{
+#ifdef IMG_CACHE_MULTIPLE_ANIMATION_FRAMES
+	// Frames of small animations are cached, they must be left intact.
+	if (!is_large && nr_of_repeats != 1)
+		return FALSE;
+#endif // IMG_CACHE_MULTIPLE_ANIMATION_FRAMES
+	if (frame_elm->disposal_method == DISPOSAL_METHOD_RESTORE_PREVIOUS)
+		return FALSE;
+	// The frame the listener showed last is released when the new frame is returned.
+	if (comb_elm->ref_count > (comb_elm == elm->last_frame ? 1 : 0))
+		return FALSE;
+	return (!is_transparent || comb_elm->bitmap_buffer->IsTransparent()) &&
+		(!use_alpha || comb_elm->bitmap_buffer->HasAlpha());
+}
+#endif // IMG_COMPACT_ANIMATION
+
 OpRect AnimatedImageContent::GetCurrentFrameRect(ImageListener* image_listener)
 {
 	OP_NEW_DBG("AnimatedImageContent::GetCurrentFrameRect", "animation");
@@ -153,6 +153,18 @@ public:
 	void IncMemUsed(AnimatedImageContent* animated_image_content, INT32 size);
 	void DecRefCount(AnimatedImageContent* animated_image_content);
 	void ClearBuffer();
+#ifdef IMG_COMPACT_ANIMATION
+	/** Take over the bitmap buffer of from_elm, and the memory accounted for it. */
+	void TakeBuffer(FrameElm* from_elm);
+
+	/** Release the bitmap buffer DecRefCount() kept for the frame after a
+		restore previous frame, when that frame has been composed from it. */
+	void ReleaseKeptBuffer(AnimatedImageContent* animated_image_content);
+#endif // IMG_COMPACT_ANIMATION
+
+private:
+	/** Release the bitmap buffer unless the frames of the animation are cached. */
+	void ReleaseBuffer(AnimatedImageContent* animated_image_content);
 };
 
 class ImgContent
@@ -196,6 +208,11 @@ public:
 
 	virtual BOOL IsBottomToTop() { return FALSE; }
 	virtual UINT32 GetLowestDecodedLine() { return 0; }
+
+#ifdef IMG_SCALED_DECODING
+	/** @return how many times the bitmap is halved compared to Width() and Height(). */
+	virtual INT32 GetDownscale() { return 0; }
+#endif // IMG_SCALED_DECODING
 };
 
 class NullImageContent : public ImgContent
@@ -260,6 +277,9 @@ class StaticImageContent : public ImgContent
 public:
 	StaticImageContent(OpBitmap* bitmap, INT32 width, INT32 height, const OpRect& rect, BOOL transparent, BOOL alpha, BOOL interlaced, INT32 bits_per_pixel
 									   , BOOL bottom_to_top
+#ifdef IMG_SCALED_DECODING
+									   , INT32 downscale = 0
+#endif // IMG_SCALED_DECODING
 		);
 
 	~StaticImageContent();
@@ -322,6 +342,10 @@ public:
 	BOOL IsBottomToTop();
 	UINT32 GetLowestDecodedLine();
 
+#ifdef IMG_SCALED_DECODING
+	INT32 GetDownscale() { return downscale; }
+#endif // IMG_SCALED_DECODING
+
 private:
 	OpBitmap* bitmap;
 	OpBitmap* bitmap_tile;
@@ -336,6 +360,10 @@ private:
 	BOOL is_interlaced;
 	BOOL bottom_to_top;
 	UINT32 lowest_decoded_line;
+#ifdef IMG_SCALED_DECODING
+	/** The bitmap, rect and the decoded lines are 1/2^downscale of total_width and total_height. */
+	INT32 downscale;
+#endif // IMG_SCALED_DECODING
 };
 
 class AnimationListenerElmHash : public OpHashTable
@@ -416,7 +444,6 @@ private:
 		FrameElm* comb_elm = frame_elm->pred_combine;
 		int comb_count = 0; // Number of previous frames to combine with - 1
 		OP_ASSERT(comb_elm != NULL);
-		RETURN_IF_ERROR(CreateBitmapBuffer(frame_elm,is_transparent,use_alpha));
 
 		for(;;)
 		{
@@ -429,19 +456,38 @@ private:
 			comb_elm = comb_elm->pred_combine;
 		}
 
-		if(comb_elm->bitmap_buffer)
-		{
-			CopyBitmap(frame_elm->bitmap_buffer,comb_elm->bitmap_buffer);
-		}	
-		else if(comb_elm->flags & FrameElm::FRAME_FLAGS_USE_ORG_BITMAP)
+#ifdef IMG_COMPACT_ANIMATION
+		if(comb_elm->bitmap_buffer && CanTakeBuffer(elm, comb_elm, frame_elm, is_transparent, use_alpha))
 		{
-			comb_elm->bitmap->CopyTo(frame_elm->bitmap_buffer);
+			// Draw on top of the composed frame instead of on a copy of it,
+			// so only the disposed areas and the new frames are touched.
+			frame_elm->TakeBuffer(comb_elm);
 		}
 		else
+#endif // IMG_COMPACT_ANIMATION
 		{
-			RETURN_IF_ERROR(MakeBitmapTransparent(frame_elm->bitmap_buffer));
-			RETURN_IF_ERROR(comb_elm->bitmap->CopyToTransparent(frame_elm->bitmap_buffer, 
-				OpPoint(comb_elm->rect.x, comb_elm->rect.y),TRUE));
+			RETURN_IF_ERROR(CreateBitmapBuffer(frame_elm,is_transparent,use_alpha));
+
+			if(comb_elm->bitmap_buffer)
+			{
+				CopyBitmap(frame_elm->bitmap_buffer,comb_elm->bitmap_buffer);
+#ifdef IMG_COMPACT_ANIMATION
+				// The buffer of comb_elm may only have been kept for this
+				// frame, when the buffer could not be taken over.
+				if (frame_elm->disposal_method != DISPOSAL_METHOD_RESTORE_PREVIOUS)
+					comb_elm->ReleaseKeptBuffer(this);
+#endif // IMG_COMPACT_ANIMATION
+			}	
+			else if(comb_elm->flags & FrameElm::FRAME_FLAGS_USE_ORG_BITMAP)
+			{
+				comb_elm->bitmap->CopyTo(frame_elm->bitmap_buffer);
+			}
+			else
+			{
+				RETURN_IF_ERROR(MakeBitmapTransparent(frame_elm->bitmap_buffer));
+				RETURN_IF_ERROR(comb_elm->bitmap->CopyToTransparent(frame_elm->bitmap_buffer, 
+					OpPoint(comb_elm->rect.x, comb_elm->rect.y),TRUE));
+			}
 		}
 
 		if(comb_elm->disposal_method == DISPOSAL_METHOD_RESTORE_BACKGROUND)
@@ -484,6 +530,14 @@ private:
 
 	BOOL CanLoop(AnimationListenerElm* elm);
 	OP_STATUS CreateBitmapBuffer(FrameElm *frame_elm, BOOL is_transparent, BOOL use_alpha);
+#ifdef IMG_COMPACT_ANIMATION
+	/** @returns TRUE if frame_elm can be composed directly in the bitmap buffer
+	 * of comb_elm. That requires that comb_elm is not cached and no other
+	 * listener shows it, that the buffer is transparent and has alpha if the
+	 * composed frame needs it, and that frame_elm is not restored to comb_elm
+	 * when it is disposed. */
+	BOOL CanTakeBuffer(AnimationListenerElm* elm, FrameElm* comb_elm, FrameElm* frame_elm, BOOL is_transparent, BOOL use_alpha);
+#endif // IMG_COMPACT_ANIMATION
 
 	OpBitmap* bitmap_tile;
 	OpBitmap* bitmap_effect;
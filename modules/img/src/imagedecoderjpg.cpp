@@ -12,24 +12,33 @@
 #ifdef USE_JAYPEG
 
 #include "modules/img/src/imagedecoderjpg.h"
+#include "modules/pi/OpTimeInfo.h"
 #include "modules/probetools/probepoints.h"
 
 ImageDecoder* create_jpeg_decoder(void)
 {
 	return OP_NEW(ImageDecoderJpg, ());
 }
-ImageDecoderJpg::ImageDecoderJpg() : m_imageDecoderListener(NULL), decoder(NULL), width(0), height(0), linedata(NULL)
+ImageDecoderJpg::ImageDecoderJpg() : m_imageDecoderListener(NULL), decoder(NULL), width(0), height(0),
+									 decodedWidth(0), decodedHeight(0), downscale(0),
+#ifdef IMG_SCALED_DECODING
+									 hintWidth(0), hintHeight(0),
+#endif // IMG_SCALED_DECODING
+									 progressive(FALSE), linedata(NULL), lastFlushTime(0), flushedScans(0), flushPosted(FALSE)
 {
 }
 
 ImageDecoderJpg::~ImageDecoderJpg()
 {
+	g_main_message_handler->UnsetCallBacks(this);
+	if (flushPosted)
+		g_main_message_handler->RemoveDelayedMessage(MSG_IMG_FLUSH_PROGRESSIVE_JPEG, (MH_PARAM_1)this, 0);
 	OP_DELETE(decoder);
 	OP_DELETEA(linedata);
 }
 
 
-OP_STATUS ImageDecoderJpg::DecodeData(const BYTE* data, INT32 numBytes, BOOL more, int& resendBytes, BOOL/* load_all = FALSE*/)
+OP_STATUS ImageDecoderJpg::DecodeData(const BYTE* data, INT32 numBytes, BOOL more, int& resendBytes, BOOL load_all/* = FALSE*/)
 {
 	OP_PROBE6(OP_PROBE_IMG_JPG_DECODE_DATA);
 	resendBytes = 0;
@@ -39,6 +48,9 @@ OP_STATUS ImageDecoderJpg::DecodeData(const BYTE* data, INT32 numBytes, BOOL mor
 		decoder = OP_NEW(JayDecoder, ());
 		if (!decoder)
 			return OpStatus::ERR_NO_MEMORY;
+#ifdef IMG_SCALED_DECODING
+		decoder->setTargetSize(hintWidth, hintHeight);
+#endif // IMG_SCALED_DECODING
 		err = decoder->init(data, numBytes, this, TRUE);
 		if (err == JAYPEG_NOT_ENOUGH_DATA)
 		{
@@ -51,6 +63,7 @@ OP_STATUS ImageDecoderJpg::DecodeData(const BYTE* data, INT32 numBytes, BOOL mor
 			return OpStatus::ERR;
 		if (err == JAYPEG_ERR_NO_MEMORY)
 			return OpStatus::ERR_NO_MEMORY;
+		RETURN_IF_ERROR(g_main_message_handler->SetCallBack(this, MSG_IMG_FLUSH_PROGRESSIVE_JPEG, (MH_PARAM_1)this));
 	}
 	err = decoder->decode(data, numBytes);
 	if (err == JAYPEG_ERR)
@@ -58,7 +71,24 @@ OP_STATUS ImageDecoderJpg::DecodeData(const BYTE* data, INT32 numBytes, BOOL mor
 	if (err == JAYPEG_ERR_NO_MEMORY)
 		return OpStatus::ERR_NO_MEMORY;
 
-	decoder->flushProgressive();
+	// A flush redoes the idct of everything the current scan has reached,
+	// so while more data is coming intermediate scans are only shown every
+	// IMG_PROGRESSIVE_FLUSH_INTERVAL ms, and not at all when the whole
+	// image is loaded at once. The first complete scan is shown at once.
+	double now = g_op_time_info->GetRuntimeMS();
+	int scans = decoder->getCompletedScans();
+	if (!more || decoder->isDone() ||
+		(!load_all && ((scans > 0 && flushedScans == 0) ||
+					   now - lastFlushTime >= IMG_PROGRESSIVE_FLUSH_INTERVAL)))
+	{
+		FlushProgressive(now);
+	}
+	else if (progressive && !load_all && !flushPosted)
+	{
+		// Show the skipped flush later if no more data comes before then.
+		unsigned long delay = (unsigned long)(lastFlushTime + IMG_PROGRESSIVE_FLUSH_INTERVAL - now);
+		flushPosted = g_main_message_handler->PostDelayedMessage(MSG_IMG_FLUSH_PROGRESSIVE_JPEG, (MH_PARAM_1)this, 0, delay);
+	}
 
 	if (!more || decoder->isDone())
 	{
@@ -69,11 +99,45 @@ OP_STATUS ImageDecoderJpg::DecodeData(const BYTE* data, INT32 numBytes, BOOL mor
 	return OpStatus::OK;
 }
 
+void ImageDecoderJpg::FlushProgressive(double now)
+{
+	if (flushPosted)
+	{
+		g_main_message_handler->RemoveDelayedMessage(MSG_IMG_FLUSH_PROGRESSIVE_JPEG, (MH_PARAM_1)this, 0);
+		flushPosted = FALSE;
+	}
+	decoder->flushProgressive();
+	lastFlushTime = now;
+	flushedScans = decoder->getCompletedScans();
+}
+
+void ImageDecoderJpg::HandleCallback(OpMessage msg, MH_PARAM_1 par1, MH_PARAM_2 par2)
+{
+	OP_ASSERT(msg == MSG_IMG_FLUSH_PROGRESSIVE_JPEG);
+	flushPosted = FALSE;
+	if (decoder && !decoder->isDone())
+	{
+		FlushProgressive(g_op_time_info->GetRuntimeMS());
+		// No data is being decoded, so the loader does not tell the
+		// listeners about the flushed lines.
+		m_imageDecoderListener->ReportProgress();
+	}
+}
+
 void ImageDecoderJpg::SetImageDecoderListener(ImageDecoderListener* imageDecoderListener)
 {
 	m_imageDecoderListener = imageDecoderListener;
 }
 
+#ifdef IMG_SCALED_DECODING
+void ImageDecoderJpg::SetDecodeSizeHint(UINT32 width, UINT32 height)
+{
+	OP_ASSERT(!decoder);
+	hintWidth = width;
+	hintHeight = height;
+}
+#endif // IMG_SCALED_DECODING
+
 int ImageDecoderJpg::init(int width, int height, int numComponents, BOOL progressive)
 {
 	this->width = width;
@@ -81,7 +145,13 @@ int ImageDecoderJpg::init(int width, int height, int numComponents, BOOL progres
 	this->components = numComponents;
 	this->progressive = progressive;
 
-	linedata = OP_NEWA(UINT32, width);
+#ifdef IMG_SCALED_DECODING
+	downscale = decoder->getScaleShift();
+#endif // IMG_SCALED_DECODING
+	decodedWidth = (width + (1 << downscale) - 1) >> downscale;
+	decodedHeight = (height + (1 << downscale) - 1) >> downscale;
+
+	linedata = OP_NEWA(UINT32, decodedWidth);
 	if (!linedata)
 	{
 		return JAYPEG_ERR_NO_MEMORY;
@@ -99,10 +169,13 @@ void ImageDecoderJpg::scanlineReady(int scanline, const unsigned char *imagedata
 		m_imageDecoderListener->OnInitMainFrame(width, height);
 
 		ImageFrameData image_frame_data;
-		image_frame_data.rect.width = width;
-		image_frame_data.rect.height = height;
+		image_frame_data.rect.width = decodedWidth;
+		image_frame_data.rect.height = decodedHeight;
 		image_frame_data.interlaced = progressive;
 		image_frame_data.bits_per_pixel = components*8;
+#ifdef IMG_SCALED_DECODING
+		image_frame_data.downscale = downscale;
+#endif // IMG_SCALED_DECODING
 
 		m_imageDecoderListener->OnNewFrame(image_frame_data);
 
@@ -110,7 +183,7 @@ void ImageDecoderJpg::scanlineReady(int scanline, const unsigned char *imagedata
 	}
 	if (components == 3)
 	{
-		for (UINT32 i = 0; i < width; ++i)
+		for (UINT32 i = 0; i < decodedWidth; ++i)
 		{
 #if defined(PLATFORM_COLOR_IS_RGBA)
 			linedata[i] = (0xff<<24) | (imagedata[i*components]<<16) | (imagedata[i*components+1]<<8) | (imagedata[i*components+2]);
@@ -121,14 +194,14 @@ void ImageDecoderJpg::scanlineReady(int scanline, const unsigned char *imagedata
 	}
 	else
 	{
-		for (UINT32 i = 0; i < width; ++i)
+		for (UINT32 i = 0; i < decodedWidth; ++i)
 		{
 			linedata[i] = (0xffu<<24) | (imagedata[i*components]<<16) | (imagedata[i*components]<<8) | (imagedata[i*components]);
 		}
 	}
-	if (height > 0)
+	if (decodedHeight > 0)
 		m_imageDecoderListener->OnLineDecoded(linedata, scanline, 1);
-	if (scanline == (int)height)
+	if (scanline == (int)decodedHeight)
 		m_imageDecoderListener->OnDecodingFinished();
 }
 
@@ -15,8 +15,9 @@
 
 #include "modules/jaypeg/jayimage.h"
 #include "modules/jaypeg/jaydecoder.h"
+#include "modules/hardcore/mh/messobj.h"
 
-class ImageDecoderJpg : public ImageDecoder, public JayImage
+class ImageDecoderJpg : public ImageDecoder, public JayImage, public MessageObject
 {
 public:
 	ImageDecoderJpg();
@@ -26,6 +27,10 @@ public:
 
 	virtual void SetImageDecoderListener(ImageDecoderListener* imageDecoderListener);
 
+#ifdef IMG_SCALED_DECODING
+	virtual void SetDecodeSizeHint(UINT32 width, UINT32 height);
+#endif // IMG_SCALED_DECODING
+
 	int init(int width, int height, int numComponents, BOOL progressive);
 	void scanlineReady(int scanline, const unsigned char *imagedata);
 #ifdef IMAGE_METADATA_SUPPORT
@@ -34,16 +39,35 @@ public:
 #ifdef EMBEDDED_ICC_SUPPORT
 	void iccDataFound(const UINT8* data, unsigned datalen);
 #endif // EMBEDDED_ICC_SUPPORT
+
+	// MessageObject
+	virtual void HandleCallback(OpMessage msg, MH_PARAM_1 par1, MH_PARAM_2 par2);
 private:
+	/** Shows the scans decoded so far of a progressive image. */
+	void FlushProgressive(double now);
+
 	ImageDecoderListener* m_imageDecoderListener;
 
 	JayDecoder *decoder;
 
 	UINT32 width, height;
+	/** The size of the decoded lines, which is smaller than width and height
+		when jaypeg decodes to a reduced size. */
+	UINT32 decodedWidth, decodedHeight;
+	INT32 downscale;
+#ifdef IMG_SCALED_DECODING
+	UINT32 hintWidth, hintHeight;
+#endif // IMG_SCALED_DECODING
 	UINT8 components;
 	BOOL progressive;
 	BOOL startFrame;
 	UINT32 *linedata;
+	/** When the progressive image was last flushed to the listener. */
+	double lastFlushTime;
+	/** The number of complete scans at the last flush. */
+	int flushedScans;
+	/** TRUE if a flush is posted, for when no more data comes in time. */
+	BOOL flushPosted;
 };
 
 #endif // USE_JAYPEG
@@ -54,6 +54,7 @@ ImageManagerImp::ImageManagerImp(ImageProgressListener* listener) : progress_lis
 																	, null_image_content(NULL)
 #ifdef IMG_TIME_LIMITED_CACHE
 																	, pending_cache_timeout(FALSE)
+																	, cache_timeout_tick(0)
 #endif // IMG_TIME_LIMITED_CACHE
 #ifdef IMGMAN_USE_SCRATCH_BUFFER
 							, scratch_buffer(NULL)
@@ -316,23 +317,54 @@ void ImageManagerImp::ScheduleCacheTimeout()
 	// Find the time for the oldest image
 	ImageRep* image_rep = (ImageRep*)image_list.First();
     const double now = g_op_time_info->GetRuntimeMS();
-	while (image_rep && !IsFreeable(image_rep, now))
+	unsigned int nowTick = g_op_time_info->GetRuntimeTickMS();
+	unsigned int tickdiff = 0;
+	BOOL found = FALSE;
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+	// Hidden images time out sooner than the others, so the oldest freeable
+	// image of each kind is needed.
+	BOOL found_hidden = FALSE;
+	BOOL found_other = FALSE;
+#endif // IMG_DISCARD_HIDDEN_IMAGES
+	for (; image_rep; image_rep = (ImageRep*)image_rep->Suc())
 	{
 		// Make sure the current image is used more recently than the next
 		OP_ASSERT(!image_rep->Suc() || image_rep->GetLastUsed() <= ((ImageRep*)image_rep->Suc())->GetLastUsed());
-		image_rep = (ImageRep*)image_rep->Suc();
-	}
-	if (image_rep)
-	{
-		unsigned int tickdiff = g_op_time_info->GetRuntimeTickMS()-image_rep->GetLastUsed();
-		if (tickdiff > IMG_CACHE_TIME_LIMIT*1000)
-			tickdiff = 0;
+		if (!IsFreeable(image_rep, now))
+			continue;
+		unsigned int limit = IMG_CACHE_TIME_LIMIT*1000;
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+		if (image_rep->IsHidden())
+		{
+			if (found_hidden)
+				continue;
+			found_hidden = TRUE;
+			limit = IMG_DISCARD_HIDDEN_TIME*1000;
+		}
 		else
-			tickdiff = IMG_CACHE_TIME_LIMIT*1000 - tickdiff;
-		// Add 10 seconds to group some messages together better
-		tickdiff += 10000;
+		{
+			if (found_other)
+				continue;
+			found_other = TRUE;
+		}
+#endif // IMG_DISCARD_HIDDEN_IMAGES
+		unsigned int age = nowTick-image_rep->GetLastUsed();
+		unsigned int left = age > limit ? 0 : limit - age;
+		if (!found || left < tickdiff)
+			tickdiff = left;
+		found = TRUE;
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+		if (found_hidden && found_other)
+#endif // IMG_DISCARD_HIDDEN_IMAGES
+			break;
+	}
+	if (found)
+	{
+		// Wait a little longer to group some messages together better
+		tickdiff += IMG_CACHE_TIMEOUT_DELAY;
 		g_main_message_handler->PostDelayedMessage(MSG_IMG_CLEAN_IMAGE_CACHE, (MH_PARAM_1)this, 0, tickdiff);
 		pending_cache_timeout = TRUE;
+		cache_timeout_tick = nowTick + tickdiff;
 	}
 }
 
@@ -341,6 +373,21 @@ void ImageManagerImp::HandleCallback(OpMessage msg, MH_PARAM_1 par1, MH_PARAM_2
 	pending_cache_timeout = FALSE;
 	FreeMemory();
 }
+
+#ifdef SELFTEST
+void ImageManagerImp::SelftestAge(ImageRep* image_rep, unsigned int age)
+{
+	OP_ASSERT(image_rep->InList());
+	unsigned int last_used = g_op_time_info->GetRuntimeTickMS() - age;
+	// The oldest image is first in the list.
+	ImageRep* first = (ImageRep*)image_list.First();
+	if (first && first != image_rep && (int)(first->GetLastUsed() - last_used) < 0)
+		last_used = first->GetLastUsed();
+	image_rep->Out();
+	image_rep->IntoStart(&image_list);
+	image_rep->UpdateLastUsed(last_used);
+}
+#endif // SELFTEST
 #endif // IMG_TIME_LIMITED_CACHE
 
 void ImageManagerImp::FreeMemory()
@@ -366,6 +413,9 @@ void ImageManagerImp::FreeMemory()
 #ifdef IMG_TIME_LIMITED_CACHE
 				|| nowTick-image_rep->GetLastUsed() > IMG_CACHE_TIME_LIMIT*1000
 #endif // IMG_TIME_LIMITED_CACHE
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+				|| nowTick-image_rep->GetLastUsed() > IMG_DISCARD_HIDDEN_TIME*1000
+#endif // IMG_DISCARD_HIDDEN_IMAGES
 				))
 	{
 		ImageRep* next_image_rep = (ImageRep*)image_rep->Suc();
@@ -376,7 +426,16 @@ void ImageManagerImp::FreeMemory()
 #endif // IMG_TIME_LIMITED_CACHE
 		if (IsFreeable(image_rep, now))
 		{
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+			// Images that are not hidden may only have been reached
+			// because of the shorter time limit for hidden images.
+			if (image_rep->IsHidden())
+				image_rep->Discard();
+			else if (MoreToFree() || nowTick-image_rep->GetLastUsed() > IMG_CACHE_TIME_LIMIT*1000)
+				image_rep->Clear();
+#else
 			image_rep->Clear();
+#endif // IMG_DISCARD_HIDDEN_IMAGES
 		}
 		image_rep = next_image_rep;
 	}
@@ -416,6 +475,33 @@ void ImageManagerImp::FreeMemory()
     }
 }
 
+void ImageManagerImp::FreeInvisibleImages()
+{
+	if (m_lock_count)
+	{
+		m_suppressed_free_memory = TRUE;
+		return;
+	}
+
+	// Unlike FreeMemory, images in state of grace are thrown out too.
+	ImageRep* image_rep = (ImageRep*)image_list.First();
+	while (image_rep != NULL)
+	{
+		ImageRep* next_image_rep = (ImageRep*)image_rep->Suc();
+		if (!image_rep->IsLocked() && !image_rep->IsVisible())
+		{
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+			if (image_rep->IsHidden())
+				image_rep->Discard();
+			else
+#endif // IMG_DISCARD_HIDDEN_IMAGES
+				image_rep->Clear();
+		}
+		image_rep = next_image_rep;
+	}
+	StopAllPredecodingImages();
+}
+
 void ImageManagerImp::SetCacheSize(INT32 cache_size, ImageCachePolicy cache_policy)
 {
 	this->cache_size = cache_size;
@@ -530,6 +616,22 @@ OP_STATUS ImageManagerImp::AddLoadedImage(ImageRep* image_rep)
 		PostContinueLoading(); // FIXME:IMG
 	}
 
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+	// Images thrown out while hidden have all their data in the cache and
+	// are visible again, so decode them before images that are still loading.
+	if (image_rep->IsDiscarded())
+	{
+		LoadedImageElm* next = (LoadedImageElm*)loaded_image_list.First();
+		while (next && next->image_rep->IsDiscarded())
+			next = (LoadedImageElm*)next->Suc();
+		if (next)
+		{
+			elm->Precede(next);
+			return OpStatus::OK;
+		}
+	}
+#endif // IMG_DISCARD_HIDDEN_IMAGES
+
 	elm->Into(&loaded_image_list);
 	return OpStatus::OK;
 }
@@ -714,11 +816,19 @@ void ImageManagerImp::ImageRepIntoImageList(ImageRep* image_rep)
 		{
 			image_rep->Into(&image_list);
 #ifdef IMG_TIME_LIMITED_CACHE
-			image_rep->UpdateLastUsed(g_op_time_info->GetRuntimeTickMS());
-			if (!pending_cache_timeout)
+			unsigned int nowTick = g_op_time_info->GetRuntimeTickMS();
+			image_rep->UpdateLastUsed(nowTick);
+			unsigned int limit = IMG_CACHE_TIME_LIMIT*1000;
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+			if (image_rep->IsHidden())
+				limit = IMG_DISCARD_HIDDEN_TIME*1000;
+#endif // IMG_DISCARD_HIDDEN_IMAGES
+			// A hidden image may time out before the image the pending
+			// timeout was scheduled for.
+			if (!IsCacheTimeoutBefore(nowTick + limit + IMG_CACHE_TIMEOUT_DELAY))
 				ScheduleCacheTimeout();
 #endif // IMG_TIME_LIMITED_CACHE
-}
+		}
 	}
 }
 
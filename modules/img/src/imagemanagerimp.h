@@ -79,6 +79,8 @@ public:
 
 	void FreeMemory();
 
+	void FreeInvisibleImages();
+
 	void SetCacheSize(INT32 cache_size, ImageCachePolicy cache_policy);
 
 	OP_STATUS AddImageDecoderFactory(ImageDecoderFactory* factory, INT32 type, BOOL check_header);
@@ -216,11 +218,20 @@ public:
 	ImgContent* GetNullImageContent() { return null_image_content; }
 
 #ifdef IMG_TIME_LIMITED_CACHE
+	/** The milliseconds the cache is cleaned after the oldest image has
+		timed out, to group some messages together better. */
+	enum { IMG_CACHE_TIMEOUT_DELAY = 10000 };
+
 	void ScheduleCacheTimeout();
 	virtual void HandleCallback(OpMessage msg, MH_PARAM_1 par1, MH_PARAM_2 par2);
+
+	/** @return TRUE if the cache is scheduled to be cleaned no later than
+		tick, in milliseconds from GetRuntimeTickMS(). */
+	BOOL IsCacheTimeoutBefore(unsigned int tick) { return pending_cache_timeout && (int)(cache_timeout_tick - tick) <= 0; }
 #endif // IMG_TIME_LIMITED_CACHE
 
 	virtual INT32 GetCacheSize(){return cache_size;}
+	virtual ImageCachePolicy GetCachePolicy(){return cache_policy;}
 	virtual INT32 GetUsedCacheMem(){return used_mem;}
 #ifdef IMG_CACHE_MULTIPLE_ANIMATION_FRAMES
 	virtual INT32 GetAnimCacheSize(){return anim_cache_size;}
@@ -238,6 +249,23 @@ public:
 	 */
 	Head* CurrentGraceTimeSlot() { return m_grace_lock_count ? m_current_grace_time : NULL; }
 
+#ifdef SELFTEST
+	ImageRep* SelftestGetImageRep(ImageContentProvider* content_provider) { return GetImageRep(content_provider); }
+
+	/** @return the image that is decoded next, or NULL. */
+	ImageRep* SelftestGetFirstLoadedImage()
+	{
+		LoadedImageElm* elm = (LoadedImageElm*)loaded_image_list.First();
+		return elm ? elm->image_rep : NULL;
+	}
+
+#ifdef IMG_TIME_LIMITED_CACHE
+	/** Makes an image in the cache look unused for at least age
+		milliseconds, without breaking the order of the cache. */
+	void SelftestAge(ImageRep* image_rep, unsigned int age);
+#endif // IMG_TIME_LIMITED_CACHE
+#endif // SELFTEST
+
 private:
 	/**
 	   determines whether an image is in state of grace or not
@@ -387,6 +415,7 @@ private:
 	NullImageContent* null_image_content;
 #ifdef IMG_TIME_LIMITED_CACHE
 	BOOL pending_cache_timeout;
+	unsigned int cache_timeout_tick; ///< when the pending timeout is due
 #endif // IMG_TIME_LIMITED_CACHE
 
 #ifdef IMGMAN_USE_SCRATCH_BUFFER
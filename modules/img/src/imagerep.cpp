@@ -22,6 +22,10 @@
 #include "modules/pi/OpBitmap.h"
 #include "modules/pi/OpScreenInfo.h"
 
+#ifdef IMG_TIME_SLICED_DECODING
+#include "modules/pi/OpTimeInfo.h"
+#endif // IMG_TIME_SLICED_DECODING
+
 #ifdef EMBEDDED_ICC_SUPPORT
 #include "modules/prefs/prefsmanager/collections/pc_display.h"
 #endif // EMBEDDED_ICC_SUPPORT
@@ -106,6 +110,11 @@ ImageLoader* ImageLoader::Create(ImageRep* rep, ImageContentProvider* content_pr
 			OP_DELETE(image_loader);
 			return NULL;
 		}
+#ifdef IMG_SCALED_DECODING
+		UINT32 hint_width, hint_height;
+		rep->GetDecodeSizeHint(hint_width, hint_height);
+		image_decoder->SetDecodeSizeHint(hint_width, hint_height);
+#endif // IMG_SCALED_DECODING
 		image_loader->image_decoder = image_decoder;
 	}
 	return image_loader;
@@ -120,6 +129,9 @@ ImageLoader::ImageLoader(ImageRep* rep, ImageContentProvider* content_provider)
 										  rect(0, 0, 0, 0),
 										  frame_nr(0), nr_of_repeats(1), load_status(OpStatus::OK),
 										  is_transparent(FALSE), bits_per_pixel(0), scanlines_added(0)
+#ifdef IMG_TIME_SLICED_DECODING
+										  , slice_bytes(IMG_DECODE_SLICE_BYTES)
+#endif // IMG_TIME_SLICED_DECODING
 {
 }
 
@@ -165,6 +177,27 @@ void ImageLoader::OnLineDecoded(void* data, INT32 line, INT32 lineHeight)
 		}
 
 
+#ifdef EMBEDDED_ICC_SUPPORT
+		// A line repeated over several rows (interlaced images) is
+		// transformed once, instead of once for every row.
+		ImageColorTransform* line_transform = color_transform;
+		if (line_transform && lineHeight > 1
+#ifdef SUPPORT_INDEXED_OPBITMAP
+			&& !is_current_indexed
+#endif // SUPPORT_INDEXED_OPBITMAP
+#ifdef USE_PREMULTIPLIED_ALPHA
+			&& !current_frame_bitmap->HasAlpha()
+#endif // USE_PREMULTIPLIED_ALPHA
+			)
+		{
+			if (UINT32* tmp = line_transform->Apply(static_cast<UINT32*>(data), current_frame_bitmap->Width()))
+			{
+				data = tmp;
+				line_transform = NULL;
+			}
+		}
+#endif // EMBEDDED_ICC_SUPPORT
+
 		INT32 i = 0;
 		for (; i < lineHeight; i++)
 		{
@@ -196,9 +229,9 @@ void ImageLoader::OnLineDecoded(void* data, INT32 line, INT32 lineHeight)
 				else
 #endif // USE_PREMULTIPLIED_ALPHA
 #ifdef EMBEDDED_ICC_SUPPORT
-				if (color_transform)
+				if (line_transform)
 				{
-					OpStatus::Ignore(current_frame_bitmap->AddLineWithColorTransform(data, line + i, color_transform));
+					OpStatus::Ignore(current_frame_bitmap->AddLineWithColorTransform(data, line + i, line_transform));
 				}
 				else
 #endif // EMBEDDED_ICC_SUPPORT
@@ -306,7 +339,11 @@ void ImageLoader::OnNewFrame(const ImageFrameData& image_frame_data)
 											 image_frame_data.alpha,
 											 image_frame_data.interlaced,
 											 image_frame_data.bits_per_pixel,
-											 image_frame_data.bottom_to_top);
+											 image_frame_data.bottom_to_top
+#ifdef IMG_SCALED_DECODING
+											 , image_frame_data.downscale
+#endif // IMG_SCALED_DECODING
+											 );
 			if (OpStatus::IsError(load_status))
 			{
 				OP_DELETE(bmp);
@@ -587,6 +624,14 @@ OP_STATUS ImageLoader::OnMoreData(ImageContentProvider* content_provider, BOOL l
 		int resendBytes = 0;
 		OpStatus::Ignore(ret_val_decode);
 		INT32 old_data_len = 0;
+#ifdef IMG_TIME_SLICED_DECODING
+		// Images from the network are given to the decoder a slice at a
+		// time. When the time slice is used up, decoding continues from a
+		// new message, so that large images do not block the message loop
+		// and several images are decoded side by side.
+		BOOL time_sliced = !load_all && content_provider->IsUrlProvider();
+		double slice_end = time_sliced ? g_op_time_info->GetRuntimeMS() + IMG_DECODE_TIME_SLICE : 0;
+#endif // IMG_TIME_SLICED_DECODING
 		while (TRUE)
 		{
 			OP_STATUS ret_val = content_provider->GetData(data, data_len, more);
@@ -605,8 +650,19 @@ OP_STATUS ImageLoader::OnMoreData(ImageContentProvider* content_provider, BOOL l
 						// We couldn't grow, even if we thought we could.
 						return OpStatus::OK;
 					}
+#ifdef IMG_TIME_SLICED_DECODING
+					BOOL sliced = FALSE;
+					if (time_sliced && data_len > slice_bytes)
+					{
+						data_len = slice_bytes;
+						sliced = TRUE;
+					}
+#endif // IMG_TIME_SLICED_DECODING
 					OP_DBG(("Call DecodeData with len %d", data_len));
 					BOOL more_data = more || !content_provider->IsLoaded();
+#ifdef IMG_TIME_SLICED_DECODING
+					more_data = more_data || sliced;
+#endif // IMG_TIME_SLICED_DECODING
 					ret_val_decode = image_decoder->DecodeData((unsigned char*)data, data_len, more_data, resendBytes, load_all);
 					rep->ReportMoreData();
 					if (OpStatus::IsError(ret_val_decode))
@@ -625,6 +681,22 @@ OP_STATUS ImageLoader::OnMoreData(ImageContentProvider* content_provider, BOOL l
 					{
 						content_provider->ConsumeData(data_len - resendBytes);
 					}
+#ifdef IMG_TIME_SLICED_DECODING
+					if (sliced && !rep->ImageLoaded())
+					{
+						if (resendBytes == data_len)
+						{
+							// The decoder needs more than a slice to get anywhere.
+							slice_bytes *= 2;
+						}
+						if (g_op_time_info->GetRuntimeMS() < slice_end)
+						{
+							old_data_len = 0;
+							continue;
+						}
+						return ((ImageManagerImp*)imgManager)->AddLoadedImage(rep);
+					}
+#endif // IMG_TIME_SLICED_DECODING
 				}
 				if( content_provider->IsLoaded() && !more )
 				{
@@ -763,6 +835,11 @@ ImageRep::ImageRep(BOOL loaded, ImageContentProvider* content_provider) : conten
 #ifdef IMG_TIME_LIMITED_CACHE
 																		  , last_used(0)
 #endif // IMG_TIME_LIMITED_CACHE
+#ifdef IMG_SCALED_DECODING
+																		  , decode_hint_width(0)
+																		  , decode_hint_height(0)
+																		  , scaled_up_bitmap(NULL)
+#endif // IMG_SCALED_DECODING
 																		  , image_color(0)
 																		  , image_description(IMAGE_CONTENT_DESC_NOT_KNOWN)
 #ifdef ENABLE_MEMORY_DEBUGGING
@@ -791,26 +868,240 @@ ImageRep::~ImageRep()
 		OP_DELETEA(metadata);
 	}
 #endif // IMAGE_METADATA_SUPPORT
+#ifdef IMG_SCALED_DECODING
+	OP_DELETE(scaled_up_bitmap);
+#endif // IMG_SCALED_DECODING
 	// If this assert triggers there is an unbalanced IncVisible/DecVisible somehwhere.
 	OP_ASSERT(listener_list.Empty());
 }
 
 OpBitmap* ImageRep::GetBitmap(ImageListener* image_listener)
+{
+	OP_ASSERT(!IsAtvefImage());
+	OpBitmap* bitmap;
+#ifdef IMG_SCALED_DECODING
+	// Until the image is decoded again in full size, the reduced bitmap is
+	// given out scaled up, so that a canvas still has something to draw.
+	if (!CheckFullSize())
+	{
+		bitmap = GetScaledUpBitmap(image_listener);
+	}
+	else
+#endif // IMG_SCALED_DECODING
+	bitmap = image_content->GetBitmap(image_listener);
+	if (bitmap != NULL)
+	{
+		IncLockCount();
+	}
+	return bitmap;
+}
+
+#ifdef IMG_SCALED_DECODING
+OpBitmap* ImageRep::GetDownscaledBitmap(ImageListener* image_listener, INT32& downscale)
 {
 	OP_ASSERT(!IsAtvefImage());
 	OpBitmap* bitmap = image_content->GetBitmap(image_listener);
 	if (bitmap != NULL)
 	{
+		downscale = image_content->GetDownscale();
 		IncLockCount();
 	}
 	return bitmap;
 }
 
+void ImageRep::SetDecodeSizeHint(UINT32 width, UINT32 height)
+{
+	OP_ASSERT(!IsAtvefImage());
+	if (flags & IMAGE_REP_FLAG_FULL_SIZE)
+	{
+		return;
+	}
+	decode_hint_width = MAX(decode_hint_width, width);
+	decode_hint_height = MAX(decode_hint_height, height);
+
+	// The image may have been decoded for a smaller size, or by a decoder
+	// which was created before the hint grew.
+	INT32 downscale = image_content->GetDownscale();
+	if (downscale > 0)
+	{
+		UINT32 decoded_width = ((UINT32)Width() + (1 << downscale) - 1) >> downscale;
+		UINT32 decoded_height = ((UINT32)Height() + (1 << downscale) - 1) >> downscale;
+		if (decoded_width < decode_hint_width || decoded_height < decode_hint_height)
+		{
+			QueueDecodeAgain();
+		}
+	}
+}
+
+void ImageRep::GetDecodeSizeHint(UINT32& width, UINT32& height)
+{
+	if (flags & IMAGE_REP_FLAG_FULL_SIZE)
+	{
+		width = height = 0;
+	}
+	else
+	{
+		width = decode_hint_width;
+		height = decode_hint_height;
+	}
+}
+
+BOOL ImageRep::CheckFullSize()
+{
+	if (image_content->GetDownscale() == 0)
+	{
+		return TRUE;
+	}
+	// Someone needs the bitmap in full size, so from now on the size hint is
+	// ignored for this image.
+	flags |= IMAGE_REP_FLAG_FULL_SIZE;
+	QueueDecodeAgain();
+	return FALSE;
+}
+
+void ImageRep::QueueDecodeAgain()
+{
+	if (IsDecodeAgainQueued() || image_content->Type() != STATIC_IMAGE_CONTENT ||
+		!content_provider || !content_provider->IsLoaded())
+	{
+		return;
+	}
+	flags |= IMAGE_REP_FLAG_DECODE_AGAIN;
+	if (OpStatus::IsMemoryError(((ImageManagerImp*)imgManager)->AddLoadedImage(this)))
+	{
+		flags &= ~IMAGE_REP_FLAG_DECODE_AGAIN;
+		SetOOM();
+	}
+}
+
+OP_STATUS ImageRep::DecodeAgain()
+{
+	// A locked bitmap can not be replaced. DecLockCount() queues the image
+	// again when it is unlocked.
+	if (lock_count)
+	{
+		return OpStatus::OK;
+	}
+	flags &= ~IMAGE_REP_FLAG_DECODE_AGAIN;
+	if (image_content->Type() != STATIC_IMAGE_CONTENT)
+	{
+		return OpStatus::OK;
+	}
+
+	// Decode all the data there is into new content, and keep the old
+	// content until then, so that an image on screen does not go blank.
+	ImgContent* old_content = image_content;
+	ImageLoader* old_loader = image_loader;
+	INT32 old_mem_used = mem_used;
+	INT32 old_flags = flags;
+
+	image_content = OP_NEW(EmptyImageContent, (old_content->Width(), old_content->Height()));
+	if (image_content == NULL)
+	{
+		image_content = old_content;
+		return OpStatus::ERR_NO_MEMORY;
+	}
+	image_loader = NULL;
+	mem_used = 0;
+	flags &= ~(IMAGE_REP_FLAG_LOADED | IMAGE_REP_FLAG_DATA_LOADED | IMAGE_REP_FLAG_FAILED_LOADING | IMAGE_REP_FLAG_OOM);
+
+	// A bitmap may be needed by someone who is not listening to the image,
+	// like a canvas, so decode it as if predecoding.
+	SetPredecoding();
+	OnLoadAll(content_provider);
+
+	OP_STATUS status = IsOOM() ? OpStatus::ERR_NO_MEMORY : OpStatus::OK;
+	if (image_content->Type() == STATIC_IMAGE_CONTENT && !IsFailed())
+	{
+		flags = (flags & ~IMAGE_REP_FLAG_PREDECODING) | (old_flags & IMAGE_REP_FLAG_PREDECODING);
+		OP_DELETE(old_loader);
+		OP_DELETE(old_content);
+		OP_DELETE(scaled_up_bitmap);
+		scaled_up_bitmap = NULL;
+		((ImageManagerImp*)imgManager)->DecMemUsed(old_mem_used);
+	}
+	else
+	{
+		// Nothing was decoded, keep what there was.
+		OP_DELETE(image_loader);
+		OP_DELETE(image_content);
+		((ImageManagerImp*)imgManager)->DecMemUsed(mem_used);
+		image_content = old_content;
+		image_loader = old_loader;
+		mem_used = old_mem_used;
+		flags = old_flags & ~IMAGE_REP_FLAG_DECODE_AGAIN;
+	}
+	((ImageManagerImp*)imgManager)->ImageRepMoveToRightList(this);
+	return status;
+}
+
+OpBitmap* ImageRep::GetScaledUpBitmap(ImageListener* image_listener)
+{
+	if (scaled_up_bitmap)
+	{
+		return scaled_up_bitmap;
+	}
+	OpBitmap* reduced = image_content->GetBitmap(image_listener);
+	if (reduced == NULL)
+	{
+		return NULL;
+	}
+	INT32 downscale = image_content->GetDownscale();
+	OpPoint offset = image_content->GetBitmapOffset();
+	UINT32 width = MIN((UINT32)(Width() - offset.x), reduced->Width() << downscale);
+	UINT32 height = MIN((UINT32)(Height() - offset.y), reduced->Height() << downscale);
+
+	OpBitmap* bitmap;
+	if (OpStatus::IsError(OpBitmap::Create(&bitmap, width, height, FALSE, TRUE)))
+	{
+		return NULL;
+	}
+	UINT32* src = OP_NEWA(UINT32, reduced->Width());
+	UINT32* dst = OP_NEWA(UINT32, width);
+	if (src == NULL || dst == NULL)
+	{
+		OP_DELETEA(src);
+		OP_DELETEA(dst);
+		OP_DELETE(bitmap);
+		return NULL;
+	}
+	for (UINT32 line = 0; line < height; ++line)
+	{
+		// Each line of the reduced bitmap is repeated for the lines it
+		// covers, and each pixel for the pixels it covers.
+		if ((line & ((1 << downscale) - 1)) == 0)
+		{
+			reduced->GetLineData(src, line >> downscale);
+			for (UINT32 x = 0; x < width; ++x)
+			{
+				dst[x] = src[x >> downscale];
+			}
+		}
+		OpStatus::Ignore(bitmap->AddLine(dst, line)); // FIXME:OOM
+	}
+	OP_DELETEA(src);
+	OP_DELETEA(dst);
+
+	scaled_up_bitmap = bitmap;
+	IncMemUsed(width, height, FALSE, TRUE, 0, FALSE);
+	return scaled_up_bitmap;
+}
+#endif // IMG_SCALED_DECODING
+
 void ImageRep::OnMoreData(ImageContentProvider* content_provider, BOOL load_all)
 {
 	OP_NEW_DBG("ImageRep::OnMoreData", "imageloadbug");
 	OP_DBG(("ImageRep: %p", this));
 	OP_ASSERT(!IsAtvefImage());
+#ifdef IMG_SCALED_DECODING
+	// A queued decode decodes all the data, so it replaces the loading.
+	if (IsDecodeAgainQueued() && !load_all && content_provider->IsLoaded())
+	{
+		if (OpStatus::IsMemoryError(DecodeAgain()))
+			SetOOM();
+		return;
+	}
+#endif // IMG_SCALED_DECODING
 	if (listener_list.Empty() && !IsPredecoding())
 	{
 		OP_DBG(("Calling PeekImageDimension"));
@@ -1013,6 +1304,12 @@ void ImageRep::DecVisible(ImageListener* image_listener)
 		{
 			Clear();
 		}
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+		else
+		{
+			flags |= IMAGE_REP_FLAG_HIDDEN;
+		}
+#endif // IMG_DISCARD_HIDDEN_IMAGES
 		imageManager->ImageRepMoveToRightList(this);
 #ifdef ENABLE_MEMORY_DEBUGGING
 		while (m_vis_leaks)
@@ -1060,6 +1357,7 @@ OP_STATUS ImageRep::MadeVisible()
 	OP_ASSERT(!IsAtvefImage());
 
 	m_grace_time.Out();
+	flags &= ~IMAGE_REP_FLAG_HIDDEN;
 
 	if (!IsLoaded() && !IsFailed())
 	{
@@ -1101,6 +1399,10 @@ void ImageRep::Reset()
 	((ImageManagerImp*)imgManager)->ImageRepMoveToRightList(this);
 	OP_DELETE(image_loader);
 	image_loader = NULL;
+#ifdef IMG_SCALED_DECODING
+	OP_DELETE(scaled_up_bitmap);
+	scaled_up_bitmap = NULL;
+#endif // IMG_SCALED_DECODING
 	flags = 0;
 	if (image_content->Type() != NULL_IMAGE_CONTENT)
 	{
@@ -1132,6 +1434,10 @@ void ImageRep::Clear()
 	((ImageManagerImp*)imgManager)->ImageRepMoveToRightList(this);
 	OP_DELETE(image_loader);
 	image_loader = NULL;
+#ifdef IMG_SCALED_DECODING
+	OP_DELETE(scaled_up_bitmap);
+	scaled_up_bitmap = NULL;
+#endif // IMG_SCALED_DECODING
 	if (image_content->Type() != NULL_IMAGE_CONTENT &&
 		image_content->Type() != EMPTY_IMAGE_CONTENT)
 	{
@@ -1153,11 +1459,23 @@ void ImageRep::Clear()
 	flags &= ~IMAGE_REP_FLAG_FAILED_LOADING;
 	flags &= ~IMAGE_REP_FLAG_DATA_LOADED;
 	flags &= ~IMAGE_REP_FLAG_PREDECODING;
+	flags &= ~IMAGE_REP_FLAG_HIDDEN;
+#ifdef IMG_SCALED_DECODING
+	flags &= ~IMAGE_REP_FLAG_DECODE_AGAIN;
+#endif // IMG_SCALED_DECODING
 #ifdef CACHE_UNUSED_IMAGES
 	SetCacheUnusedImage(FALSE);
 #endif // CACHE_UNUSED_IMAGES
 }
 
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+void ImageRep::Discard()
+{
+	Clear();
+	flags |= IMAGE_REP_FLAG_DISCARDED;
+}
+#endif // IMG_DISCARD_HIDDEN_IMAGES
+
 OP_BOOLEAN ImageRep::PeekImageDimension()
 {
 	OP_BOOLEAN ret = OpBoolean::IS_FALSE;
@@ -1491,6 +1809,14 @@ void ImageRep::DecLockCount()
 		}
 	}
 #endif // ENABLE_MEMORY_DEBUGGING
+#ifdef IMG_SCALED_DECODING
+	// A decode that was put off while the bitmap was locked can be done now.
+	if (lock_count == 0 && IsDecodeAgainQueued())
+	{
+		if (OpStatus::IsMemoryError(((ImageManagerImp*)imgManager)->AddLoadedImage(this)))
+			SetOOM();
+	}
+#endif // IMG_SCALED_DECODING
 	if (lock_count == 0 && ((ImageManagerImp*)imgManager)->MoreToFree())
 		((ImageManagerImp*)imgManager)->FreeMemory();
 }
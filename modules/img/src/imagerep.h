@@ -25,6 +25,12 @@ class ImageContentProvider;
 class ImageListenerElm;
 class ImageRep;
 
+#if IMG_DECODE_TIME_SLICE > 0 && !defined(ASYNC_IMAGE_DECODERS)
+#define IMG_TIME_SLICED_DECODING
+/** The number of bytes given to the decoder at a time when decoding is time sliced. */
+#define IMG_DECODE_SLICE_BYTES 16384
+#endif // IMG_DECODE_TIME_SLICE > 0 && !ASYNC_IMAGE_DECODERS
+
 class ImageLoader : public ImageDecoderListener
 {
 public:
@@ -84,6 +90,12 @@ private:
 	INT32 duration;
 	BOOL dont_blend_prev;
 	UINT32 scanlines_added;
+#ifdef IMG_TIME_SLICED_DECODING
+	/** The number of bytes given to the decoder at a time. It is doubled
+		when the decoder needs more than a slice to get anywhere, and kept
+		when decoding continues from a later message. */
+	INT32 slice_bytes;
+#endif // IMG_TIME_SLICED_DECODING
 };
 
 enum
@@ -96,7 +108,11 @@ enum
 	IMAGE_REP_FLAG_FAILED_LOADING = 0x20,
 	IMAGE_REP_FLAG_ATVEF_IMAGE = 0x40,
 	IMAGE_REP_FLAG_DATA_LOADED = 0x80,
-	IMAGE_REP_FLAG_PREDECODING = 0x100
+	IMAGE_REP_FLAG_PREDECODING = 0x100,
+	IMAGE_REP_FLAG_FULL_SIZE = 0x200,
+	IMAGE_REP_FLAG_HIDDEN = 0x400,
+	IMAGE_REP_FLAG_DISCARDED = 0x800,
+	IMAGE_REP_FLAG_DECODE_AGAIN = 0x1000
 };
 
 class ImageListenerElm : public Link
@@ -146,6 +162,15 @@ public:
 
 	OpBitmap* GetBitmap(ImageListener* image_listener);
 
+#ifdef IMG_SCALED_DECODING
+	OpBitmap* GetDownscaledBitmap(ImageListener* image_listener, INT32& downscale);
+
+	void SetDecodeSizeHint(UINT32 width, UINT32 height);
+
+	/** Gets the size new decoders should decode the image to, 0 for the full size. */
+	void GetDecodeSizeHint(UINT32& width, UINT32& height);
+#endif // IMG_SCALED_DECODING
+
 	void ReleaseBitmap()
 	{
 		OP_ASSERT(!IsAtvefImage());
@@ -158,6 +183,10 @@ public:
 		OP_ASSERT(!lock_count);
 		if (lock_count)
 			return NULL;
+#ifdef IMG_SCALED_DECODING
+		if (!CheckFullSize())
+			return GetScaledUpBitmap(image_listener);
+#endif // IMG_SCALED_DECODING
 		return image_content->GetTileBitmap(image_listener, desired_width, desired_height);
 	}
 
@@ -171,6 +200,10 @@ public:
 	{
 		OP_ASSERT(!IsAtvefImage());
 		OpBitmap* bitmap = GetBitmap(image_listener);
+#ifdef IMG_SCALED_DECODING
+		if (bitmap == NULL)
+			return NULL;
+#endif // IMG_SCALED_DECODING
 		OpBitmap* effect_bitmap = image_content->GetEffectBitmap(bitmap, effect, effect_value, image_listener);
 		return effect_bitmap ? effect_bitmap : bitmap;
 	}
@@ -185,6 +218,14 @@ public:
 	OpBitmap* GetTileEffectBitmap(INT32 effect, INT32 effect_value, int horizontal_count, int vertical_count)
 	{
 		OP_ASSERT(!IsAtvefImage());
+#ifdef IMG_SCALED_DECODING
+		if (!CheckFullSize())
+		{
+			// The scaled up bitmap covers the whole image, so it is a tile too.
+			OpBitmap* bitmap = GetScaledUpBitmap(NULL);
+			return bitmap ? image_content->GetEffectBitmap(bitmap, effect, effect_value, NULL) : NULL;
+		}
+#endif // IMG_SCALED_DECODING
 		return image_content->GetTileEffectBitmap(effect, effect_value, horizontal_count, vertical_count);
 	}
 
@@ -281,7 +322,11 @@ public:
 	// INLINE-CALLED-ONCE
 	OP_STATUS AddFirstFrame(OpBitmap* bitmap, const OpRect& rect,
 							BOOL transparent, BOOL alpha, BOOL interlaced,
-							INT32 bits_per_pixel, BOOL bottom_to_top)
+							INT32 bits_per_pixel, BOOL bottom_to_top
+#ifdef IMG_SCALED_DECODING
+							, INT32 downscale
+#endif // IMG_SCALED_DECODING
+							)
 	{
 		OP_ASSERT(!IsAtvefImage());
 		OP_ASSERT(image_content->Type() == EMPTY_IMAGE_CONTENT);
@@ -293,7 +338,11 @@ public:
 												   rect, transparent, alpha,
 												   interlaced,
 												   bits_per_pixel,
-												   bottom_to_top));
+												   bottom_to_top
+#ifdef IMG_SCALED_DECODING
+												   , downscale
+#endif // IMG_SCALED_DECODING
+												   ));
 		if (static_image_content == NULL)
 		{
 			return OpStatus::ERR_NO_MEMORY;
@@ -443,6 +492,21 @@ public:
 
 	BOOL IsFreed() { return mem_used == 0; }
 
+#ifdef IMG_DISCARD_HIDDEN_IMAGES
+	/** @return TRUE if the image has been visible and is decoded, but no
+		longer has any visible listeners. */
+	BOOL IsHidden() { return !!(flags & IMAGE_REP_FLAG_HIDDEN); }
+
+	/** @return TRUE if the decoded image was thrown out while hidden and
+		has not been decoded completely again. */
+	BOOL IsDiscarded() { return !!(flags & IMAGE_REP_FLAG_DISCARDED); }
+
+	/** Throws out the decoded image like Clear(), but remembers that it was
+		done so the image is decoded before others when it becomes visible
+		again. */
+	void Discard();
+#endif // IMG_DISCARD_HIDDEN_IMAGES
+
 	OP_BOOLEAN PeekImageDimension();
 
 	BOOL IsBottomToTop() { return image_content->IsBottomToTop(); }
@@ -497,13 +561,39 @@ private:
 
 	OP_STATUS MadeVisible();
 
+#ifdef IMG_SCALED_DECODING
+	/** Checks that the image is not decoded to a reduced size. If it is,
+		the image is queued to be decoded again in full size, and FALSE is
+		returned. */
+	BOOL CheckFullSize();
+
+	/** Queues the image to be decoded again, to the size given by
+		GetDecodeSizeHint(), from a message. Does nothing before all the
+		data is loaded, since the decoding has not finished yet then. */
+	void QueueDecodeAgain();
+
+	BOOL IsDecodeAgainQueued() { return !!(flags & IMAGE_REP_FLAG_DECODE_AGAIN); }
+
+	/** Decodes the image again, to the size given by GetDecodeSizeHint(),
+		from all the data there is. The old bitmap is kept until the new one
+		has content, and kept for good if nothing could be decoded. If the
+		bitmap is locked, this is done again when it is unlocked. */
+	OP_STATUS DecodeAgain();
+
+	/** Gets the reduced bitmap scaled up to the full size, for the bitmap
+		getters to use until the image is decoded again in full size. The
+		bitmap is created the first time and kept with the reduced content.
+		@return the bitmap, or NULL on OOM or if there is no bitmap yet. */
+	OpBitmap* GetScaledUpBitmap(ImageListener* image_listener);
+#endif // IMG_SCALED_DECODING
+
 	BOOL IsLoaded() { return !!(flags & IMAGE_REP_FLAG_LOADED); }
 	BOOL IsTypeKnown() { return !!(flags & IMAGE_REP_FLAG_KNOWN_TYPE); }
 	BOOL IsTypeFailed() { return !!(flags & IMAGE_REP_FLAG_FAILED_TYPE); }
 	BOOL IsSizeFailed() { return !!(flags & IMAGE_REP_FLAG_FAILED_SIZE); }
 	BOOL IsLoadingFailed() { return !!(flags & IMAGE_REP_FLAG_FAILED_LOADING); }
 
-	void SetLoaded() { flags |= IMAGE_REP_FLAG_LOADED; }
+	void SetLoaded() { flags = (flags | IMAGE_REP_FLAG_LOADED) & ~IMAGE_REP_FLAG_DISCARDED; }
 	void SetTypeFailed() { flags |= IMAGE_REP_FLAG_FAILED_TYPE; }
 	void SetSizeFailed() { flags |= IMAGE_REP_FLAG_FAILED_SIZE; }
 	void SetTypeKnown() { flags |= IMAGE_REP_FLAG_KNOWN_TYPE; }
@@ -531,6 +621,13 @@ private:
 #ifdef IMG_TIME_LIMITED_CACHE
 	unsigned int last_used;
 #endif // IMG_TIME_LIMITED_CACHE
+#ifdef IMG_SCALED_DECODING
+	/** The largest size given to SetDecodeSizeHint. */
+	UINT32 decode_hint_width;
+	UINT32 decode_hint_height;
+	/** Made by GetScaledUpBitmap(), deleted with the reduced content. */
+	OpBitmap* scaled_up_bitmap;
+#endif // IMG_SCALED_DECODING
 
 	enum IMAGE_CONTENT_DESCRIPTION {
 		IMAGE_CONTENT_DESC_NOT_KNOWN,
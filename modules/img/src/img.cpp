@@ -215,6 +215,26 @@ void Image::ReleaseBitmap()
 	}
 }
 
+#ifdef IMG_SCALED_DECODING
+void Image::SetDecodeSizeHint(UINT32 width, UINT32 height)
+{
+	if (image_rep != NULL)
+	{
+		image_rep->SetDecodeSizeHint(width, height);
+	}
+}
+
+OpBitmap* Image::GetDownscaledBitmap(ImageListener* image_listener, INT32& downscale)
+{
+	downscale = 0;
+	if (image_rep != NULL)
+	{
+		return image_rep->GetDownscaledBitmap(image_listener, downscale);
+	}
+	return NULL;
+}
+#endif // IMG_SCALED_DECODING
+
 OpBitmap* Image::GetTileBitmap(ImageListener* image_listener, int desired_width, int desired_height)
 {
 	if (image_rep == NULL)
@@ -68,10 +68,34 @@ public:
 	/** @returns TRUE if the image has been completly flused to the
 	 * listener, FALSE otherwise. */
 	BOOL isFlushed();
+	/** @returns the number of scans which have been completely decoded.
+	 * A baseline image has one scan, a progressive image typically
+	 * several. Can be used to decide when flushProgressive is worth
+	 * calling. */
+	int getCompletedScans();
+
+#ifdef JAYPEG_SCALED_DECODING
+	/** Decode the image to 1/2, 1/4 or 1/8 of its size directly, using
+	 * reduced idcts, if it is only needed in a smaller size. The smallest 
+	 * of these scales which is still at least width x height is used.
+	 * Must be called before init.
+	 * @param width the width the image will be displayed in.
+	 * @param height the height the image will be displayed in. */
+	void setTargetSize(int width, int height);
+	/** @returns the scale the image is decoded in, the size of the 
+	 * scanlines sent to the image listener is the size sent to 
+	 * JayImage::init divided by 1<<getScaleShift(), rounded up. Valid 
+	 * once JayImage::init has been called. */
+	int getScaleShift();
+#endif // JAYPEG_SCALED_DECODING
 private:
 	JayStream stream;
 	
 	JayFormatDecoder *decoder;
+#ifdef JAYPEG_SCALED_DECODING
+	int targetWidth;
+	int targetHeight;
+#endif // JAYPEG_SCALED_DECODING
 };
 
 #endif
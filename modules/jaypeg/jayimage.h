@@ -28,7 +28,9 @@ public:
 	 * @returns JAYPEG_OK, JAYPEG_ERR or JAYPEG_ERR_NO_MEMORY depending on 
 	 * the status of this call. */
 	virtual int init(int width, int height, int numComponents, BOOL progressive) = 0;
-	/** Called when a scanline is decoded. 
+	/** Called when a scanline is decoded. If the image is decoded to a 
+	 * reduced scale (see JayDecoder::setTargetSize) the scanlines are of 
+	 * the reduced image.
 	 * @param scanline the number of the scanline decoded.
 	 * @param imagedata an array of r, g and b values for each pixel of 
 	 * the scanline.*/
@@ -22,6 +22,9 @@
 #include "modules/jaypeg/jayimage.h"
 
 JayDecoder::JayDecoder() : decoder(NULL)
+#ifdef JAYPEG_SCALED_DECODING
+	, targetWidth(0), targetHeight(0)
+#endif // JAYPEG_SCALED_DECODING
 {}
 
 JayDecoder::~JayDecoder()
@@ -64,6 +67,9 @@ int JayDecoder::init(const unsigned char *buffer, unsigned int bufferlen, JayIma
 			return JAYPEG_ERR_NO_MEMORY;
 		}
 		((JayJFIFDecoder*)decoder)->init(img);
+#ifdef JAYPEG_SCALED_DECODING
+		((JayJFIFDecoder*)decoder)->setTargetSize(targetWidth, targetHeight);
+#endif // JAYPEG_SCALED_DECODING
 	}
 #endif
 #ifdef JAYPEG_JP2_SUPPORT
@@ -130,5 +136,28 @@ BOOL JayDecoder::isFlushed()
 	return FALSE;
 }
 
+int JayDecoder::getCompletedScans()
+{
+	if (decoder)
+		return decoder->getCompletedScans();
+	return 0;
+}
+
+#ifdef JAYPEG_SCALED_DECODING
+void JayDecoder::setTargetSize(int width, int height)
+{
+	OP_ASSERT(!decoder);
+	targetWidth = width;
+	targetHeight = height;
+}
+
+int JayDecoder::getScaleShift()
+{
+	if (decoder)
+		return decoder->getScaleShift();
+	return 0;
+}
+#endif // JAYPEG_SCALED_DECODING
+
 #endif
 
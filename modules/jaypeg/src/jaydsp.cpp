@@ -0,0 +1,42 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#include "modules/jaypeg/jaypeg.h"
+
+#if defined(_JPG_SUPPORT_) && defined(USE_JAYPEG) && defined(JAYPEG_JFIF_SUPPORT)
+
+#include "modules/jaypeg/src/jaydsp.h"
+
+#ifdef JAYPEG_USE_SSE2
+#include "modules/pi/OpSystemInfo.h"
+#endif // JAYPEG_USE_SSE2
+
+JayDSP::JayDSP()
+	: idct(jay_idct)
+#ifndef JAYPEG_LOW_QUALITY_SCALE
+	, upsampleH2V1(jay_upsample_h2v1)
+	, upsampleH2V2(jay_upsample_h2v2)
+#endif // !JAYPEG_LOW_QUALITY_SCALE
+	, yccToBGR(jay_ycc_to_bgr)
+{
+#ifdef JAYPEG_USE_SSE2
+	if (g_op_system_info->GetCPUFeatures() & OpSystemInfo::CPU_FEATURES_IA32_SSE2)
+	{
+		idct = jay_idct_sse2;
+#ifndef JAYPEG_LOW_QUALITY_SCALE
+		upsampleH2V1 = jay_upsample_h2v1_sse2;
+		upsampleH2V2 = jay_upsample_h2v2_sse2;
+#endif // !JAYPEG_LOW_QUALITY_SCALE
+		yccToBGR = jay_ycc_to_bgr_sse2;
+	}
+#endif // JAYPEG_USE_SSE2
+}
+
+#endif // _JPG_SUPPORT_ && USE_JAYPEG && JAYPEG_JFIF_SUPPORT
@@ -0,0 +1,70 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#ifndef JAYDSP_H
+#define JAYDSP_H
+
+#include "modules/jaypeg/jaypeg.h"
+#ifdef JAYPEG_JFIF_SUPPORT
+
+/** The inner loops of the jfif decoder which have SIMD versions. The
+ * constructor picks the fastest version of each function the CPU
+ * supports. The C++ versions are the reference, all other versions must
+ * give exactly the same result. */
+struct JayDSP
+{
+	JayDSP();
+
+	/** Dequantize and inverse transform one block of samples.
+	 * @param samples the 64 samples of the block, in zigzag order.
+	 * @param qt the dequantization table, multiplied with the idft constants.
+	 * @param out the 8x8 output samples.
+	 * @param stride the stride of two rows in out. */
+	void (*idct)(const short* samples, const unsigned short* qt, unsigned char* out, unsigned int stride);
+
+#ifndef JAYPEG_LOW_QUALITY_SCALE
+	/** Upsample a line of a component with half the horizontal resolution.
+	 * @param in the input line, (width+1)/2 samples.
+	 * @param out the output line, width samples. */
+	void (*upsampleH2V1)(const unsigned char* in, unsigned char* out, int width);
+
+	/** Upsample a line of a component with half the horizontal and vertical
+	 * resolution.
+	 * @param in1 the closest input line, which is 3/4 of the output.
+	 * @param in2 the further input line, which is 1/4 of the output.
+	 * @param out the output line, width samples. */
+	void (*upsampleH2V2)(const unsigned char* in1, const unsigned char* in2, unsigned char* out, int width);
+#endif // !JAYPEG_LOW_QUALITY_SCALE
+
+	/** Convert a line of YCbCr samples to BGR.
+	 * @param y, cb, cr the input lines, width samples each.
+	 * @param out the output line, 3*width bytes in BGR order. */
+	void (*yccToBGR)(const unsigned char* y, const unsigned char* cb, const unsigned char* cr, unsigned char* out, int width);
+};
+
+// The reference versions.
+void jay_idct(const short* samples, const unsigned short* qt, unsigned char* out, unsigned int stride);
+#ifndef JAYPEG_LOW_QUALITY_SCALE
+void jay_upsample_h2v1(const unsigned char* in, unsigned char* out, int width);
+void jay_upsample_h2v2(const unsigned char* in1, const unsigned char* in2, unsigned char* out, int width);
+#endif // !JAYPEG_LOW_QUALITY_SCALE
+void jay_ycc_to_bgr(const unsigned char* y, const unsigned char* cb, const unsigned char* cr, unsigned char* out, int width);
+
+#ifdef JAYPEG_USE_SSE2
+// Implemented in src/x86/jaydsp_x86_sse2.cpp.
+void jay_idct_sse2(const short* samples, const unsigned short* qt, unsigned char* out, unsigned int stride);
+#ifndef JAYPEG_LOW_QUALITY_SCALE
+void jay_upsample_h2v1_sse2(const unsigned char* in, unsigned char* out, int width);
+void jay_upsample_h2v2_sse2(const unsigned char* in1, const unsigned char* in2, unsigned char* out, int width);
+#endif // !JAYPEG_LOW_QUALITY_SCALE
+void jay_ycc_to_bgr_sse2(const unsigned char* y, const unsigned char* cb, const unsigned char* cr, unsigned char* out, int width);
+#endif // JAYPEG_USE_SSE2
+
+#endif // JAYPEG_JFIF_SUPPORT
+
+#endif // JAYDSP_H
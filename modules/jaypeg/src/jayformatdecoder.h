@@ -29,6 +29,13 @@ public:
 	/** @returns TRUE if the image is completly decoded, FALSE otherwise. */
 	virtual BOOL isDone() = 0;
 	virtual BOOL isFlushed() = 0;
+	/** @returns the number of scans which have been completely decoded. */
+	virtual int getCompletedScans(){return 0;}
+#ifdef JAYPEG_SCALED_DECODING
+	/** @returns how many steps the image is scaled down, the output is
+	 * 1/(1<<scaleShift) of the size of the image. */
+	virtual int getScaleShift(){return 0;}
+#endif // JAYPEG_SCALED_DECODING
 };
 
 #endif
@@ -18,6 +18,9 @@
 #include "modules/jaypeg/src/jaycolorlt.h"
 
 JayIDCT::JayIDCT()
+#ifdef JAYPEG_SCALED_DECODING
+	: scaleShift(0)
+#endif // JAYPEG_SCALED_DECODING
 {
 	int i;
 	for (i = 0; i < JAYPEG_MAX_COMPONENTS; ++i)
@@ -61,17 +64,6 @@ static const unsigned int jaypeg_idft_const[] = {
 };
 
 #ifdef JAYPEG_FAST_BUT_LOSSY
-// Pre-shifted 3 steps
-#define JAYPEG_C2 473
-#define JAYPEG_C4 362
-#define JAYPEG_C6 196
-#define JAYPEG_C4C2 669
-#define JAYPEG_C4C6 277
-#define JAYPEG_Q 277 // C2-C6
-#define JAYPEG_R 669 // C2+C6
-#define JAYPEG_C4Q 392
-#define JAYPEG_C4R 946
-
 #define jayConstMul(sample, c) (((sample)>>8)*(c))
 /*static inline int jayConstMul(int sample, unsigned short c)
 {
@@ -79,16 +71,6 @@ static const unsigned int jaypeg_idft_const[] = {
 }*/
 
 #else
-#define JAYPEG_C2 3784
-#define JAYPEG_C4 2896
-#define JAYPEG_C6 1567
-#define JAYPEG_C4C2 5352
-#define JAYPEG_C4C6 2217
-#define JAYPEG_Q 2217 // C2-C6
-#define JAYPEG_R 5352 // C2+C6
-#define JAYPEG_C4Q 3135
-#define JAYPEG_C4R 7568
-
 static inline int jayConstMul(int sample, unsigned short c)
 {
 	bool positive = true;
@@ -135,6 +117,29 @@ static const unsigned short noQuantTable[64] = {
 };
 
 void JayIDCT::transform(unsigned int component, unsigned int numSamples, unsigned int stride, short *samples, unsigned char *oSamples)
+{
+	const unsigned short* qt = quantTables[compTableNum[component]];
+	if (!qt)
+		qt = noQuantTable;
+
+#ifdef JAYPEG_SCALED_DECODING
+	switch (scaleShift)
+	{
+	case 1:
+		jay_idct_4x4(samples, qt, oSamples, stride);
+		return;
+	case 2:
+		jay_idct_2x2(samples, qt, oSamples, stride);
+		return;
+	case 3:
+		jay_idct_1x1(samples, qt, oSamples, stride);
+		return;
+	}
+#endif // JAYPEG_SCALED_DECODING
+	dsp.idct(samples, qt, oSamples, stride);
+}
+
+void jay_idct(const short* samples, const unsigned short* qt, unsigned char* oSamples, unsigned int stride)
 {
 	int outputSamples[64];
 
@@ -143,9 +148,6 @@ void JayIDCT::transform(unsigned int component, unsigned int numSamples, unsigne
 	// which converts the samples to dft samples and does an inverted fourier transform instead of idct
 	// It describes Arai, Agiu and Nakajima and some extensions by Feig
 
-	const unsigned short* qt = quantTables[compTableNum[component]];
-	if (!qt)
-		qt = noQuantTable;
 #if 1
 	// This path does not used the extensions by Feig. It is much faster to not use them and
 	// instead skip the cases where all ac samples are zero
@@ -586,6 +588,105 @@ void JayIDCT::transform(unsigned int component, unsigned int numSamples, unsigne
 #endif
 }
 
+#ifdef JAYPEG_SCALED_DECODING
+// The constants of the reduced idcts. The weight of frequency u for an
+// output sample is the average of cos((2x+1)*u*pi/16) over the pixels x it
+// covers, divided by the cos(u*pi/16) which is already part of the
+// dequantization table. For the 4x4 idct this is cos((2m+1)*u*pi/8), for
+// the 2x2 idct it is cos(pi/8)*cos(pi/4) for u = 1.
+#ifdef JAYPEG_FAST_BUT_LOSSY
+// Pre-shifted 3 steps
+#define JAYPEG_R4_C1 237
+#define JAYPEG_R4_C2 181
+#define JAYPEG_R4_C3 98
+#define JAYPEG_R2_C1 167
+#else
+#define JAYPEG_R4_C1 1892
+#define JAYPEG_R4_C2 1448
+#define JAYPEG_R4_C3 784
+#define JAYPEG_R2_C1 1338
+#endif // JAYPEG_FAST_BUT_LOSSY
+
+void jay_idct_4x4(const short* samples, const unsigned short* qt, unsigned char* oSamples, unsigned int stride)
+{
+	int outputSamples[16];
+	int col, row;
+
+	// Apply the 4 point idct for the 4 lowest horizontal frequencies,
+	// using the 4 lowest vertical frequencies
+	for (col = 0; col < 4; ++col)
+	{
+		int d0 = (int)samples[jaypeg_zigzag[col]]*(int)qt[col];
+		int d1 = (int)samples[jaypeg_zigzag[col+JROW1]]*(int)qt[col+JROW1];
+		int d2 = (int)samples[jaypeg_zigzag[col+JROW2]]*(int)qt[col+JROW2];
+		int d3 = (int)samples[jaypeg_zigzag[col+JROW3]]*(int)qt[col+JROW3];
+
+		int tmp_e0 = d0 + jayConstMul(d2, JAYPEG_R4_C2);
+		int tmp_e1 = d0 - jayConstMul(d2, JAYPEG_R4_C2);
+		int tmp_o0 = jayConstMul(d1, JAYPEG_R4_C1) + jayConstMul(d3, JAYPEG_R4_C3);
+		int tmp_o1 = jayConstMul(d1, JAYPEG_R4_C3) - jayConstMul(d3, JAYPEG_R4_C1);
+
+		outputSamples[col] = tmp_e0 + tmp_o0;
+		outputSamples[col+4] = tmp_e1 + tmp_o1;
+		outputSamples[col+8] = tmp_e1 - tmp_o1;
+		outputSamples[col+12] = tmp_e0 - tmp_o0;
+	}
+
+	// Apply the 4 point idct for all rows
+	unsigned char* sampleRes = oSamples;
+	for (row = 0; row < 4; ++row)
+	{
+		const int* rowSamples = outputSamples+row*4;
+
+		int tmp_e0 = rowSamples[0] + jayConstMul(rowSamples[2], JAYPEG_R4_C2);
+		int tmp_e1 = rowSamples[0] - jayConstMul(rowSamples[2], JAYPEG_R4_C2);
+		int tmp_o0 = jayConstMul(rowSamples[1], JAYPEG_R4_C1) + jayConstMul(rowSamples[3], JAYPEG_R4_C3);
+		int tmp_o1 = jayConstMul(rowSamples[1], JAYPEG_R4_C3) - jayConstMul(rowSamples[3], JAYPEG_R4_C1);
+
+		sampleRes[0] = JAY_CLAMP(((tmp_e0 + tmp_o0+1024)>>11)+128);
+		sampleRes[1] = JAY_CLAMP(((tmp_e1 + tmp_o1+1024)>>11)+128);
+		sampleRes[2] = JAY_CLAMP(((tmp_e1 - tmp_o1+1024)>>11)+128);
+		sampleRes[3] = JAY_CLAMP(((tmp_e0 - tmp_o0+1024)>>11)+128);
+		sampleRes += stride;
+	}
+}
+
+void jay_idct_2x2(const short* samples, const unsigned short* qt, unsigned char* oSamples, unsigned int stride)
+{
+	int outputSamples[4];
+	int col;
+
+	for (col = 0; col < 2; ++col)
+	{
+		int d0 = (int)samples[jaypeg_zigzag[col]]*(int)qt[col];
+		int d1 = jayConstMul((int)samples[jaypeg_zigzag[col+JROW1]]*(int)qt[col+JROW1], JAYPEG_R2_C1);
+
+		outputSamples[col] = d0 + d1;
+		outputSamples[col+2] = d0 - d1;
+	}
+
+	int tmp_o = jayConstMul(outputSamples[1], JAYPEG_R2_C1);
+	oSamples[0] = JAY_CLAMP(((outputSamples[0] + tmp_o+1024)>>11)+128);
+	oSamples[1] = JAY_CLAMP(((outputSamples[0] - tmp_o+1024)>>11)+128);
+	oSamples += stride;
+	tmp_o = jayConstMul(outputSamples[3], JAYPEG_R2_C1);
+	oSamples[0] = JAY_CLAMP(((outputSamples[2] + tmp_o+1024)>>11)+128);
+	oSamples[1] = JAY_CLAMP(((outputSamples[2] - tmp_o+1024)>>11)+128);
+}
+
+void jay_idct_1x1(const short* samples, const unsigned short* qt, unsigned char* oSamples, unsigned int stride)
+{
+	// Only the dc sample is needed for the average of the block
+	oSamples[0] = JAY_CLAMP((((int)samples[0]*(int)qt[0]+1024)>>11)+128);
+}
+
+void JayIDCT::setScaleShift(int shift)
+{
+	OP_ASSERT(shift >= 0 && shift <= 3);
+	scaleShift = shift;
+}
+#endif // JAYPEG_SCALED_DECODING
+
 // Dequantization
 void JayIDCT::setComponentTableNum(unsigned int component, unsigned char tableNum)
 {
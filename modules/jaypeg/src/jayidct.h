@@ -12,6 +12,32 @@
 #include "modules/jaypeg/jaypeg.h"
 #ifdef JAYPEG_JFIF_SUPPORT
 
+#include "modules/jaypeg/src/jaydsp.h"
+
+// The constants of the idct, used by all versions of it.
+#ifdef JAYPEG_FAST_BUT_LOSSY
+// Pre-shifted 3 steps
+#define JAYPEG_C2 473
+#define JAYPEG_C4 362
+#define JAYPEG_C6 196
+#define JAYPEG_C4C2 669
+#define JAYPEG_C4C6 277
+#define JAYPEG_Q 277 // C2-C6
+#define JAYPEG_R 669 // C2+C6
+#define JAYPEG_C4Q 392
+#define JAYPEG_C4R 946
+#else
+#define JAYPEG_C2 3784
+#define JAYPEG_C4 2896
+#define JAYPEG_C6 1567
+#define JAYPEG_C4C2 5352
+#define JAYPEG_C4C6 2217
+#define JAYPEG_Q 2217 // C2-C6
+#define JAYPEG_R 5352 // C2+C6
+#define JAYPEG_C4Q 3135
+#define JAYPEG_C4R 7568
+#endif // JAYPEG_FAST_BUT_LOSSY
+
 /** The class responible for idct (inverse discrete cosine transform) 
  * transformation and dequantization. It converts the samples to fourier 
  * samples and performs a IDFT. */
@@ -41,10 +67,29 @@ public:
 	 * JAYPEG_NOT_ENOUGH_DATA if there is not enough data to read the table.
 	 * JAYPEG_OK if all went well. */
 	int readDQT(class JayStream *stream);
+#ifdef JAYPEG_SCALED_DECODING
+	/** Make transform write one sample for every 2x2, 4x4 or 8x8 pixels
+	 * of the block instead of 8x8 samples.
+	 * @param shift 0 for full size, 1, 2 or 3 for 1/2, 1/4 or 1/8 size. */
+	void setScaleShift(int shift);
+#endif // JAYPEG_SCALED_DECODING
 private:
 	unsigned short* quantTables[4];
 	unsigned char compTableNum[JAYPEG_MAX_COMPONENTS];
+	JayDSP dsp;
+#ifdef JAYPEG_SCALED_DECODING
+	int scaleShift;
+#endif // JAYPEG_SCALED_DECODING
 };
+
+#ifdef JAYPEG_SCALED_DECODING
+/** Reduced versions of jay_idct. They only use the lowest 4, 2 or 1
+ * frequencies in each direction and write 4x4, 2x2 or 1x1 samples, each
+ * of which is the average of the pixels it covers in the full block. */
+void jay_idct_4x4(const short* samples, const unsigned short* qt, unsigned char* out, unsigned int stride);
+void jay_idct_2x2(const short* samples, const unsigned short* qt, unsigned char* out, unsigned int stride);
+void jay_idct_1x1(const short* samples, const unsigned short* qt, unsigned char* out, unsigned int stride);
+#endif // JAYPEG_SCALED_DECODING
 #endif // JAYPEG_JFIF_SUPPORT
 
 #endif
@@ -653,11 +653,15 @@ JayJFIFDecoder::JayJFIFDecoder(BOOL enable_decoding) :
 		restartInterval(0), restartCount(0), entropyDecoder(NULL), image(NULL),
 		curComponent(0), curComponentCount(0), maxVertRes(0), maxHorizRes(0), scanline(NULL),
 #ifndef JAYPEG_LOW_QUALITY_SCALE
-		scaleCache(NULL),
+		scaleCache(NULL), upsampleRow(NULL),
 #endif // !JAYPEG_LOW_QUALITY_SCALE
-		width(0), height(0), numComponents(0), sampleSize(0),
+		width(0), height(0), outWidth(0), outHeight(0), blockSize(8),
+#ifdef JAYPEG_SCALED_DECODING
+		targetWidth(0), targetHeight(0), scaleShift(0),
+#endif // JAYPEG_SCALED_DECODING
+		numComponents(0), sampleSize(0),
 		progressive(FALSE), interlaced(TRUE), lastStartedMCURow(0), lastWrittenMCURow(-1),
-		wrappedMCU(FALSE), samples_width(0), samples_height(0),
+		wrappedMCU(FALSE), completedScans(0), samples_width(0), samples_height(0),
 #ifdef EMBEDDED_ICC_SUPPORT
 		skipAPP2(FALSE), lastIccChunk(0), totalIccChunks(0),
 #endif // EMBEDDED_ICC_SUPPORT
@@ -678,6 +682,7 @@ JayJFIFDecoder::~JayJFIFDecoder()
 	OP_DELETEA(scanline);
 #ifndef JAYPEG_LOW_QUALITY_SCALE
 	OP_DELETEA(scaleCache);
+	OP_DELETEA(upsampleRow);
 #endif // !JAYPEG_LOW_QUALITY_SCALE
 
 	for (int cc = 0; cc < numComponents; ++cc)
@@ -727,11 +732,29 @@ BOOL JayJFIFDecoder::init(JayImage *image)
 	return TRUE;
 }
 
+#ifdef JAYPEG_SCALED_DECODING
+void JayJFIFDecoder::setTargetSize(int width, int height)
+{
+	targetWidth = width;
+	targetHeight = height;
+}
+
+int JayJFIFDecoder::getScaleShift()
+{
+	return scaleShift;
+}
+#endif // JAYPEG_SCALED_DECODING
+
 BOOL JayJFIFDecoder::isDone()
 {
 	return state == JAYPEG_JFIF_STATE_DONE;
 }
 
+int JayJFIFDecoder::getCompletedScans()
+{
+	return completedScans;
+}
+
 BOOL JayJFIFDecoder::isFlushed()
 {
 	int lwr = lastWrittenMCURow+1;
@@ -776,21 +799,11 @@ void JayJFIFDecoder::startMCURow()
 
 #ifndef JAYPEG_LOW_QUALITY_SCALE
 
-void jay_qscale_h1v1(const unsigned char* in, unsigned char* out, int nc, int width)
-{
-	for (int xp = 0; xp < width; ++xp)
-	{
-		*out = *in;
-		++in;
-		out += nc;
-	}
-}
-
-void jay_qscale_h2v1(const unsigned char* in, unsigned char* out, int nc, int width)
+void jay_upsample_h2v1(const unsigned char* in, unsigned char* out, int width)
 {
 	// First pixel
 	*out = *in;
-	out += nc;
+	++out;
 
 	// reduce width by one since one is already calculated
 	--width;
@@ -804,9 +817,9 @@ void jay_qscale_h2v1(const unsigned char* in, unsigned char* out, int nc, int wi
 		o0 += ((*in)+2)>>2;
 		o1 += (((*in)*3)+2)>>2;
 		*out = o0;
-		out += nc;
+		++out;
 		*out = o1;
-		out += nc;
+		++out;
 	}
 	// fill in the last position if needed
 	if (width&1)
@@ -816,11 +829,11 @@ void jay_qscale_h2v1(const unsigned char* in, unsigned char* out, int nc, int wi
 }
 
 /** in1 is the closes line, which will be 3/4 of the output. in2 is the further line which will be 1/4 of the output. */
-void jay_qscale_h2v2(const unsigned char* in1, const unsigned char* in2, unsigned char* out, int nc, int width)
+void jay_upsample_h2v2(const unsigned char* in1, const unsigned char* in2, unsigned char* out, int width)
 {
 	// First pixel
 	*out = (((*in1)*3)+*in2+2)>>2;
-	out += nc;
+	++out;
 
 	// reduce width by one since one is already calculated
 	--width;
@@ -841,9 +854,9 @@ void jay_qscale_h2v2(const unsigned char* in1, const unsigned char* in2, unsigne
 		o1 += (*in2)*3;
 
 		*out = (o0+8)>>4;
-		out += nc;
+		++out;
 		*out = (o1+8)>>4;
-		out += nc;
+		++out;
 	}
 	// fill in the last position if needed
 	if (width&1)
@@ -853,18 +866,39 @@ void jay_qscale_h2v2(const unsigned char* in1, const unsigned char* in2, unsigne
 }
 #endif // !JAYPEG_LOW_QUALITY_SCALE
 
+void jay_ycc_to_bgr(const unsigned char* y, const unsigned char* cb, const unsigned char* cr, unsigned char* out, int width)
+{
+	for (int xp = 0; xp < width; ++xp)
+	{
+		int yy = y[xp], b = cb[xp], r = cr[xp];
+
+		int crcb_r = jay_cr_to_r[r];
+		int crcb_b = jay_cb_to_b[b];
+		b -= 128;
+		r -= 128;
+		int crcb_g = (705*b + 1463*r + 1024)>>11;
+
+		*out = g_jay_clamp[yy + crcb_b];
+		++out;
+		*out = g_jay_clamp[yy - crcb_g];
+		++out;
+		*out = g_jay_clamp[yy + crcb_r];
+		++out;
+	}
+}
+
 void JayJFIFDecoder::writeMCURow(int rownum)
 {
 	lastWrittenMCURow = rownum;
 
-	int mcurh = 8;
+	int mcurh = blockSize;
 	unsigned int ypos[JAYPEG_MAX_COMPONENTS];
 	unsigned int yinc[JAYPEG_MAX_COMPONENTS];
 	unsigned int xpos[JAYPEG_MAX_COMPONENTS];
 	unsigned int xinc[JAYPEG_MAX_COMPONENTS];
 	if (numComponents > 1)
 	{
-		mcurh = maxVertRes*8;
+		mcurh = maxVertRes*blockSize;
 		// 11 bit fixed point
 		ypos[0] = 0;
 		yinc[0] = (compVertRes[0]<<11)/maxVertRes;
@@ -892,19 +926,19 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 	int rowstart = mcurh*rownum;
 	for (int i = 0; i < mcurh; ++i)
 	{
-		if (rowstart+i < height)
+		if (rowstart+i < outHeight)
 		{
 			if ((numComponents == 3 && colorSpace == JAYPEG_COLORSPACE_YCRCB) ||
 				(numComponents == 4 && colorSpace == JAYPEG_COLORSPACE_YCCK))
 			{
 				unsigned char *sl = scanline;
-				unsigned char *yrow = mcuRow[0] + (ypos[0]>>11)*compWidthInBlocks[0]*8;
+				unsigned char *yrow = mcuRow[0] + (ypos[0]>>11)*compWidthInBlocks[0]*blockSize;
 				ypos[0] += yinc[0];
-				unsigned char *cbrow = mcuRow[1] + (ypos[1]>>11)*compWidthInBlocks[1]*8;
+				unsigned char *cbrow = mcuRow[1] + (ypos[1]>>11)*compWidthInBlocks[1]*blockSize;
 				ypos[1] += yinc[1];
-				unsigned char *crrow = mcuRow[2] + (ypos[2]>>11)*compWidthInBlocks[2]*8;
+				unsigned char *crrow = mcuRow[2] + (ypos[2]>>11)*compWidthInBlocks[2]*blockSize;
 				ypos[2] += yinc[2];
-				unsigned char *krow = mcuRow[3] + (ypos[3]>>11)*compWidthInBlocks[3]*8;
+				unsigned char *krow = mcuRow[3] + (ypos[3]>>11)*compWidthInBlocks[3]*blockSize;
 				ypos[3] += yinc[3];
 				// The two most common cases are special cases here
 				if (compHorizRes[0] == 2 && compHorizRes[1] == 1 && compHorizRes[2] == 1 && numComponents == 3)
@@ -912,97 +946,68 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 #ifndef JAYPEG_LOW_QUALITY_SCALE
 					if (compVertRes[0] == 2 && compVertRes[1] == 1 && compVertRes[2] == 1)
 					{
-						if ((i == 0 && rowstart == 0) || (i == mcurh-1 && rowstart == height-mcurh))
+						// The chroma lines are upsampled to the two last thirds of upsampleRow.
+						const unsigned char* y = mcuRow[0] + compWidthInBlocks[0]*blockSize*i;
+						unsigned char* cb = upsampleRow + outWidth;
+						unsigned char* cr = upsampleRow + 2*outWidth;
+						if ((i == 0 && rowstart == 0) || (i == mcurh-1 && rowstart == outHeight-mcurh))
 						{
-							jay_qscale_h1v1(mcuRow[0] + compWidthInBlocks[0]*8*i, scanline, 3, width);
-							jay_qscale_h2v1(mcuRow[1] + compWidthInBlocks[1]*8*(i/2), scanline+1, 3, width);
-							jay_qscale_h2v1(mcuRow[2] + compWidthInBlocks[2]*8*(i/2), scanline+2, 3, width);
+							dsp.upsampleH2V1(mcuRow[1] + compWidthInBlocks[1]*blockSize*(i/2), cb, outWidth);
+							dsp.upsampleH2V1(mcuRow[2] + compWidthInBlocks[2]*blockSize*(i/2), cr, outWidth);
 						}
 						else if (i == 0)
 						{
 							if (!cache_done)
 							{
-								jay_qscale_h2v2(scaleCache, mcuRow[1], scanline+1, 3, width);
-								jay_qscale_h2v2(scaleCache+(width+1)/2, mcuRow[2], scanline+2, 3, width);
+								// The last line of the previous MCU row, whose luma
+								// was saved in the first third of upsampleRow.
+								y = upsampleRow;
+								dsp.upsampleH2V2(scaleCache, mcuRow[1], cb, outWidth);
+								dsp.upsampleH2V2(scaleCache+(outWidth+1)/2, mcuRow[2], cr, outWidth);
 								--i;
 								cache_done = TRUE;
 							}
 							else
 							{
-								jay_qscale_h1v1(mcuRow[0], scanline, 3, width);
-								jay_qscale_h2v2(mcuRow[1], scaleCache, scanline+1, 3, width);
-								jay_qscale_h2v2(mcuRow[2], scaleCache+(width+1)/2, scanline+2, 3, width);
+								dsp.upsampleH2V2(mcuRow[1], scaleCache, cb, outWidth);
+								dsp.upsampleH2V2(mcuRow[2], scaleCache+(outWidth+1)/2, cr, outWidth);
 							}
 						}
 						else if (i == mcurh-1)
 						{
 							// add stuff to the cache
-							jay_qscale_h1v1(mcuRow[0] + compWidthInBlocks[0]*8*i, scanline, 3, width);
-							jay_qscale_h1v1(mcuRow[1] + compWidthInBlocks[1]*8*(i/2), scaleCache, 1, (width+1)/2);
-							jay_qscale_h1v1(mcuRow[2] + compWidthInBlocks[2]*8*(i/2), scaleCache+(width+1)/2, 1, (width+1)/2);
+							op_memcpy(upsampleRow, y, outWidth);
+							op_memcpy(scaleCache, mcuRow[1] + compWidthInBlocks[1]*blockSize*(i/2), (outWidth+1)/2);
+							op_memcpy(scaleCache+(outWidth+1)/2, mcuRow[2] + compWidthInBlocks[2]*blockSize*(i/2), (outWidth+1)/2);
 							return;
 						}
 						else
 						{
-							jay_qscale_h1v1(mcuRow[0] + compWidthInBlocks[0]*8*i, scanline, 3, width);
 							if (i&1)
 							{
-								jay_qscale_h2v2(mcuRow[1] + compWidthInBlocks[1]*8*((i-1)/2), mcuRow[1] + compWidthInBlocks[1]*8*((i-1)/2+1), scanline+1, 3, width);
-								jay_qscale_h2v2(mcuRow[2] + compWidthInBlocks[2]*8*((i-1)/2), mcuRow[2] + compWidthInBlocks[2]*8*((i-1)/2+1), scanline+2, 3, width);
+								dsp.upsampleH2V2(mcuRow[1] + compWidthInBlocks[1]*blockSize*((i-1)/2), mcuRow[1] + compWidthInBlocks[1]*blockSize*((i-1)/2+1), cb, outWidth);
+								dsp.upsampleH2V2(mcuRow[2] + compWidthInBlocks[2]*blockSize*((i-1)/2), mcuRow[2] + compWidthInBlocks[2]*blockSize*((i-1)/2+1), cr, outWidth);
 							}
 							else
 							{
-								jay_qscale_h2v2(mcuRow[1] + compWidthInBlocks[1]*8*((i-1)/2+1), mcuRow[1] + compWidthInBlocks[1]*8*((i-1)/2), scanline+1, 3, width);
-								jay_qscale_h2v2(mcuRow[2] + compWidthInBlocks[2]*8*((i-1)/2+1), mcuRow[2] + compWidthInBlocks[2]*8*((i-1)/2), scanline+2, 3, width);
+								dsp.upsampleH2V2(mcuRow[1] + compWidthInBlocks[1]*blockSize*((i-1)/2+1), mcuRow[1] + compWidthInBlocks[1]*blockSize*((i-1)/2), cb, outWidth);
+								dsp.upsampleH2V2(mcuRow[2] + compWidthInBlocks[2]*blockSize*((i-1)/2+1), mcuRow[2] + compWidthInBlocks[2]*blockSize*((i-1)/2), cr, outWidth);
 							}
 						}
-						unsigned char* sl = scanline;
-						for (int xp = 0; xp < width; ++xp)
-						{
-							int y = sl[0], cb = sl[1], cr = sl[2];
-
-							int crcb_r = jay_cr_to_r[cr];
-							int crcb_b = jay_cb_to_b[cb];
-							cb -=128;
-							cr -=128;
-							int crcb_g = (705*cb + 1463*cr + 1024)>>11;
-
-							*sl = g_jay_clamp[y + crcb_b];
-							++sl;
-							*sl = g_jay_clamp[y - crcb_g];
-							++sl;
-							*sl = g_jay_clamp[y + crcb_r];
-							++sl;
-						}
+						dsp.yccToBGR(y, cb, cr, scanline, outWidth);
 					}
 					else if (compVertRes[0] == 1 && compVertRes[1] == 1 && compVertRes[2] == 1)
 					{
-						jay_qscale_h1v1(mcuRow[0] + compWidthInBlocks[0]*8*i, scanline, 3, width);
-						jay_qscale_h2v1(mcuRow[1] + compWidthInBlocks[1]*8*i, scanline+1, 3, width);
-						jay_qscale_h2v1(mcuRow[2] + compWidthInBlocks[2]*8*i, scanline+2, 3, width);
-						unsigned char* sl = scanline;
-						for (int xp = 0; xp < width; ++xp)
-						{
-							int y = sl[0], cb = sl[1], cr = sl[2];
-
-							int crcb_r = jay_cr_to_r[cr];
-							int crcb_b = jay_cb_to_b[cb];
-							cb -=128;
-							cr -=128;
-							int crcb_g = (705*cb + 1463*cr + 1024)>>11;
-
-							*sl = g_jay_clamp[y + crcb_b];
-							++sl;
-							*sl = g_jay_clamp[y - crcb_g];
-							++sl;
-							*sl = g_jay_clamp[y + crcb_r];
-							++sl;
-						}
+						unsigned char* cb = upsampleRow + outWidth;
+						unsigned char* cr = upsampleRow + 2*outWidth;
+						dsp.upsampleH2V1(mcuRow[1] + compWidthInBlocks[1]*blockSize*i, cb, outWidth);
+						dsp.upsampleH2V1(mcuRow[2] + compWidthInBlocks[2]*blockSize*i, cr, outWidth);
+						dsp.yccToBGR(mcuRow[0] + compWidthInBlocks[0]*blockSize*i, cb, cr, scanline, outWidth);
 					}
 					else
 #endif // !JAYPEG_LOW_QUALITY_SCALE
 					{
-						int w = width >> 1;
+						int w = outWidth >> 1;
 						for (int xp = 0; xp < w; ++xp)
 						{
 							int y = yrow[xp<<1], cb = cbrow[xp], cr = crrow[xp];
@@ -1028,11 +1033,11 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 							*sl = g_jay_clamp[y + crcb_r];
 							++sl;
 						}
-						if (width&1)
+						if (outWidth&1)
 						{
-							int y = yrow[width-1],
-								cb = cbrow[(width-1)>>1],
-								cr = crrow[(width-1)>>1];
+							int y = yrow[outWidth-1],
+								cb = cbrow[(outWidth-1)>>1],
+								cr = crrow[(outWidth-1)>>1];
 
 							*sl = g_jay_clamp[y + jay_cb_to_b[cb]];
 							++sl;
@@ -1047,23 +1052,11 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 				}
 				else if (compHorizRes[0] == 1 && compHorizRes[1] == 1 && compHorizRes[2] == 1 && (numComponents == 3 || compHorizRes[3] == 1))
 				{
-					for (int xp = 0; xp < width; ++xp)
-					{
-						int y = yrow[xp], cb = cbrow[xp], cr = crrow[xp];
-
-						*sl = g_jay_clamp[y + jay_cb_to_b[cb]];
-						++sl;
-						cb -=128;
-						cr -=128;
-						*sl = g_jay_clamp[y - ((705*cb + 1463*cr + 1024)>>11)];
-						++sl;
-						*sl = g_jay_clamp[y + jay_cr_to_r[cr+128]];
-						++sl;
-					}
+					dsp.yccToBGR(yrow, cbrow, crrow, sl, outWidth);
 					if (numComponents == 4)
 					{
 						sl = scanline;
-						for (int xp = 0; xp < width; ++xp)
+						for (int xp = 0; xp < outWidth; ++xp)
 						{
 							*sl = g_jay_clamp[((255-*sl)*krow[xp])>>8];
 							++sl;
@@ -1079,7 +1072,7 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 					xpos[0] = 0;
 					xpos[1] = 0;
 					xpos[2] = 0;
-					for (int xp = 0; xp < width; ++xp)
+					for (int xp = 0; xp < outWidth; ++xp)
 					{
 						int y, cb, cr;
 						int tx = xpos[0]>>11;
@@ -1105,7 +1098,7 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 					{
 						xpos[3] = 0;
 						sl = scanline;
-						for (int xp = 0; xp < width; ++xp)
+						for (int xp = 0; xp < outWidth; ++xp)
 						{
 							int tx = xpos[3]>>11;
 							xpos[3] += xinc[3];
@@ -1124,18 +1117,18 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 				(numComponents == 4 && colorSpace == JAYPEG_COLORSPACE_CMYK))
 			{
 				unsigned char *sl = scanline;
-				unsigned char *rrow = mcuRow[0] + (ypos[0]>>11)*compWidthInBlocks[0]*8;
+				unsigned char *rrow = mcuRow[0] + (ypos[0]>>11)*compWidthInBlocks[0]*blockSize;
 				ypos[0] += yinc[0];
-				unsigned char *grow = mcuRow[1] + (ypos[1]>>11)*compWidthInBlocks[1]*8;
+				unsigned char *grow = mcuRow[1] + (ypos[1]>>11)*compWidthInBlocks[1]*blockSize;
 				ypos[1] += yinc[1];
-				unsigned char *brow = mcuRow[2] + (ypos[2]>>11)*compWidthInBlocks[2]*8;
+				unsigned char *brow = mcuRow[2] + (ypos[2]>>11)*compWidthInBlocks[2]*blockSize;
 				ypos[2] += yinc[2];
-				unsigned char *krow = mcuRow[3] + (ypos[3]>>11)*compWidthInBlocks[3]*8;
+				unsigned char *krow = mcuRow[3] + (ypos[3]>>11)*compWidthInBlocks[3]*blockSize;
 				ypos[3] += yinc[3];
 				xpos[0] = 0;
 				xpos[1] = 0;
 				xpos[2] = 0;
-				for (int xp = 0; xp < width; ++xp)
+				for (int xp = 0; xp < outWidth; ++xp)
 				{
 					int tx;
 					tx = xpos[2]>>11;
@@ -1160,7 +1153,7 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 					// means the cmyk is inverted
 					if (adobeHeader)
 					{
-						for (int xp = 0; xp < width; ++xp)
+						for (int xp = 0; xp < outWidth; ++xp)
 						{
 							int tx = xpos[3]>>11;
 							xpos[3] += xinc[3];
@@ -1174,7 +1167,7 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 					}
 					else
 					{
-						for (int xp = 0; xp < width; ++xp)
+						for (int xp = 0; xp < outWidth; ++xp)
 						{
 							int tx = xpos[3]>>11;
 							xpos[3] += xinc[3];
@@ -1192,7 +1185,7 @@ void JayJFIFDecoder::writeMCURow(int rownum)
 			else if (numComponents == 1)
 			{
 				OP_ASSERT(colorSpace == JAYPEG_COLORSPACE_GRAYSCALE);
-				image->scanlineReady(rowstart+i, mcuRow[0]+i*compWidthInBlocks[0]*8);
+				image->scanlineReady(rowstart+i, mcuRow[0]+i*compWidthInBlocks[0]*blockSize);
 			}
 			else
 			{
@@ -1242,8 +1235,8 @@ void JayJFIFDecoder::flushProgressive()
 
 					if (xb < compWidthInBlocks[cc])
 					{
-						unsigned char *decsamples = mcuRow[cc]+yb*compWidthInBlocks[cc]*64+xb*8;
-						trans.transform(cc, 64, compWidthInBlocks[cc]*8, samp, decsamples);
+						unsigned char *decsamples = mcuRow[cc]+(yb*compWidthInBlocks[cc]*blockSize+xb)*blockSize;
+						trans.transform(cc, 64, compWidthInBlocks[cc]*blockSize, samp, decsamples);
 					}
 				}
 			}
@@ -1752,15 +1745,15 @@ int JayJFIFDecoder::decodeMCU(JayStream *stream)
 				i = compHorizRes[cc]*block + blockoffs%compHorizRes[cc];
 				if (i < compWidthInBlocks[cc])
 				{
-					i += (blockoffs/compHorizRes[cc])*compWidthInBlocks[cc]*8;
-					decsamples = mcuRow[cc]+i*8;
-					trans.transform(cc, 64, compWidthInBlocks[cc]*8, samples, decsamples);
+					i += (blockoffs/compHorizRes[cc])*compWidthInBlocks[cc]*blockSize;
+					decsamples = mcuRow[cc]+i*blockSize;
+					trans.transform(cc, 64, compWidthInBlocks[cc]*blockSize, samples, decsamples);
 				}
 			}
 			else
 			{
-				decsamples = mcuRow[cc]+compDataUnitCount[cc]*8;
-				trans.transform(cc, 64, compWidthInBlocks[cc]*8, samples, decsamples);
+				decsamples = mcuRow[cc]+compDataUnitCount[cc]*blockSize;
+				trans.transform(cc, 64, compWidthInBlocks[cc]*blockSize, samples, decsamples);
 			}
 		}
 		++compDataUnitCount[cc];
@@ -1779,6 +1772,7 @@ int JayJFIFDecoder::decodeMCU(JayStream *stream)
 				lastStartedMCURow = 0;
 				if (lastStartedMCURow == lastWrittenMCURow || lastWrittenMCURow < 0)
 					wrappedMCU = TRUE;
+				++completedScans;
 				state = JAYPEG_JFIF_STATE_FRAME;
 				return JAYPEG_OK;
 			}
@@ -1882,6 +1876,7 @@ int JayJFIFDecoder::decode(JayStream *stream)
 						lastStartedMCURow = 0;
 						lastWrittenMCURow = -1;
 						wrappedMCU = FALSE;
+						completedScans = 0;
 						// delete the old sample data, if any
 						for (cc = 0; cc < numComponents; ++cc)
 						{
@@ -1932,6 +1927,25 @@ int JayJFIFDecoder::decode(JayStream *stream)
 						}
 						if (width <= 0 || height <= 0 || numComponents <= 0)
 							return JAYPEG_ERR;
+#ifdef JAYPEG_SCALED_DECODING
+						// Use the smallest scale which is still at least as
+						// large as the target size
+						scaleShift = 0;
+						if (targetWidth > 0 && targetHeight > 0)
+						{
+							while (scaleShift < 3 &&
+								((width+(2<<scaleShift)-1)>>(scaleShift+1)) >= targetWidth &&
+								((height+(2<<scaleShift)-1)>>(scaleShift+1)) >= targetHeight)
+								++scaleShift;
+						}
+						trans.setScaleShift(scaleShift);
+						blockSize = 8>>scaleShift;
+						outWidth = (width+(1<<scaleShift)-1)>>scaleShift;
+						outHeight = (height+(1<<scaleShift)-1)>>scaleShift;
+#else
+						outWidth = width;
+						outHeight = height;
+#endif // JAYPEG_SCALED_DECODING
 						// Abort decoding if the image could not be initialized
 						decresult = image->init(width, height, numComponents==1?1:3, progressive);
 						if (decresult != JAYPEG_OK)
@@ -2380,7 +2394,7 @@ int JayJFIFDecoder::decode(JayStream *stream)
 			for (cc = 0; cc < numComponents; ++cc)
 			{
 				compWidthInBlocks[cc] = ((width*compHorizRes[cc]+maxHorizRes-1)/maxHorizRes+7)/8;
-				mcuRow[cc] = OP_NEWA(unsigned char, 64*compWidthInBlocks[cc]*compVertRes[cc]);
+				mcuRow[cc] = OP_NEWA(unsigned char, blockSize*blockSize*compWidthInBlocks[cc]*compVertRes[cc]);
 				if (!mcuRow[cc])
 					return JAYPEG_ERR_NO_MEMORY;
 			}
@@ -2388,14 +2402,18 @@ int JayJFIFDecoder::decode(JayStream *stream)
 			if (numComponents > 1)
 			{
 				OP_DELETEA(scanline);
-				scanline = OP_NEWA(unsigned char, numComponents*width);
+				scanline = OP_NEWA(unsigned char, numComponents*outWidth);
 				if (!scanline)
 					return JAYPEG_ERR_NO_MEMORY;
 #ifndef JAYPEG_LOW_QUALITY_SCALE
 				OP_DELETEA(scaleCache);
-				scaleCache = OP_NEWA(unsigned char, ((width+1)/2)*2);
+				scaleCache = OP_NEWA(unsigned char, ((outWidth+1)/2)*2);
 				if (!scaleCache)
 					return JAYPEG_ERR_NO_MEMORY;
+				OP_DELETEA(upsampleRow);
+				upsampleRow = OP_NEWA(unsigned char, 3*outWidth);
+				if (!upsampleRow)
+					return JAYPEG_ERR_NO_MEMORY;
 #endif // !JAYPEG_LOW_QUALITY_SCALE
 			}
 
@@ -16,6 +16,7 @@
 
 #include "modules/jaypeg/src/jayhuffdecoder.h"
 #include "modules/jaypeg/src/jayidct.h"
+#include "modules/jaypeg/src/jaydsp.h"
 
 class JayImage;
 
@@ -40,12 +41,23 @@ public:
 	 * @returns TRUE if initialization was successfull, FALSE otherwise. */
 	BOOL init(JayImage *image);
 
+#ifdef JAYPEG_SCALED_DECODING
+	/** Set the smallest size the image is needed in. Must be called before
+	 * the frame header is decoded.
+	 * @param width the needed width, 0 to decode the image in full size.
+	 * @param height the needed height, 0 to decode the image in full size. */
+	void setTargetSize(int width, int height);
+
+	int getScaleShift();
+#endif // JAYPEG_SCALED_DECODING
+
 	int decode(class JayStream *stream);
 
 	void flushProgressive();
 
 	BOOL isDone();
 	BOOL isFlushed();
+	int getCompletedScans();
 private:
 	/** Decode MCUs until the restart intervall is reached, all MCUs have 
 	 * been decoded or there is not enough data. */
@@ -75,6 +87,7 @@ private:
 	JayEntropyDecoder *entropyDecoder;
 	JayHuffDecoder huffEntropyDecoder;
 	JayIDCT trans;
+	JayDSP dsp;
 	JayImage *image;
 
 	// keeping track of which component is being decoded
@@ -96,6 +109,8 @@ private:
 	unsigned char *scanline;
 #ifndef JAYPEG_LOW_QUALITY_SCALE
 	unsigned char* scaleCache;
+	/** Luma and upsampled chroma lines, width samples each. */
+	unsigned char* upsampleRow;
 #endif // !JAYPEG_LOW_QUALITY_SCALE
 
 	int dataUnitsPerMCURow;
@@ -104,6 +119,17 @@ private:
 	// Information about the image
 	int width;
 	int height;
+	// The size of the output, which is smaller than width and height when
+	// decoding to a reduced scale. blockSize is the number of output samples
+	// per row and column of a block.
+	int outWidth;
+	int outHeight;
+	int blockSize;
+#ifdef JAYPEG_SCALED_DECODING
+	int targetWidth;
+	int targetHeight;
+	int scaleShift;
+#endif // JAYPEG_SCALED_DECODING
 	int compWidthInBlocks[JAYPEG_MAX_COMPONENTS];
 	int numComponents;
 	int componentNum[JAYPEG_MAX_COMPONENTS];
@@ -114,6 +140,7 @@ private:
 	int lastStartedMCURow;
 	int lastWrittenMCURow;
 	BOOL wrappedMCU;
+	int completedScans;
 
 	int samples_width;
 	int samples_height;
@@ -0,0 +1,354 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#include "modules/jaypeg/jaypeg.h"
+
+#if defined(_JPG_SUPPORT_) && defined(USE_JAYPEG) && defined(JAYPEG_JFIF_SUPPORT) && defined(JAYPEG_USE_SSE2)
+
+#include "modules/jaypeg/src/jayidct.h"
+#include "modules/jaypeg/src/jaydsp.h"
+#include "modules/jaypeg/src/jaycolorlt.h"
+
+#include <emmintrin.h>
+
+// Gather the low dwords of the quadwords in even and odd to one register.
+static op_force_inline __m128i InterleaveLowDwords(__m128i even, __m128i odd)
+{
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+							  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// The low 32 bits of a * c for each dword component. There is no dword
+// multiply in SSE2, so the even and odd components are multiplied
+// separately into quadwords.
+static op_force_inline __m128i MulLo32(__m128i a, __m128i c)
+{
+	return InterleaveLowDwords(_mm_mul_epu32(a, c), _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(c, 32)));
+}
+
+// Load eight bytes and zero extend them to words.
+static op_force_inline __m128i LoadWords(const unsigned char* in)
+{
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in), _mm_setzero_si128());
+}
+
+// v / (1 << shift) rounded towards zero for each dword component.
+static op_force_inline __m128i DivideTrunc(__m128i v, int shift)
+{
+	__m128i sign = _mm_srai_epi32(v, 31);
+	__m128i mag = _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+	mag = _mm_srl_epi32(mag, _mm_cvtsi32_si128(shift));
+	return _mm_sub_epi32(_mm_xor_si128(mag, sign), sign);
+}
+
+// Same as jayConstMul in jayidct.cpp.
+static op_force_inline __m128i ConstMul(__m128i x, __m128i c)
+{
+#ifdef JAYPEG_FAST_BUT_LOSSY
+	return MulLo32(_mm_srai_epi32(x, 8), c);
+#else
+	// The magnitude is multiplied into quadwords, so nothing is lost
+	// before the shift, and the sign is put back afterwards.
+	__m128i sign = _mm_srai_epi32(x, 31);
+	__m128i mag = _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+	__m128i even = _mm_srli_epi64(_mm_mul_epu32(mag, c), 11);
+	__m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(mag, 32), c), 11);
+	__m128i res = InterleaveLowDwords(even, odd);
+	return _mm_sub_epi32(_mm_xor_si128(res, sign), sign);
+#endif // JAYPEG_FAST_BUT_LOSSY
+}
+
+// One dimensional idct of four columns at a time. x[n] holds sample n of
+// each column. The steps are the same as in jay_idct.
+static op_force_inline void IDCT8(__m128i* x)
+{
+	const __m128i c4 = _mm_set1_epi32(JAYPEG_C4);
+	const __m128i c6 = _mm_set1_epi32(JAYPEG_C6);
+	const __m128i q = _mm_set1_epi32(JAYPEG_Q);
+	const __m128i r = _mm_set1_epi32(JAYPEG_R);
+
+	// a0 to a3
+	__m128i a0 = x[0];
+	__m128i a1 = x[4];
+	__m128i a2 = _mm_sub_epi32(x[2], x[6]);
+	__m128i a3 = _mm_add_epi32(x[2], x[6]);
+
+	__m128i m3 = _mm_sub_epi32(a0, a1);
+	__m128i m4 = _mm_sub_epi32(ConstMul(a2, c4), a3);
+	__m128i m5 = _mm_sub_epi32(m3, m4);
+	m3 = _mm_add_epi32(m3, m4);
+	m4 = _mm_add_epi32(a0, a1);
+	__m128i m6 = _mm_sub_epi32(m4, a3);
+	m4 = _mm_add_epi32(m4, a3);
+
+	// a4 to a7
+	a0 = _mm_sub_epi32(x[5], x[3]);
+	a1 = _mm_add_epi32(x[1], x[7]);
+	a2 = _mm_add_epi32(x[3], x[5]);
+	a3 = _mm_add_epi32(a1, a2);
+	a1 = ConstMul(_mm_sub_epi32(a1, a2), c4);
+	a2 = _mm_sub_epi32(x[1], x[7]);
+
+	__m128i m1 = ConstMul(_mm_add_epi32(a0, a2), c6);
+	a0 = _mm_sub_epi32(ConstMul(_mm_sub_epi32(_mm_setzero_si128(), a0), q), m1);
+	a2 = _mm_sub_epi32(ConstMul(a2, r), m1);
+
+	__m128i m2 = _mm_sub_epi32(a2, a3);
+	m1 = _mm_sub_epi32(m2, a1);
+	__m128i m7 = _mm_sub_epi32(a0, m1);
+
+	x[0] = _mm_add_epi32(m4, a3);
+	x[1] = _mm_add_epi32(m3, m2);
+	x[2] = _mm_sub_epi32(m5, m1);
+	x[3] = _mm_sub_epi32(m6, m7);
+	x[4] = _mm_add_epi32(m6, m7);
+	x[5] = _mm_add_epi32(m5, m1);
+	x[6] = _mm_sub_epi32(m3, m2);
+	x[7] = _mm_sub_epi32(m4, a3);
+}
+
+static op_force_inline void Transpose4x4(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3)
+{
+	__m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	__m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	__m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	__m128i t3 = _mm_unpackhi_epi32(r2, r3);
+	r0 = _mm_unpacklo_epi64(t0, t1);
+	r1 = _mm_unpackhi_epi64(t0, t1);
+	r2 = _mm_unpacklo_epi64(t2, t3);
+	r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+// Transpose an 8x8 matrix of dwords, where lo[n] holds columns 0-3 and
+// hi[n] columns 4-7 of row n.
+static op_force_inline void Transpose8x8(__m128i* lo, __m128i* hi)
+{
+	Transpose4x4(lo[0], lo[1], lo[2], lo[3]);
+	Transpose4x4(hi[0], hi[1], hi[2], hi[3]);
+	Transpose4x4(lo[4], lo[5], lo[6], lo[7]);
+	Transpose4x4(hi[4], hi[5], hi[6], hi[7]);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		__m128i t = hi[i];
+		hi[i] = lo[4 + i];
+		lo[4 + i] = t;
+	}
+}
+
+// ((x + 1024) >> 11) + 128 wrapped like JAY_CLAMP does, so that the
+// saturation when packing gives the same result as the clamp table.
+static op_force_inline __m128i Descale(__m128i x)
+{
+	const __m128i round = _mm_set1_epi32(1024);
+	const __m128i offset = _mm_set1_epi32(128 + 384);
+	const __m128i wrap = _mm_set1_epi32(0x3ff);
+	const __m128i clamp_offset = _mm_set1_epi32(384);
+
+	x = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(x, round), 11), offset);
+	return _mm_sub_epi32(_mm_and_si128(x, wrap), clamp_offset);
+}
+
+void jay_idct_sse2(const short* samples, const unsigned short* qt, unsigned char* out, unsigned int stride)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	// Undo the zigzag order. The zero checks of jay_idct are not worth it
+	// here, they do not change the result.
+	short coefs[64];
+	for (int i = 0; i < 64; ++i)
+		coefs[i] = samples[jaypeg_zigzag[i]];
+
+	// Dequantize to dwords, lo[n] holds columns 0-3 and hi[n] columns 4-7
+	// of row n.
+	__m128i lo[8], hi[8];
+	for (int row = 0; row < 8; ++row)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i*)(coefs + row*8));
+		__m128i t = _mm_loadu_si128((const __m128i*)(qt + row*8));
+		lo[row] = MulLo32(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16), _mm_unpacklo_epi16(t, zero));
+		hi[row] = MulLo32(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16), _mm_unpackhi_epi16(t, zero));
+	}
+
+	// Columns first, like jay_idct.
+	IDCT8(lo);
+	IDCT8(hi);
+
+	Transpose8x8(lo, hi);
+
+	IDCT8(lo);
+	IDCT8(hi);
+
+	for (int i = 0; i < 8; ++i)
+	{
+		lo[i] = Descale(lo[i]);
+		hi[i] = Descale(hi[i]);
+	}
+
+	Transpose8x8(lo, hi);
+
+	for (int row = 0; row < 8; ++row)
+	{
+		__m128i words = _mm_packs_epi32(lo[row], hi[row]);
+		_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(words, words));
+		out += stride;
+	}
+}
+
+#ifndef JAYPEG_LOW_QUALITY_SCALE
+
+// Pack o0 and o1 to bytes and store them interleaved.
+static op_force_inline void StoreInterleaved(unsigned char* out, __m128i o0, __m128i o1)
+{
+	const __m128i zero = _mm_setzero_si128();
+	_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(_mm_packus_epi16(o0, zero), _mm_packus_epi16(o1, zero)));
+}
+
+void jay_upsample_h2v1_sse2(const unsigned char* in, unsigned char* out, int width)
+{
+	const __m128i two = _mm_set1_epi16(2);
+
+	// First pixel
+	*out = *in;
+	++out;
+
+	// reduce width by one since one is already calculated
+	--width;
+	int w = width/2;
+	int xp = 0;
+
+	// Eight pairs of output pixels at a time, which reads up to in[w].
+	for (; xp + 8 <= w; xp += 8)
+	{
+		__m128i a = LoadWords(in + xp);
+		__m128i b = LoadWords(in + xp + 1);
+		__m128i a1 = _mm_srli_epi16(_mm_add_epi16(a, two), 2);
+		__m128i a3 = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(a, _mm_add_epi16(a, a)), two), 2);
+		__m128i b1 = _mm_srli_epi16(_mm_add_epi16(b, two), 2);
+		__m128i b3 = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(b, _mm_add_epi16(b, b)), two), 2);
+		StoreInterleaved(out + 2*xp, _mm_add_epi16(a3, b1), _mm_add_epi16(a1, b3));
+	}
+
+	for (; xp < w; ++xp)
+	{
+		int a = in[xp], b = in[xp + 1];
+		out[2*xp] = ((a*3+2)>>2) + ((b+2)>>2);
+		out[2*xp + 1] = ((a+2)>>2) + ((b*3+2)>>2);
+	}
+
+	// fill in the last position if needed
+	if (width&1)
+		out[2*w] = in[w];
+}
+
+void jay_upsample_h2v2_sse2(const unsigned char* in1, const unsigned char* in2, unsigned char* out, int width)
+{
+	const __m128i eight = _mm_set1_epi16(8);
+
+	// First pixel
+	*out = (((*in1)*3)+*in2+2)>>2;
+	++out;
+
+	// reduce width by one since one is already calculated
+	--width;
+	int w = width/2;
+	int xp = 0;
+
+	// Eight pairs of output pixels at a time, which reads up to in1[w] and
+	// in2[w]. The vertical sums are computed first, o0 is then
+	// 3*c0 + c1 and o1 is c0 + 3*c1, which is the same as in the C++ version.
+	for (; xp + 8 <= w; xp += 8)
+	{
+		__m128i a0 = LoadWords(in1 + xp);
+		__m128i a1 = LoadWords(in1 + xp + 1);
+		__m128i b0 = LoadWords(in2 + xp);
+		__m128i b1 = LoadWords(in2 + xp + 1);
+		__m128i c0 = _mm_add_epi16(_mm_add_epi16(a0, _mm_add_epi16(a0, a0)), b0);
+		__m128i c1 = _mm_add_epi16(_mm_add_epi16(a1, _mm_add_epi16(a1, a1)), b1);
+		__m128i o0 = _mm_add_epi16(_mm_add_epi16(c0, _mm_add_epi16(c0, c0)), _mm_add_epi16(c1, eight));
+		__m128i o1 = _mm_add_epi16(_mm_add_epi16(c1, _mm_add_epi16(c1, c1)), _mm_add_epi16(c0, eight));
+		StoreInterleaved(out + 2*xp, _mm_srli_epi16(o0, 4), _mm_srli_epi16(o1, 4));
+	}
+
+	for (; xp < w; ++xp)
+	{
+		int c0 = in1[xp]*3 + in2[xp];
+		int c1 = in1[xp + 1]*3 + in2[xp + 1];
+		out[2*xp] = (c0*3 + c1 + 8)>>4;
+		out[2*xp + 1] = (c0 + c1*3 + 8)>>4;
+	}
+
+	// fill in the last position if needed
+	if (width&1)
+		out[2*w] = ((in1[w]*3)+in2[w]+2)>>2;
+}
+
+#endif // !JAYPEG_LOW_QUALITY_SCALE
+
+// Store four pixels given as BGR0 dwords. Each pixel is written as four
+// bytes, and the fourth byte is overwritten by the next pixel.
+static op_force_inline void StorePixels(unsigned char* out, __m128i px)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		UINT32 v = _mm_cvtsi128_si32(px);
+		op_memcpy(out, &v, 4);
+		out += 3;
+		px = _mm_srli_si128(px, 4);
+	}
+}
+
+void jay_ycc_to_bgr_sse2(const unsigned char* y, const unsigned char* cb, const unsigned char* cr, unsigned char* out, int width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(128);
+	const __m128i g_round = _mm_set1_epi32(1024);
+
+	// Coefficients for (cb, cr) word pairs. The tables jay_cb_to_b and
+	// jay_cr_to_r are 3629*cb/2048 and 359*cr/256 rounded towards zero.
+	const __m128i g_coefs = _mm_set1_epi32((1463 << 16) | 705);
+	const __m128i b_coefs = _mm_set1_epi32(3629);
+	const __m128i r_coefs = _mm_set1_epi32(359 << 16);
+
+	int xp = 0;
+
+	// Eight pixels at a time. Since StorePixels writes one byte too much,
+	// at least one pixel must be left for the C++ version.
+	for (; xp + 8 < width; xp += 8)
+	{
+		__m128i yy = LoadWords(y + xp);
+		__m128i b = _mm_sub_epi16(LoadWords(cb + xp), bias);
+		__m128i r = _mm_sub_epi16(LoadWords(cr + xp), bias);
+		__m128i br_lo = _mm_unpacklo_epi16(b, r);
+		__m128i br_hi = _mm_unpackhi_epi16(b, r);
+
+		__m128i crcb_g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(br_lo, g_coefs), g_round), 11),
+										 _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(br_hi, g_coefs), g_round), 11));
+		__m128i crcb_b = _mm_packs_epi32(DivideTrunc(_mm_madd_epi16(br_lo, b_coefs), 11),
+										 DivideTrunc(_mm_madd_epi16(br_hi, b_coefs), 11));
+		__m128i crcb_r = _mm_packs_epi32(DivideTrunc(_mm_madd_epi16(br_lo, r_coefs), 8),
+										 DivideTrunc(_mm_madd_epi16(br_hi, r_coefs), 8));
+
+		// The sums are well within the range of the clamp table, where it
+		// is the same as saturation.
+		__m128i ob = _mm_packus_epi16(_mm_add_epi16(yy, crcb_b), zero);
+		__m128i og = _mm_packus_epi16(_mm_sub_epi16(yy, crcb_g), zero);
+		__m128i or_ = _mm_packus_epi16(_mm_add_epi16(yy, crcb_r), zero);
+
+		__m128i bg = _mm_unpacklo_epi8(ob, og);
+		__m128i r0 = _mm_unpacklo_epi8(or_, zero);
+		StorePixels(out + 3*xp, _mm_unpacklo_epi16(bg, r0));
+		StorePixels(out + 3*xp + 12, _mm_unpackhi_epi16(bg, r0));
+	}
+
+	jay_ycc_to_bgr(y + xp, cb + xp, cr + xp, out + 3*xp, width - xp);
+}
+
+#endif // _JPG_SUPPORT_ && USE_JAYPEG && JAYPEG_JFIF_SUPPORT && JAYPEG_USE_SSE2
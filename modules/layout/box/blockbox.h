@@ -92,6 +92,11 @@ protected:
 			unsigned int
 						on_line:1;
 
+			/** TRUE if the size of this block does not depend on its content. See IsReflowRoot(). */
+
+			unsigned int
+						is_reflow_root:1;
+
 		} packed;
 		unsigned long
 					packed_init;
@@ -414,6 +419,10 @@ public:
 
 	virtual BOOL	HasAbsoluteWidth() const { return packed.has_absolute_width; }
 
+	/** Is this box a reflow root? */
+
+	virtual BOOL	IsReflowRoot() const { return packed.is_reflow_root; }
+
 	/** Has this block a fixed left position? (not percent values for left margin and parent left border and padding) */
 
 	BOOL			HasFixedLeft() const { return packed.has_fixed_left; }
@@ -2343,6 +2343,8 @@ Box::LayoutChildren(LayoutProperties* cascade, LayoutInfo& info, HTML_Element* f
 						for (HTML_Element* grandchild = child->FirstChildActualStyle(); grandchild; grandchild = grandchild->SucActualStyle())
 							grandchild->SetDirty(ELM_BOTH_DIRTY);
 
+					info.workplace->CountVisitedBox();
+
 					LayoutProperties::LP_STATE status = cascade->CreateChildLayoutBox(info, child);
 
 					switch (status)
@@ -2418,6 +2420,8 @@ Box::LayoutChildren(LayoutProperties* cascade, LayoutInfo& info, HTML_Element* f
 						if (child->NeedsUpdate())
 							child_box->Invalidate(cascade, info);
 
+						info.workplace->CountVisitedBox();
+
 						LAYST state = child_box->Layout(child_cascade, info, first_child, start_position);
 
 						if (state != LAYOUT_CONTINUE)
@@ -7204,6 +7208,13 @@ BlockBox::Layout(LayoutProperties* cascade, LayoutInfo& info, HTML_Element* firs
 #endif // LAYOUT_YIELD_REFLOW
 
 			packed.has_absolute_width = props.content_width >= 0;
+			/* Container::PropagateMinMaxWidths() only pins the min/max
+			   widths to a fixed width in normal layout mode, and not for
+			   flex items or table cells. */
+
+			packed.is_reflow_root = packed.has_absolute_width && props.content_height >= 0 &&
+				props.overflow_x != CSS_VALUE_visible && props.overflow_y != CSS_VALUE_visible &&
+				info.doc->GetLayoutMode() == LAYOUT_NORMAL && !IsFlexItemBox() && !IsTableCell();
 			packed.has_clearance = FALSE;
 
 			if (cascade->multipane_container)
@@ -8671,6 +8682,14 @@ AbsolutePositionedBox::Layout(LayoutProperties* cascade, LayoutInfo& info, HTML_
 
 		packed.has_absolute_width = props.content_width >= 0;
 
+		/* Absolutely positioned boxes don't take part in the min/max width
+		   calculation of their container, so a fixed size is enough, as
+		   long as Container::PropagateMinMaxWidths() pins their own min/max
+		   widths to it, which it only does in normal layout mode. */
+
+		packed.is_reflow_root = packed.has_absolute_width && props.content_height >= 0 &&
+			info.doc->GetLayoutMode() == LAYOUT_NORMAL && !IsFlexItemBox();
+
 		if (cascade->multipane_container)
 			/* There's an ancestor multi-pane container, but that doesn't have
 			   to mean that this block is to be columnized. */
@@ -16604,6 +16623,9 @@ StackingContext::Restart()
 	{
 		element->Out();
 		element->ResetSameClippingStack();
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+		element->ResetCachedOffset();
+#endif // LAYOUT_PAINT_OFFSET_CACHE
 		element->IntoStart(&pending_elements);
 	}
 
@@ -20105,7 +20127,17 @@ StackingContext::Traverse(TraversalObject* traversal_object, LayoutProperties* p
 		HTML_Element* old_target = traversal_object->GetTarget();
 		HTML_Element* html_element = z_element->GetHtmlElement();
 
-		if ((!old_target || old_target == html_element) && traversal_object->TraversePositionedElement(html_element, parent_lprops->html_element))
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+		traversal_object->SetCurrentZElement(z_element);
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
+		BOOL traverse_element = (!old_target || old_target == html_element) && traversal_object->TraversePositionedElement(html_element, parent_lprops->html_element);
+
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+		traversal_object->SetCurrentZElement(NULL);
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
+		if (traverse_element)
 		{
 			HTML_Element* start_target = html_element;
 
@@ -1450,6 +1450,29 @@ private:
 
 	mutable BOOL3	has_same_clipping_stack;
 
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+
+	/** Offset of the box from the containing element, as computed by
+		Box::GetOffsetFromAncestor() when the element was last painted. */
+
+	mutable LayoutCoord
+					cached_x;
+
+	mutable LayoutCoord
+					cached_y;
+
+	/** Return value of Box::GetOffsetFromAncestor() for the cached offset. */
+
+	mutable int		cached_offset_result;
+
+	/** LayoutWorkplace::GetPaintOffsetGeneration() when the offset was
+		cached, or 0 if there is no cached offset. */
+
+	mutable unsigned
+					cached_generation;
+
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 public:
 
 					ZElement(HTML_Element* html_element)
@@ -1458,7 +1481,14 @@ public:
 						order(0),
 						pred_logical(NULL),
 						suc_logical(NULL),
-						has_same_clipping_stack(MAYBE) {}
+						has_same_clipping_stack(MAYBE)
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+					  , cached_x(0),
+						cached_y(0),
+						cached_offset_result(0),
+						cached_generation(0)
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+						{}
 					~ZElement() { Remove(); }
 
 	/** Remove element from lists. */
@@ -1508,6 +1538,46 @@ public:
 
 	void			ResetSameClippingStack() { has_same_clipping_stack = MAYBE; }
 
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+
+	/** Get the offset from the containing element cached by
+		SetCachedOffset().
+
+		@param generation The current LayoutWorkplace::GetPaintOffsetGeneration().
+		@param[out] x Set to the cached horizontal offset.
+		@param[out] y Set to the cached vertical offset.
+		@param[out] offset_result Set to the cached return value of
+			   Box::GetOffsetFromAncestor().
+		@return FALSE if no offset was cached in this generation. */
+
+	BOOL			GetCachedOffset(unsigned generation, LayoutCoord& x, LayoutCoord& y, int& offset_result) const
+	{
+		if (cached_generation != generation)
+			return FALSE;
+
+		x = cached_x;
+		y = cached_y;
+		offset_result = cached_offset_result;
+		return TRUE;
+	}
+
+	/** Cache the offset from the containing element until reflow or
+		scrolling starts a new generation. */
+
+	void			SetCachedOffset(unsigned generation, LayoutCoord x, LayoutCoord y, int offset_result) const
+	{
+		cached_x = x;
+		cached_y = y;
+		cached_offset_result = offset_result;
+		cached_generation = generation;
+	}
+
+	/** Forget the cached offset. */
+
+	void			ResetCachedOffset() { cached_generation = 0; }
+
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 	/** Return TRUE if the Z elements are in the same painting stack.
 
 		This is true when they have the same value of 'z-index' and 'order'. */
@@ -2114,8 +2184,12 @@ enum BoxSignalReason
 
 class Box
 {
+#ifdef LAYOUT_OBJECT_POOL
+	OP_ALLOC_LAYOUT_OBJECT_POOL
+#else
 	OP_ALLOC_ACCOUNTED_POOLING
 	OP_ALLOC_ACCOUNTED_POOLING_SMO_DOCUMENT
+#endif // LAYOUT_OBJECT_POOL
 
 private:
 
@@ -2859,6 +2933,16 @@ public:
 
 	virtual BOOL    HasAbsoluteWidth() const { return FALSE; }
 
+	/** Is this box a reflow root?
+
+		A reflow root is a box whose size does not depend on its content
+		(fixed width and height, and either clipped overflow or absolutely
+		positioned). Changes inside it cannot affect the min/max widths of
+		its ancestors, so they are left alone when a descendant is marked
+		dirty. */
+
+	virtual BOOL	IsReflowRoot() const { return FALSE; }
+
 	/** Skip words because they belong to a different traversal pass. Needed
 		when text-align is justify. */
 
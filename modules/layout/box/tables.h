@@ -751,6 +751,10 @@ private:
 
 	void			CalculateColumnMinMaxWidths(const LayoutInfo& info);
 
+	/** Update column min/max/percentage widths with the widths of one cell. */
+
+	void			AddCellMinMaxWidths(const LayoutInfo& info, TableCellBox* cell);
+
 	/** Calculate table width. */
 
 	BOOL			CalculateTableWidth(LayoutProperties* cascade, LayoutInfo& info);
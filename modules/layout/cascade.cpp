@@ -776,8 +776,34 @@ LayoutProperties::Inherit(HLDocProfile* hld_profile, LayoutProperties* parent, i
 					multipane_container = parent->multipane_container;
 			}
 
-			if (OpStatus::IsMemoryError(props.GetCssProperties(html_element, parent, hld_profile, parent->container == container ? NULL : container, !!(flags & IGNORE_TRANSITIONS))))
-				return FALSE;
+			Container* props_container = parent->container == container ? NULL : container;
+			OP_BOOLEAN shared = OpBoolean::IS_FALSE;
+
+#ifdef LAYOUT_STYLE_SHARING
+			StyleSharingCache* sharing_cache = NULL;
+
+			if (!treat_as_inline_run_in && !flexbox && !multipane_container &&
+				hld_profile->GetLayoutWorkplace()->IsReflowing() &&
+				StyleSharingCache::IsShareable(hld_profile, html_element, parent, !!(flags & IGNORE_TRANSITIONS)))
+				if ((sharing_cache = hld_profile->GetLayoutWorkplace()->GetStyleSharingCache()) != NULL)
+				{
+					shared = sharing_cache->Lookup(html_element, parent, props_container, props);
+
+					if (OpStatus::IsMemoryError(shared))
+						return FALSE;
+				}
+#endif // LAYOUT_STYLE_SHARING
+
+			if (shared != OpBoolean::IS_TRUE)
+			{
+				if (OpStatus::IsMemoryError(props.GetCssProperties(html_element, parent, hld_profile, props_container, !!(flags & IGNORE_TRANSITIONS))))
+					return FALSE;
+
+#ifdef LAYOUT_STYLE_SHARING
+				if (sharing_cache)
+					sharing_cache->Store(html_element, parent, props_container, props);
+#endif // LAYOUT_STYLE_SHARING
+			}
 
 			delete cascading_props;
 			cascading_props = NULL;
@@ -787,6 +813,10 @@ LayoutProperties::Inherit(HLDocProfile* hld_profile, LayoutProperties* parent, i
 	if (!RectifyInvalidLayoutValues())
 		return FALSE;
 
+#ifdef LAYOUT_STYLE_SHARING
+	PropsChanged();
+#endif // LAYOUT_STYLE_SHARING
+
 	return TRUE;
 }
 
@@ -981,6 +1011,10 @@ LayoutProperties::RemoveFirstLineProperties()
 BOOL
 LayoutProperties::WantToModifyProperties(BOOL copy)
 {
+#ifdef LAYOUT_STYLE_SHARING
+	PropsChanged();
+#endif // LAYOUT_STYLE_SHARING
+
 	if (cascading_props)
 	{
 		if (copy)
@@ -6371,3 +6405,191 @@ void LayoutProperties::DereferenceDeclarations()
 	CSS_decl::Unref(props.text_shadows.Get());
 }
 #endif // CSS_TRANSITIONS
+
+#ifdef LAYOUT_STYLE_SHARING
+
+/* static */ BOOL
+StyleSharingCache::IsShareable(HLDocProfile* hld_profile, HTML_Element* element, LayoutProperties* parent_cascade, BOOL ignore_transitions)
+{
+	if (element->GetNsType() != NS_HTML)
+		return FALSE;
+
+	/* Only elements that are commonly repeated as siblings, and that get no
+	   special treatment from GetCssProperties(). Table cells, for instance,
+	   inherit vertical alignment from their column. */
+
+	switch (element->Type())
+	{
+	case Markup::HTE_DIV:
+	case Markup::HTE_P:
+	case Markup::HTE_SPAN:
+	case Markup::HTE_LI:
+	case Markup::HTE_DT:
+	case Markup::HTE_DD:
+		break;
+
+	default:
+		return FALSE;
+	}
+
+	if (element->GetIsPseudoElement() || element->GetInserted() == HE_INSERTED_BY_LAYOUT || element->HasRealSizeDependentCss())
+		return FALSE;
+
+#if defined(DOCUMENT_EDIT_SUPPORT) && defined(WIDGETS_IME_SUPPORT)
+	/* GetCssProperties() gives the spans of an ongoing IME composition a
+	   border or background, from a special attribute. */
+
+	if (element->Type() == Markup::HTE_SPAN && element->GetIMEStyling() != 0)
+		return FALSE;
+#endif // DOCUMENT_EDIT_SUPPORT && WIDGETS_IME_SUPPORT
+
+	HTML_Element* parent = element->Parent();
+
+	if (!parent || parent != parent_cascade->html_element || parent->Type() == Markup::HTE_DOC_ROOT ||
+		parent->GetInserted() == HE_INSERTED_BY_LAYOUT || parent_cascade->use_first_line_props)
+		return FALSE;
+
+	FramesDocument* doc = hld_profile->GetFramesDocument();
+
+	if (!doc || doc->GetLayoutMode() != LAYOUT_NORMAL)
+		return FALSE;
+
+#ifdef CSS_TRANSITIONS
+	if ((!ignore_transitions && hld_profile->GetCSSCollection()->HasTransitions()) || hld_profile->GetCSSCollection()->HasAnimations())
+		return FALSE;
+#endif // CSS_TRANSITIONS
+
+	/* Presentational attributes are mapped to properties outside of the
+	   cascade. Only allow attributes that are either matched by selectors,
+	   and thus reflected in the CSS properties of the element, or have no
+	   effect on style at all. */
+
+	for (int i = 0; i < element->GetAttrSize(); i++)
+		if (!element->GetAttrIsSpecial(i) && !element->GetAttrIsEvent(i))
+			switch (element->GetAttrItem(i))
+			{
+			case ATTR_NULL:
+				break;
+
+			case Markup::HA_CLASS:
+			case Markup::HA_ID:
+			case Markup::HA_STYLE:
+			case Markup::HA_XML:
+				if (g_ns_manager->GetNsTypeAt(element->ResolveNsIdx(element->GetAttrNs(i))) != NS_HTML)
+					return FALSE;
+				break;
+
+			default:
+				return FALSE;
+			}
+
+	return TRUE;
+}
+
+/* static */ void
+StyleSharingCache::GetContainerSize(Container* container, const HTMLayoutProperties& parent_props, LayoutCoord& width, LayoutCoord& height)
+{
+	if (container)
+	{
+		width = container->CalculateContentWidth(parent_props);
+		height = container->GetHeight();
+	}
+	else
+	{
+		width = LayoutCoord(0);
+		height = LayoutCoord(0);
+	}
+}
+
+OP_BOOLEAN
+StyleSharingCache::Lookup(HTML_Element* element, LayoutProperties* parent_cascade, Container* container, HTMLayoutProperties& props)
+{
+	lookups++;
+
+	if (!this->element)
+		return OpBoolean::IS_FALSE;
+
+	HTML_Element* pred = element->Pred();
+
+	while (pred && !Markup::IsRealElement(pred->Type()))
+		pred = pred->Pred();
+
+	if (pred != this->element ||
+		element->Type() != element_type ||
+		pred->GetCssProperties() != css_properties ||
+		parent_cascade != this->parent_cascade ||
+		parent_cascade->GetPropsGeneration() != parent_generation ||
+		container != this->container)
+		return OpBoolean::IS_FALSE;
+
+	/* Elements with equal declarations usually share the same array through
+	   SharedCssManager, but compare the contents if they don't. */
+
+	if (element->GetCssProperties() != css_properties)
+		if (element->GetCssPropLen() != css_prop_len ||
+			css_prop_len && op_memcmp(element->GetCssProperties(), css_properties, css_prop_len * sizeof(CssPropertyItem)) != 0)
+			return OpBoolean::IS_FALSE;
+
+	if (container)
+	{
+		LayoutCoord width;
+		LayoutCoord height;
+
+		GetContainerSize(container, parent_cascade->GetCascadingProperties(), width, height);
+
+		if (width != container_width || height != container_height)
+			return OpBoolean::IS_FALSE;
+	}
+
+	if (!props.Copy(this->props))
+		return OpStatus::ERR_NO_MEMORY;
+
+	hits++;
+
+	/* The next sibling may share the properties as well. */
+
+	this->element = element;
+	css_properties = element->GetCssProperties();
+
+	return OpBoolean::IS_TRUE;
+}
+
+void
+StyleSharingCache::Store(HTML_Element* element, LayoutProperties* parent_cascade, Container* container, const HTMLayoutProperties& props)
+{
+	this->element = NULL;
+
+	/* The containing block of absolutely positioned elements, table
+	   captions and flex items isn't given by the parent cascade and
+	   container alone. */
+
+	if (props.position == CSS_VALUE_absolute || props.position == CSS_VALUE_fixed ||
+		props.display_type == CSS_VALUE_table_caption ||
+		props.GetIsFlexItem())
+		return;
+
+#ifdef SVG_SUPPORT
+	if (props.svg)
+		return;
+#endif // SVG_SUPPORT
+
+#ifdef CURRENT_STYLE_SUPPORT
+	if (props.types)
+		return;
+#endif // CURRENT_STYLE_SUPPORT
+
+	if (!this->props.Copy(props))
+		return;
+
+	GetContainerSize(container, parent_cascade->GetCascadingProperties(), container_width, container_height);
+
+	this->element = element;
+	this->element_type = element->Type();
+	this->css_properties = element->GetCssProperties();
+	this->css_prop_len = element->GetCssPropLen();
+	this->parent_cascade = parent_cascade;
+	this->parent_generation = parent_cascade->GetPropsGeneration();
+	this->container = container;
+}
+
+#endif // LAYOUT_STYLE_SHARING
@@ -59,6 +59,16 @@ private:
 	HTMLayoutProperties*
 					cascading_props;
 
+#ifdef LAYOUT_STYLE_SHARING
+	/** Stamp of the cascading properties, a new one each time they are
+		computed or may be modified. Lets StyleSharingCache tell if they are
+		the same as when it stored the properties of a child. */
+
+	unsigned		props_generation;
+
+	void			PropsChanged() { props_generation = ++g_layout_props_generation; }
+#endif // LAYOUT_STYLE_SHARING
+
 	LP_STATE		LayoutElement(LayoutInfo& info);
 
 	/** Check if this element will generate child elements to represent the content property.
@@ -272,6 +282,9 @@ public:
 					  : html_element(NULL),
 						use_first_line_props(FALSE),
 						cascading_props(NULL),
+#ifdef LAYOUT_STYLE_SHARING
+						props_generation(0),
+#endif // LAYOUT_STYLE_SHARING
 						container(NULL),
 						multipane_container(NULL),
 						table(NULL),
@@ -300,7 +313,19 @@ public:
 
 	/** Wipe element. */
 
-	void			Clean() { html_element = NULL; container = NULL; multipane_container = NULL; table = NULL; flexbox = NULL; use_first_line_props = FALSE; delete cascading_props; cascading_props = NULL; }
+	void			Clean()
+	{
+		html_element = NULL; container = NULL; multipane_container = NULL; table = NULL; flexbox = NULL; use_first_line_props = FALSE; delete cascading_props; cascading_props = NULL;
+#ifdef LAYOUT_STYLE_SHARING
+		props_generation = 0;
+#endif // LAYOUT_STYLE_SHARING
+	}
+
+#ifdef LAYOUT_STYLE_SHARING
+	/** @return The stamp of the cascading properties, see props_generation. */
+
+	unsigned		GetPropsGeneration() const { return props_generation; }
+#endif // LAYOUT_STYLE_SHARING
 
 	/** Check if table or table cell in cascade has a specified desired width. */
 
@@ -681,6 +706,147 @@ private:
 	static CSS_decl* GetComputedDecl(HTML_Element* elm, short property, short pseudo, HLDocProfile *hld_profile, LayoutProperties *lprops, BOOL is_current_style);
 };
 
+#ifdef LAYOUT_STYLE_SHARING
+
+/** Cache of the computed style of the most recently cascaded element.
+
+	Siblings in lists, tables, menus and similar repeated markup very often
+	end up with exactly the same computed style. If an element has the same
+	parent cascade, the same containing block and the same matched CSS
+	properties as its previous sibling, and nothing else about the element
+	may affect its computed style, the properties of the previous sibling are
+	copied instead of calling HTMLayoutProperties::GetCssProperties().
+
+	The copy is the shallow copy done by HTMLayoutProperties::Copy(), so the
+	declarations referenced by the properties are shared, just like they are
+	with the copy made by LayoutProperties::WantToModifyProperties(). One
+	cache is kept per document by LayoutWorkplace. */
+
+class StyleSharingCache
+{
+public:
+
+					StyleSharingCache()
+					  : element(NULL),
+						element_type(Markup::HTE_UNKNOWN),
+						css_properties(NULL),
+						css_prop_len(0),
+						parent_cascade(NULL),
+						parent_generation(0),
+						container(NULL),
+						container_width(0),
+						container_height(0),
+						hits(0),
+						lookups(0) {}
+
+	/** Check if the computed style of element may be shared with an
+		equivalent sibling at all.
+
+		@param hld_profile The document of the element.
+		@param element The element to get the properties for.
+		@param parent_cascade The parent cascade entry of the element.
+		@param ignore_transitions TRUE if ongoing transitions are not to be
+		applied to the properties.
+		@return TRUE if the properties of the element only depend on the
+		parent cascade, the containing block and the matched CSS
+		properties. */
+
+	static BOOL		IsShareable(HLDocProfile* hld_profile, HTML_Element* element, LayoutProperties* parent_cascade, BOOL ignore_transitions);
+
+	/** Look for properties computed for the previous sibling of element.
+
+		@param element The element to get the properties for. Must be
+		shareable, as determined by IsShareable().
+		@param parent_cascade The parent cascade entry of the element.
+		@param container The container passed to GetCssProperties().
+		@param[out] props Set to the cached properties on a hit.
+		@return OpBoolean::IS_TRUE if props was set, OpBoolean::IS_FALSE if
+		the properties have to be computed, ERR_NO_MEMORY on OOM. */
+
+	OP_BOOLEAN		Lookup(HTML_Element* element, LayoutProperties* parent_cascade, Container* container, HTMLayoutProperties& props);
+
+	/** Remember the properties computed for element, so that they may be
+		shared with its next sibling. Properties that depend on more than
+		what Lookup() compares are not stored.
+
+		@param element The element the properties were computed for. Must be
+		shareable, as determined by IsShareable().
+		@param parent_cascade The parent cascade entry of the element.
+		@param container The container passed to GetCssProperties().
+		@param props The computed properties. */
+
+	void			Store(HTML_Element* element, LayoutProperties* parent_cascade, Container* container, const HTMLayoutProperties& props);
+
+	/** Forget the cached properties. Must be called whenever the cached
+		element or its parent may have been changed or deleted. */
+
+	void			Clear() { element = NULL; }
+
+	/** @return The number of times properties were shared. */
+
+	unsigned		GetHits() const { return hits; }
+
+	/** @return The number of times a shareable element was looked up. */
+
+	unsigned		GetLookups() const { return lookups; }
+
+	/** Reset the hit and lookup counters. */
+
+	void			ResetStats() { hits = lookups = 0; }
+
+private:
+
+	/** Get the size of the containing block established by container. */
+
+	static void		GetContainerSize(Container* container, const HTMLayoutProperties& parent_props, LayoutCoord& width, LayoutCoord& height);
+
+	/** The element the properties were computed for, or NULL. */
+
+	HTML_Element*	element;
+
+	/** The type of element. GetCssProperties() treats some types specially,
+		so only elements of the same type may share properties. */
+
+	Markup::Type	element_type;
+
+	/** The matched CSS properties of element. */
+
+	CssPropertyItem*
+					css_properties;
+
+	/** The number of matched CSS properties of element. */
+
+	int				css_prop_len;
+
+	/** The parent cascade entry of element. */
+
+	LayoutProperties*
+					parent_cascade;
+
+	/** The stamp of the cascading properties of parent_cascade. The entry
+		may be reused for another element, or its properties computed again,
+		so the pointer alone does not tell that the parent is the same. */
+
+	unsigned		parent_generation;
+
+	/** The container passed to GetCssProperties(), and the size of its
+		content box at the time. */
+
+	Container*		container;
+	LayoutCoord		container_width;
+	LayoutCoord		container_height;
+
+	/** The computed properties of element. */
+
+	HTMLayoutProperties
+					props;
+
+	unsigned		hits;
+	unsigned		lookups;
+};
+
+#endif // LAYOUT_STYLE_SHARING
+
 /** Return TRUE if the text has to be laid out, or FALSE otherwise (e.g. it only contains collapsable white-space). */
 
 inline BOOL			TextRequiresLayout(FramesDocument* doc, const uni_char* text, CSSValue white_space)
@@ -1887,6 +1887,13 @@ MarqueeContainer::Animate(PaintObject* paint_object, LayoutProperties* layout_pr
 		if (html_element->SetSpecialAttr(Markup::LAYOUTA_MARQUEE_OFFSET, ITEM_TYPE_NUM, (void*)(INTPTR)offset, FALSE, SpecialNs::NS_LAYOUT) < 0 ||
 		    html_element->SetSpecialAttr(Markup::LAYOUTA_MARQUEE_LOOPED, ITEM_TYPE_NUM, (void*)(INTPTR)looped, FALSE, SpecialNs::NS_LAYOUT) < 0)
 			return OpStatus::ERR_NO_MEMORY;
+
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+		/* Positioned descendants moved relative to their containing elements. */
+
+		if (LogicalDocument* logdoc = paint_object->GetDocument()->GetLogicalDocument())
+			logdoc->GetLayoutWorkplace()->InvalidatePaintOffsets();
+#endif // LAYOUT_PAINT_OFFSET_CACHE
 	} // end if !stopped
 	else
 		if (stopped_by_script)
@@ -13117,6 +13124,43 @@ TableContent::UpdateColumnWidths(const LayoutInfo& info, int column, int colspan
 	return column_width_changed;
 }
 
+/** Cell with a column span, waiting for its turn in CalculateColumnMinMaxWidths(). */
+
+struct SpannedTableCell
+{
+	TableCellBox*	cell;
+	int				colspan;
+
+	/** Position of the cell in layout stack order. */
+
+	int				order;
+};
+
+static int
+CompareSpannedTableCells(const void* a, const void* b)
+{
+	const SpannedTableCell* cell_a = static_cast<const SpannedTableCell*>(a);
+	const SpannedTableCell* cell_b = static_cast<const SpannedTableCell*>(b);
+
+	if (cell_a->colspan != cell_b->colspan)
+		return cell_a->colspan - cell_b->colspan;
+
+	return cell_a->order - cell_b->order;
+}
+
+/** Update column min/max/percentage widths with the widths of one cell. */
+
+void
+TableContent::AddCellMinMaxWidths(const LayoutInfo& info, TableCellBox* cell)
+{
+	LayoutCoord min_width;
+	LayoutCoord normal_min_width;
+	LayoutCoord max_width;
+
+	if (cell->GetMinMaxWidth(min_width, normal_min_width, max_width))
+		UpdateColumnWidths(info, cell->GetColumn(), cell->GetCellColSpan(), cell->GetDesiredWidth(), min_width, normal_min_width, max_width, TRUE);
+}
+
 /** Calculate all column min/max/percentage widths.
 
 	Do the cells with lowest colspan first. */
@@ -13131,7 +13175,67 @@ TableContent::CalculateColumnMinMaxWidths(const LayoutInfo& info)
 	   compatible with IE. In Firefox and Konqueror, on the other hand, row order seems to make no
 	   difference. */
 
-	int colspan = 1;
+	// Feed the cells without colspan right away, and count the others.
+
+	int spanned_count = 0;
+
+	for (TableListElement* element = (TableListElement*) layout_stack.First(); element; element = element->Suc())
+		if (element->IsRowGroup())
+			for (TableRowBox* row = ((TableRowGroupBox*) element)->GetFirstRow(); row; row = (TableRowBox*) row->Suc())
+				for (TableCellBox* cell = row->GetFirstCell(); cell; cell = (TableCellBox*) cell->Suc())
+				{
+					int cell_colspan = cell->GetCellColSpan();
+
+					if (cell_colspan == 1)
+						AddCellMinMaxWidths(info, cell);
+					else
+						if (cell_colspan > 1)
+							spanned_count++;
+				}
+
+	if (!spanned_count)
+		return;
+
+	/* Sort the remaining cells on colspan, rather than walking all cells once for each colspan
+	   value. Large tables with many different colspans would otherwise spend most of their
+	   time here. */
+
+	SpannedTableCell* spanned_cells = OP_NEWA(SpannedTableCell, spanned_count);
+
+	if (spanned_cells)
+	{
+		int count = 0;
+
+		for (TableListElement* element = (TableListElement*) layout_stack.First(); element; element = element->Suc())
+			if (element->IsRowGroup())
+				for (TableRowBox* row = ((TableRowGroupBox*) element)->GetFirstRow(); row; row = (TableRowBox*) row->Suc())
+					for (TableCellBox* cell = row->GetFirstCell(); cell; cell = (TableCellBox*) cell->Suc())
+					{
+						int cell_colspan = cell->GetCellColSpan();
+
+						if (cell_colspan > 1)
+						{
+							OP_ASSERT(count < spanned_count);
+
+							spanned_cells[count].cell = cell;
+							spanned_cells[count].colspan = cell_colspan;
+							spanned_cells[count].order = count;
+							count++;
+						}
+					}
+
+		op_qsort(spanned_cells, count, sizeof(SpannedTableCell), CompareSpannedTableCells);
+
+		for (int i = 0; i < count; i++)
+			AddCellMinMaxWidths(info, spanned_cells[i].cell);
+
+		OP_DELETEA(spanned_cells);
+		return;
+	}
+
+	// Out of memory. Walk all cells once for each colspan instead.
+
+	int colspan = 2;
 	int next_colspan;
 
 	do
@@ -13146,14 +13250,7 @@ TableContent::CalculateColumnMinMaxWidths(const LayoutInfo& info)
 						int cell_colspan = cell->GetCellColSpan();
 
 						if (cell_colspan == colspan)
-						{
-							LayoutCoord min_width;
-							LayoutCoord normal_min_width;
-							LayoutCoord max_width;
-
-							if (cell->GetMinMaxWidth(min_width, normal_min_width, max_width))
-								UpdateColumnWidths(info, cell->GetColumn(), cell_colspan, cell->GetDesiredWidth(), min_width, normal_min_width, max_width, TRUE);
-						}
+							AddCellMinMaxWidths(info, cell);
 						else
 							if (cell_colspan > colspan && cell_colspan < next_colspan)
 								next_colspan = cell_colspan;
@@ -21632,6 +21729,13 @@ PagedContainer::ScrollTo(unsigned int page, LayoutCoord offset)
 	current_page = page;
 	page_offset = offset;
 
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+	/* Positioned descendants moved relative to their containing elements.
+	   Sliding and changing the page both end up here. */
+
+	doc->GetLogicalDocument()->GetLayoutWorkplace()->InvalidatePaintOffsets();
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 	if (!scroll)
 	{
 		// Full update.
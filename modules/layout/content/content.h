@@ -78,8 +78,12 @@ enum SEARCH_CONSTRAINT
 
 class Content
 {
+#ifdef LAYOUT_OBJECT_POOL
+	OP_ALLOC_LAYOUT_OBJECT_POOL
+#else
 	OP_ALLOC_ACCOUNTED_POOLING
 	OP_ALLOC_ACCOUNTED_POOLING_SMO_DOCUMENT
+#endif // LAYOUT_OBJECT_POOL
 
 private:
 
@@ -1736,8 +1740,12 @@ public:
 class Line
   : public VerticalLayout
 {
+#ifdef LAYOUT_OBJECT_POOL
+	OP_ALLOC_LAYOUT_OBJECT_POOL
+#else
 	OP_ALLOC_ACCOUNTED_POOLING
 	OP_ALLOC_ACCOUNTED_POOLING_SMO_DOCUMENT
+#endif // LAYOUT_OBJECT_POOL
 
 protected:
 
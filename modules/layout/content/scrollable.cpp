@@ -526,6 +526,12 @@ ScrollableArea::ScrollContent(FramesDocument* doc, LayoutCoord dx, LayoutCoord d
 	OpRect r = GetEdgesInDocumentCoords(box->GetBorderEdges());
 	doc->GetVisualDevice()->Update(r.x, r.y, r.width, r.height);
 
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+	/* Positioned descendants moved relative to their containing elements. */
+
+	doc->GetLogicalDocument()->GetLayoutWorkplace()->InvalidatePaintOffsets();
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 #ifdef DOCUMENT_EDIT_SUPPORT
 	OpDocumentEdit* doc_edit = doc->GetDocumentEdit();
 	if (doc_edit && !doc->IsReflowing())
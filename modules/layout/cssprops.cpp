@@ -177,7 +177,7 @@ CssPropertyItem::GetCssPropertyChangeBits(HTML_Element* elm, CssPropertyItem* a,
 				if (old_opacity == 255 || new_opacity == 255)
 					bits |= PROPS_CHANGED_STRUCTURE;
 				else
-					bits |= PROPS_CHANGED_UPDATE;
+					bits |= PROPS_CHANGED_OPACITY;
 			}
 			IFCHANGE(overflow_wrap, PROPS_CHANGED_SIZE|PROPS_CHANGED_REMOVE_CACHED_TEXT);
 			IFCHANGE(object_fit, PROPS_CHANGED_UPDATE|PROPS_CHANGED_SIZE);
@@ -909,7 +909,12 @@ enum PropertyChange
 	PROPS_CHANGED_TRANSITION = 1 << 8,
 
 	/** The bounding box needs to be recalculated. */
-	PROPS_CHANGED_BOUNDS = 1 << 9
+	PROPS_CHANGED_BOUNDS = 1 << 9,
+
+	/** Only the opacity changed, and it is not 1 before or after the
+		change. Requires a repaint like PROPS_CHANGED_UPDATE, but the
+		content of the element itself is unchanged. */
+	PROPS_CHANGED_OPACITY = 1 << 14
 
 #ifdef SVG_SUPPORT
 	,
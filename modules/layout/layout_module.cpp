@@ -65,10 +65,16 @@ LayoutModule::LayoutModule() :
 #ifdef INTERNAL_SPELLCHECK_SUPPORT
 	misspelling_paint_info_pool(MISSPELLING_PAINT_INFO_POOL_SIZE),
 #endif // INTERNAL_SPELLCHECK_SUPPORT
+#ifdef LAYOUT_OBJECT_POOL
+	layout_object_pool(LAYOUT_OBJECT_POOL_SIZE * 1024),
+#endif // LAYOUT_OBJECT_POOL
 	array_decl(0),
 	m_shared_css_manager(NULL),
 	props_array(NULL),
 	tmp_word_info_array(NULL)
+#ifdef LAYOUT_STYLE_SHARING
+	, props_generation(0)
+#endif // LAYOUT_STYLE_SHARING
 {
 	quotes[0].value_type = 0;
 	quotes[0].value.string = NULL;
@@ -250,6 +256,10 @@ void LayoutModule::DestroyMemoryPools()
 	misspelling_paint_info_pool.Clean();
 	misspelling_paint_info_pool.Destroy();
 #endif // INTERNAL_SPELLCHECK_SUPPORT
+
+#ifdef LAYOUT_OBJECT_POOL
+	layout_object_pool.Clean();
+#endif // LAYOUT_OBJECT_POOL
 }
 
 extern const float tsep_scale = (float) 1.0;
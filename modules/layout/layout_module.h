@@ -65,6 +65,9 @@ public:
 #ifdef INTERNAL_SPELLCHECK_SUPPORT
 	LayoutPool			misspelling_paint_info_pool;
 #endif // INTERNAL_SPELLCHECK_SUPPORT
+#ifdef LAYOUT_OBJECT_POOL
+	LayoutObjectPool	layout_object_pool;
+#endif // LAYOUT_OBJECT_POOL
 	CSS_generic_value	quotes[1];
 	CSS_stack_gen_array_decl
 						array_decl;
@@ -84,11 +87,20 @@ public:
 
 	/** Length of ellipsis text. */
 	short				ellipsis_str_len;
+
+#ifdef LAYOUT_STYLE_SHARING
+	/** The last stamp given to computed cascading properties, see
+		LayoutProperties::GetPropsGeneration(). */
+	unsigned			props_generation;
+#endif // LAYOUT_STYLE_SHARING
 };
 
 #define g_anonymous_first_line_elm g_opera->layout_module.first_line_elm
 #define g_support_attr_array g_opera->layout_module.m_support_attr_array
 #define g_layout_properties_pool (&(g_opera->layout_module.layout_properties_pool))
+#ifdef LAYOUT_OBJECT_POOL
+#define g_layout_object_pool (&(g_opera->layout_module.layout_object_pool))
+#endif // LAYOUT_OBJECT_POOL
 #define g_container_reflow_state_pool (&(g_opera->layout_module.container_reflow_state_pool))
 #define g_verticalbox_reflow_state_pool (&(g_opera->layout_module.verticalbox_reflow_state_pool))
 #define g_inlinebox_reflow_state_pool (&(g_opera->layout_module.inlinebox_reflow_state_pool))
@@ -119,6 +131,10 @@ public:
 #define g_ellipsis_str g_opera->layout_module.ellipsis_str
 #define g_ellipsis_str_len g_opera->layout_module.ellipsis_str_len
 
+#ifdef LAYOUT_STYLE_SHARING
+#define g_layout_props_generation g_opera->layout_module.props_generation
+#endif // LAYOUT_STYLE_SHARING
+
 #define LAYOUT_MODULE_REQUIRED
 
 #endif // !MODULES_LAYOUT_LAYOUT_MODULE_H
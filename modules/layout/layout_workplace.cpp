@@ -23,6 +23,7 @@
 #include "modules/dochand/win.h"
 #include "modules/display/prn_dev.h"
 #include "modules/hardcore/mh/messages.h"
+#include "modules/layout/cascade.h"
 #include "modules/layout/cssprops.h"
 #include "modules/layout/layoutprops.h"
 #include "modules/layout/box/box.h"
@@ -299,6 +300,7 @@ LayoutWorkplace::LayoutWorkplace(FramesDocument* theDoc) :	doc(theDoc)
 	  ,	internal_reflow_count(0)
 #endif
 	  ,	reflow_time(0.0)
+	  ,	visited_box_count(0)
 #ifdef RESERVED_REGIONS
 	  , reserved_region_boxes(0)
 #endif // RESERVED_REGIONS
@@ -358,6 +360,12 @@ LayoutWorkplace::LayoutWorkplace(FramesDocument* theDoc) :	doc(theDoc)
 #ifdef CSS_TRANSITIONS
 	  , transition_manager(theDoc)
 #endif // CSS_TRANSITIONS
+#ifdef LAYOUT_STYLE_SHARING
+	  , style_sharing_cache(NULL)
+#endif // LAYOUT_STYLE_SHARING
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+	  , paint_offset_generation(1)
+#endif // LAYOUT_PAINT_OFFSET_CACHE
 {
 #ifdef GADGET_SUPPORT
 	if (theDoc->GetWindow()->GetGadget())
@@ -810,6 +818,7 @@ OP_STATUS LayoutWorkplace::Reflow(BOOL& reflow_complete, BOOL set_properties, BO
 
 	reflow_complete = FALSE;
 	reflow_start = g_op_time_info->GetRuntimeMS();
+	visited_box_count = 0;
 
 #if defined PAGED_MEDIA_SUPPORT && defined _PRINT_SUPPORT_
 	if (!doc->IsPrintDocument() && logdoc->GetPrintRoot())
@@ -875,6 +884,14 @@ OP_STATUS LayoutWorkplace::Reflow(BOOL& reflow_complete, BOOL set_properties, BO
 
 		SetIsInReflowIteration(FALSE);
 
+#ifdef LAYOUT_STYLE_SHARING
+		/* The cached element and cascade entries are only valid while
+		   reflowing. */
+
+		if (style_sharing_cache)
+			style_sharing_cache->Clear();
+#endif // LAYOUT_STYLE_SHARING
+
 		EndStoreReplacedContent();
 
 		switch (needed_reflow)
@@ -1154,6 +1171,15 @@ OP_BOOLEAN LayoutWorkplace::ReflowOnce(LayoutInfo& info)
 	OP_ASSERT(!logdoc->IsXSLTInProgress());
 #endif // XSLT_SUPPORT
 
+#ifdef LAYOUT_STYLE_SHARING
+	if (style_sharing_cache)
+		style_sharing_cache->Clear();
+#endif // LAYOUT_STYLE_SHARING
+
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+	InvalidatePaintOffsets();
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 	HTML_Element* reflow_root = doc->GetDocRoot();
 
 	OP_ASSERT(!yield_element || !reflow_root->IsDirty());
@@ -2429,6 +2455,26 @@ OP_STATUS LayoutWorkplace::ApplyPropertyChanges(HTML_Element* element, int updat
 		HTML_Element* top_pseudo_element = element;
 		HTML_Element* stop_element = NULL;
 
+#ifdef CSS_INVALIDATION_SETS
+		int invalidation = CSSCollection::INVALIDATE_ALL;
+
+		if (recurse && attr != Markup::HA_NULL && update_pseudo == 0 && !skip_top_element)
+		{
+			/* Only recurse as far as the selectors depending on the attribute require. */
+
+			invalidation = hld_profile->GetCSSCollection()->GetAttributeInvalidation(element, attr, attr_ns);
+			if (!(invalidation & (CSSCollection::INVALIDATE_DESCENDANTS | CSSCollection::INVALIDATE_SIBLINGS)))
+				recurse = FALSE;
+		}
+
+		if (recurse && !(invalidation & CSSCollection::INVALIDATE_SIBLINGS))
+		{
+			stop_element = element->NextSiblingActualStyle();
+			while (stop_element && !Markup::IsRealElement(stop_element->Type()))
+				stop_element = stop_element->NextActualStyle();
+		}
+		else
+#endif // CSS_INVALIDATION_SETS
 		if (recurse)
 		{
 			stop_element = top_pseudo_element;
@@ -2804,6 +2850,14 @@ OP_STATUS LayoutWorkplace::ReloadCssProperties()
 	if (!root->IsPropsDirty() && !root->HasDirtyChildProps())
 		return OpStatus::OK;
 
+#ifdef LAYOUT_STYLE_SHARING
+	/* Reloading may delete the declarations referenced by the cached
+	   properties. */
+
+	if (style_sharing_cache)
+		style_sharing_cache->Clear();
+#endif // LAYOUT_STYLE_SHARING
+
 #ifdef SCOPE_PROFILER
 	OpTypeProbe probe;
 
@@ -2988,11 +3042,11 @@ void LayoutWorkplace::HandleChangeBits(HTML_Element* elm, int changes)
 				elm->RemoveCachedTextInfo(doc);
 
 			const BOOL delete_minmax_widths = !!(changes & (PROPS_CHANGED_SIZE | PROPS_CHANGED_UPDATE_SIZE | PROPS_CHANGED_REMOVE_CACHED_TEXT));
-			const BOOL needs_update = !!(changes & (PROPS_CHANGED_UPDATE_SIZE | PROPS_CHANGED_UPDATE | PROPS_CHANGED_BOUNDS));
+			const BOOL needs_update = !!(changes & (PROPS_CHANGED_UPDATE_SIZE | PROPS_CHANGED_UPDATE | PROPS_CHANGED_BOUNDS | PROPS_CHANGED_OPACITY));
 			elm->MarkDirty(doc, delete_minmax_widths, needs_update);
 		}
 		else
-			if (changes & PROPS_CHANGED_UPDATE)
+			if (changes & (PROPS_CHANGED_UPDATE | PROPS_CHANGED_OPACITY))
 				if (Box* box = elm->GetLayoutBox())
 					if (doc->GetDocRoot()->IsDirty())
 						/* This optimisation is based on the assumption that if
@@ -3031,7 +3085,22 @@ void LayoutWorkplace::HandleChangeBits(HTML_Element* elm, int changes)
 						}
 
 						if (box->GetRect(doc, BOUNDING_BOX, rect))
-							vis_dev->Update(rect.left, rect.top, rect.right - rect.left + 1, rect.bottom - rect.top + 1, TRUE);
+						{
+#ifdef DISPLAY_OPACITY_LAYERS
+							if (!(changes & PROPS_CHANGED_UPDATE))
+							{
+								/* Only the opacity changed, so a cached layer of the element
+								   itself is still good, but the layers of ancestors are not. */
+
+								for (HTML_Element* ancestor = elm->Parent(); ancestor && vis_dev->HasOpacityLayers(); ancestor = ancestor->Parent())
+									vis_dev->RemoveOpacityLayer(ancestor);
+
+								vis_dev->UpdateOpacityLayer(rect.left, rect.top, rect.right - rect.left + 1, rect.bottom - rect.top + 1);
+							}
+							else
+#endif // DISPLAY_OPACITY_LAYERS
+								vis_dev->Update(rect.left, rect.top, rect.right - rect.left + 1, rect.bottom - rect.top + 1, TRUE);
+						}
 
 						if (!fixed_positioned_area.IsEmpty())
 							box->InvalidateFixedDescendants(doc);
@@ -3245,7 +3314,27 @@ LayoutWorkplace::~LayoutWorkplace()
 	reflow_elements.Clear();
 	ClearCounters();
 	OP_ASSERT(stored_replaced_content.Empty());
+#ifdef LAYOUT_STYLE_SHARING
+	OP_DELETE(style_sharing_cache);
+#endif // LAYOUT_STYLE_SHARING
+}
+
+#ifdef LAYOUT_STYLE_SHARING
+StyleSharingCache*
+LayoutWorkplace::GetStyleSharingCache()
+{
+	if (!style_sharing_cache)
+		style_sharing_cache = OP_NEW(StyleSharingCache, ());
+
+	return style_sharing_cache;
+}
+
+unsigned
+LayoutWorkplace::GetStyleSharingHits() const
+{
+	return style_sharing_cache ? style_sharing_cache->GetHits() : 0;
 }
+#endif // LAYOUT_STYLE_SHARING
 
 #ifdef _PLUGIN_SUPPORT_
 BOOL
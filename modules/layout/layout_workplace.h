@@ -28,6 +28,9 @@
 
 class FramesDocument;
 class ReplacedContent;
+#ifdef LAYOUT_STYLE_SHARING
+class StyleSharingCache;
+#endif // LAYOUT_STYLE_SHARING
 
 class DocRootProperties
 {
@@ -392,6 +395,17 @@ public:
 
 	double			GetReflowTime() const { return reflow_time; }
 
+	/** Count a box visited (created or laid out) during reflow. */
+
+	void			CountVisitedBox() { ++visited_box_count; }
+
+	/** Get the number of boxes visited by the last call to Reflow().
+
+		Boxes in clean subtrees are skipped without being visited, so this
+		tells how much of the tree a reflow had to walk. */
+
+	unsigned int	GetVisitedBoxCount() const { return visited_box_count; }
+
 	void			StoreTranslation();
 
 	/*********** Yield methods **********/
@@ -1034,6 +1048,36 @@ public:
 					GetDocRootProperties() const { return *active_doc_root_props; }
 	void			SwitchPrintingDocRootProperties();
 
+#ifdef LAYOUT_STYLE_SHARING
+	/** Get the cache used to share computed styles between equivalent
+		sibling elements in this document.
+
+		@return The cache, or NULL on OOM. */
+
+	StyleSharingCache*
+					GetStyleSharingCache();
+
+	/** @return The number of elements that got their computed style from
+		an equivalent sibling in this document. */
+
+	unsigned		GetStyleSharingHits() const;
+#endif // LAYOUT_STYLE_SHARING
+
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+	/** Get the generation of box offsets in this document. Offsets of
+		positioned boxes computed while painting may be cached for as long
+		as the generation stays the same. Never 0.
+
+		@see ZElement::GetCachedOffset() */
+
+	unsigned		GetPaintOffsetGeneration() const { return paint_offset_generation; }
+
+	/** Start a new generation of box offsets. Called when reflowing, and
+		when scrolling a scrollable box moves its content without reflow. */
+
+	void			InvalidatePaintOffsets() { if (++paint_offset_generation == 0) paint_offset_generation = 1; }
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 	/** Returns TRUE if the element is a "magic" body element. */
 	static BOOL		IsMagicBodyElement(HTML_Element *element, HTML_Element *parent,
 									   HTML_Element *first_body_element,
@@ -1344,6 +1388,10 @@ private:
 
 	double			reflow_time;
 
+	/** Number of boxes visited by the last call to Reflow(). */
+
+	unsigned int	visited_box_count;
+
 	/** when did this reflow start? */
 
 	double			reflow_start;
@@ -1510,6 +1558,18 @@ private:
 	TransitionManager
 					transition_manager;
 #endif // CSS_TRANSITIONS
+
+#ifdef LAYOUT_STYLE_SHARING
+	/** Computed style of the most recently cascaded element, to be shared
+		with its next sibling. Created on demand. */
+	StyleSharingCache*
+					style_sharing_cache;
+#endif // LAYOUT_STYLE_SHARING
+
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+	/** Generation of box offsets cached in ZElements while painting. */
+	unsigned		paint_offset_generation;
+#endif // LAYOUT_PAINT_OFFSET_CACHE
 };
 
 inline COLORREF BackgroundColor(const HTMLayoutProperties &props)
@@ -67,3 +67,71 @@ LayoutPool::Clean()
 	while (m_next > 0)
 		op_free(m_pool[--m_next]);
 }
+
+#ifdef LAYOUT_OBJECT_POOL
+
+LayoutObjectPool::LayoutObjectPool(size_t max_cached_bytes) :
+	m_cached_bytes(0),
+	m_max_cached_bytes(max_cached_bytes)
+{
+	for (unsigned int i = 0; i < CLASS_COUNT; ++i)
+		m_free[i] = NULL;
+}
+
+void*
+LayoutObjectPool::New(size_t nbytes)
+{
+	if (nbytes > MAX_POOLED_SIZE)
+		return op_malloc(nbytes);
+
+	unsigned int size_class = SizeClass(nbytes);
+
+	if (FreeBlock* block = m_free[size_class])
+	{
+		m_free[size_class] = block->next;
+		m_cached_bytes -= GetBlockSize(nbytes);
+		return block;
+	}
+
+	/* Always allocate the full block size, so that any block in the
+	   class can be reused for any object in it. */
+
+	return op_malloc(GetBlockSize(nbytes));
+}
+
+void
+LayoutObjectPool::Delete(void* p, size_t nbytes)
+{
+	if (p == 0)
+		return;
+
+	size_t block_size = GetBlockSize(nbytes);
+
+	if (!block_size || m_cached_bytes + block_size > m_max_cached_bytes)
+	{
+		op_free(p);
+		return;
+	}
+
+	unsigned int size_class = SizeClass(nbytes);
+	FreeBlock* block = static_cast<FreeBlock*>(p);
+
+	block->next = m_free[size_class];
+	m_free[size_class] = block;
+	m_cached_bytes += block_size;
+}
+
+void
+LayoutObjectPool::Clean()
+{
+	for (unsigned int i = 0; i < CLASS_COUNT; ++i)
+		while (FreeBlock* block = m_free[i])
+		{
+			m_free[i] = block->next;
+			op_free(block);
+		}
+
+	m_cached_bytes = 0;
+}
+
+#endif // LAYOUT_OBJECT_POOL
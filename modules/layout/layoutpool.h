@@ -29,4 +29,80 @@ private:
 	int m_size;
 };
 
+#ifdef LAYOUT_OBJECT_POOL
+
+/** Free lists of memory for layout objects (boxes, content and lines),
+	one per size class.
+
+	Layout objects are allocated and freed in large numbers every time a
+	document is laid out or its layout tree is torn down. Freed blocks are
+	kept for reuse by objects of the same size class instead of going back
+	to the heap, up to a limit on the total size kept. Objects larger than
+	the largest size class are allocated on the heap. */
+
+class LayoutObjectPool
+{
+public:
+	LayoutObjectPool(size_t max_cached_bytes);
+	~LayoutObjectPool() { Clean(); }
+
+	void* New(size_t nbytes);
+	void Delete(void* p, size_t nbytes);
+
+	/** Free all blocks kept for reuse. */
+
+	void Clean();
+
+	/** Get the total size of the blocks kept for reuse. */
+
+	size_t GetCachedBytes() const { return m_cached_bytes; }
+
+	/** Get the size of the blocks in the size class for nbytes, or 0 if
+		nbytes is too large to be pooled. */
+
+	static size_t GetBlockSize(size_t nbytes) { return nbytes <= MAX_POOLED_SIZE ? (SizeClass(nbytes) + 1) * GRANULARITY : 0; }
+
+private:
+	enum
+	{
+		GRANULARITY = 16,
+		CLASS_COUNT = 32,
+		MAX_POOLED_SIZE = GRANULARITY * CLASS_COUNT
+	};
+
+	static unsigned int SizeClass(size_t nbytes) { return nbytes ? (nbytes - 1) / GRANULARITY : 0; }
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	FreeBlock* m_free[CLASS_COUNT]; /* ARRAY OK 2012-10-19 rune */
+	size_t m_cached_bytes;
+	size_t m_max_cached_bytes;
+};
+
+#if defined ENABLE_MEMORY_DEBUGGING || MEMORY_NAMESPACE_OP_NEW
+# define LAYOUT_OBJECT_POOL_PLAIN_NEW \
+	void* operator new(size_t size) OP_NOTHROW \
+	{ void* ptr = g_layout_object_pool->New(size); MEM_ACCOUNTED_INC(ptr, size); }
+#else
+# define LAYOUT_OBJECT_POOL_PLAIN_NEW
+#endif
+
+/** Allocate objects of a class (and its subclasses) from the layout object
+	pool. Used instead of OP_ALLOC_ACCOUNTED_POOLING and
+	OP_ALLOC_ACCOUNTED_POOLING_SMO_DOCUMENT, and counts the memory as
+	document memory just like them. */
+
+#define OP_ALLOC_LAYOUT_OBJECT_POOL \
+	public: \
+	void* MEMORY_SIGNATURE_NEW \
+	{ void* ptr = g_layout_object_pool->New(size); MEM_ACCOUNTED_INC(ptr, size); } \
+	LAYOUT_OBJECT_POOL_PLAIN_NEW \
+	void operator delete(void* ptr, size_t size) \
+	{ if (ptr) { MEM_ACCOUNTED_DEC(size); g_layout_object_pool->Delete(ptr, size); } }
+
+#endif // LAYOUT_OBJECT_POOL
+
 #endif // !MODULES_LAYOUT_LAYOUT_POOL_H
@@ -16,6 +16,7 @@
 
 #ifdef CSS_TRANSITIONS
 
+#include "modules/display/vis_dev.h"
 #include "modules/doc/frm_doc.h"
 #include "modules/layout/cascade.h"
 #include "modules/layout/layout_workplace.h"
@@ -1191,7 +1192,7 @@ NumberTransition::Animate(double runtime_ms)
 			if (m_current == 1.0 || cur == 1.0)
 				changes |= PROPS_CHANGED_STRUCTURE;
 			else
-				changes |= PROPS_CHANGED_UPDATE;
+				changes |= PROPS_CHANGED_OPACITY;
 			break;
 		case CSS_PROPERTY_flex_grow:
 		case CSS_PROPERTY_flex_shrink:
@@ -2210,6 +2211,12 @@ ElementTransitions::Animate(FramesDocument* doc, double runtime_ms, HTML_Element
 
 			change_bits |= trans->Animate(trans->GetEndMS());
 
+#ifdef DISPLAY_OPACITY_LAYERS
+			if (trans->GetProperty() == CSS_PROPERTY_opacity)
+				if (VisualDevice* vis_dev = doc->GetVisualDevice())
+					vis_dev->RemoveOpacityLayer(GetElm());
+#endif // DISPLAY_OPACITY_LAYERS
+
 			trans = trans->Suc();
 			del->Out();
 			OP_DELETE(del);
@@ -2340,9 +2347,19 @@ TransitionManager::ElementRemoved(HTML_Element* element)
 	if (OpStatus::IsSuccess(m_elm_transitions.Remove(element, &transitions)))
 	{
 		OP_DELETE(transitions);
+		RemoveOpacityLayer(element);
 	}
 }
 
+void
+TransitionManager::RemoveOpacityLayer(HTML_Element* element)
+{
+#ifdef DISPLAY_OPACITY_LAYERS
+	if (VisualDevice* vis_dev = m_doc->GetVisualDevice())
+		vis_dev->RemoveOpacityLayer(element);
+#endif // DISPLAY_OPACITY_LAYERS
+}
+
 void
 TransitionManager::AbortTransitions(HTML_Element* element)
 {
@@ -2392,6 +2409,7 @@ TransitionManager::Animate()
 			ElementTransitions* elm_trans = delete_transitions.Get(i);
 			ElementTransitions* dummy;
 			OpStatus::Ignore(m_elm_transitions.Remove(elm_trans->GetElement(), &dummy));
+			RemoveOpacityLayer(elm_trans->GetElement());
 			OP_DELETE(elm_trans);
 		}
 
@@ -1499,6 +1499,13 @@ public:
 
 private:
 
+	/** Throw away the painted content kept for element's opacity
+		transition, if any. Done when the element stops having
+		transitions, so that a layer never outlives the element it is
+		keyed by. */
+
+	void RemoveOpacityLayer(HTML_Element* element);
+
 	class TransitionsIterator
 	{
 	public:
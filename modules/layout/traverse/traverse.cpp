@@ -1068,8 +1068,23 @@ AreaTraversalObject::TraversePositionedElement(HTML_Element* element, HTML_Eleme
 
 		LayoutCoord x(0);
 		LayoutCoord y(0);
+		int offset_result;
 
-		int offset_result = box->GetOffsetFromAncestor(x, y, containing_element, Box::GETPOS_ABORT_ON_INLINE);
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+		/* Only trust the stacking context entry if it is the one of this
+		   element. Nothing moves between paints in the same generation. */
+
+		if (cached_offset_generation && current_z_element && current_z_element->GetHtmlElement() == element)
+		{
+			if (!current_z_element->GetCachedOffset(cached_offset_generation, x, y, offset_result))
+			{
+				offset_result = box->GetOffsetFromAncestor(x, y, containing_element, Box::GETPOS_ABORT_ON_INLINE);
+				current_z_element->SetCachedOffset(cached_offset_generation, x, y, offset_result);
+			}
+		}
+		else
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+			offset_result = box->GetOffsetFromAncestor(x, y, containing_element, Box::GETPOS_ABORT_ON_INLINE);
 
 		if (offset_result & (Box::GETPOS_INLINE_FOUND | Box::GETPOS_FIXED_FOUND
 #ifdef CSS_TRANSFORMS
@@ -3828,6 +3843,10 @@ PaintObject::PaintObject(FramesDocument* doc,
 #endif // INTERNAL_SPELLCHECK_SUPPORT
 {
 	SetEnterHidden(TRUE);
+
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+	cached_offset_generation = GetLayoutWorkplace()->GetPaintOffsetGeneration();
+#endif // LAYOUT_PAINT_OFFSET_CACHE
 }
 
 /* virtual */ BOOL
@@ -3883,6 +3902,26 @@ PaintObject::EnterVerticalBox(LayoutProperties* parent_lprops, LayoutProperties*
 			OpRect rect;
 			bounding_box.GetBoundingRect(rect);
 
+#if defined DISPLAY_OPACITY_LAYERS && defined CSS_TRANSITIONS
+			/* Keep the content of elements with a running opacity transition, so
+			   that the next frames only have to blend it with a new opacity. The
+			   element must be a stacking context, so that all of its content is
+			   painted between here and LeaveVerticalBox. */
+
+			if (props.transition_packed2.opacity && !GetTarget() && box->GetLocalStackingContext() && !props.IsOutlineVisible())
+			{
+				BOOL painted = FALSE;
+
+				if (!rect.IsEmpty() && OpStatus::IsSuccess(visual_device->BeginOpacityLayer(layout_props->html_element, rect, props.opacity, painted)))
+				{
+					if (painted)
+						return FALSE;
+
+					traverse_info.has_buffered = TRUE;
+				}
+			}
+			else
+#endif // DISPLAY_OPACITY_LAYERS && CSS_TRANSITIONS
 			if (!rect.IsEmpty() && OpStatus::IsSuccess(visual_device->BeginOpacity(rect, props.opacity)))
 			{
 				traverse_info.has_buffered = TRUE;
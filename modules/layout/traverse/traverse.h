@@ -356,6 +356,18 @@ protected:
 
 	Container*		current_target_container;
 
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+
+	/** Used by AreaTraversalObject.
+
+		The stacking context entry of the element passed to
+		TraversePositionedElement(), when called from StackingContext::Traverse().
+		NULL otherwise. */
+
+	const ZElement*	current_z_element;
+
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 public:
 					TraversalObject(FramesDocument* doc)
 					  : type(TRAVERSE_BACKGROUND),
@@ -391,7 +403,11 @@ public:
 						next_container_element(NULL),
 						off_target_path(FALSE),
 						target_intersection_checking(FALSE),
-						current_target_container(NULL) {}
+						current_target_container(NULL)
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+					  , current_z_element(NULL)
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+						{}
 	virtual			~TraversalObject() {}
 
 	/** Traverse document. */
@@ -994,6 +1010,15 @@ public:
 
 	virtual BOOL	TraversePositionedElement(HTML_Element* element, HTML_Element* containing_element) { return TRUE; }
 
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+
+	/** Set the stacking context entry of the element about to be passed to
+		TraversePositionedElement(), or NULL when done. */
+
+	void			SetCurrentZElement(const ZElement* z_element) { current_z_element = z_element; }
+
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 	/** Out of memory? */
 
 	BOOL			IsOutOfMemory() const { return out_of_memory; }
@@ -1138,6 +1163,19 @@ protected:
 
 	BOOL			HandleSkippedTarget(HTML_Element* current_containing_elm, HTML_Element* tested_elm);
 
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+
+	/** LayoutWorkplace::GetPaintOffsetGeneration() when the traversal
+		started, or 0 if offsets of positioned elements shall not be
+		cached in their ZElement by TraversePositionedElement().
+
+		Only set by traversal objects that never reflow and are created
+		often without the layout changing, like PaintObject. */
+
+	unsigned		cached_offset_generation;
+
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+
 public:
 
 					AreaTraversalObject(FramesDocument* doc, const RECT& area)
@@ -1145,13 +1183,21 @@ public:
 						area(area),
 						enter_all(FALSE),
 						container_translation_x(0),
-						container_translation_y(0) {}
+						container_translation_y(0)
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+					  , cached_offset_generation(0)
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+						{}
 
 					AreaTraversalObject(FramesDocument* doc)
 					  : TraversalObject(doc),
 						enter_all(FALSE),
 						container_translation_x(0),
-						container_translation_y(0) {}
+						container_translation_y(0)
+#ifdef LAYOUT_PAINT_OFFSET_CACHE
+					  , cached_offset_generation(0)
+#endif // LAYOUT_PAINT_OFFSET_CACHE
+						{}
 
 	/** Set to TRUE if all boxes should be entered no matter the area is. */
 
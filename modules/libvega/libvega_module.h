@@ -96,6 +96,12 @@ public:
 #ifdef VEGA_USE_ASM
 	class VEGADispatchTable* dispatchTable;
 #endif // VEGA_USE_ASM
+
+#ifdef VEGA_TILED_RASTERIZATION
+	/** The platform workers rasterizing tiles of large fills in the
+	 * software backend, or NULL if there are none. */
+	class VEGATileWorkers* tileWorkers;
+#endif // VEGA_TILED_RASTERIZATION
 };
 
 // We can only enable support the Canvas Text APIs if SVG is supported.
@@ -1389,6 +1389,17 @@ void VEGAOpPainter::DrawBitmapClippedAlpha(const OpBitmap* bitmap, const OpRect&
 	DrawBitmapClipped(bitmap, source, p);
 }
 
+BOOL VEGAOpPainter::DrawBitmapClippedOpacity(const OpBitmap* bitmap, const OpRect& source, OpPoint p, int opacity)
+{
+	// Same as DrawBitmapClipped with the image opacity scaled, so that
+	// callers do not have to fall back to a pre-alpha blit.
+	int image_opacity = m_image_opacity;
+	m_image_opacity = image_opacity * opacity / 255;
+	DrawBitmapClipped(bitmap, source, p);
+	m_image_opacity = image_opacity;
+	return TRUE;
+}
+
 void VEGAOpPainter::DrawBitmapScaled(const OpBitmap* bitmap, const OpRect& source, const OpRect& dest)
 {
 	OP_ASSERT(OpRect(0, 0, bitmap->Width(), bitmap->Height()).Contains(source));
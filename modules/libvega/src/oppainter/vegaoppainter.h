@@ -99,6 +99,7 @@ public:
 	void DrawBitmapClipped(const OpBitmap* bitmap, const OpRect& source, OpPoint p);
 	void DrawBitmapClippedTransparent(const OpBitmap* bitmap, const OpRect& source, OpPoint p);
 	void DrawBitmapClippedAlpha(const OpBitmap* bitmap, const OpRect& source, OpPoint p);
+	virtual BOOL DrawBitmapClippedOpacity(const OpBitmap* bitmap, const OpRect& source, OpPoint p, int opacity);
 
 	virtual void DrawBitmapScaled(const OpBitmap* bitmap, const OpRect& source, const OpRect& dest);
 	virtual void DrawBitmapScaledTransparent(const OpBitmap* bitmap, const OpRect& source, const OpRect& dest);
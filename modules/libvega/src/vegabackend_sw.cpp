@@ -42,6 +42,11 @@ OP_STATUS VEGABackend_SW::init(unsigned int w, unsigned int h, unsigned int q)
 	rasterizer.setConsumer(this);
 	rasterizer.setQuality(q);
 
+#ifdef VEGA_TILED_RASTERIZATION
+	tiled_rasterizer.initialize(w, h);
+	tiled_rasterizer.setQuality(q);
+#endif // VEGA_TILED_RASTERIZATION
+
 	maskscratch = rasterizer.getMaskScratch();
 	return OpStatus::OK;
 }
@@ -49,6 +54,9 @@ OP_STATUS VEGABackend_SW::init(unsigned int w, unsigned int h, unsigned int q)
 OP_STATUS VEGABackend_SW::updateQuality()
 {
 	rasterizer.setQuality(quality);
+#ifdef VEGA_TILED_RASTERIZATION
+	tiled_rasterizer.setQuality(quality);
+#endif // VEGA_TILED_RASTERIZATION
 	return OpStatus::OK;
 }
 
@@ -1264,6 +1272,28 @@ OP_STATUS VEGABackend_SW::fillPath(VEGAPath *path, VEGAStencil *stencil)
 
 	RETURN_IF_ERROR(path->close(false));
 
+#ifdef VEGA_TILED_RASTERIZATION
+	// Large solid color fills are split into tiles that are rasterized
+	// concurrently. Fills and stencils are not safe to use from several
+	// threads at once.
+	if (!stencil && !fillstate.fill && renderTarget->getColorFormat() != VEGARenderTarget::RT_ALPHA8)
+	{
+		unsigned int tile_count = VEGATiledRasterizer::tileCount(g_vegaGlobals.tileWorkers, cliprect_sy, cliprect_ey);
+		if (tile_count > 1)
+		{
+			RETURN_IF_ERROR(tiled_rasterizer.rasterize(path, g_vegaGlobals.tileWorkers, tile_count, buffer,
+													   cliprect_sx, cliprect_sy, cliprect_ex, cliprect_ey, xorFill,
+													   fillstate.ppixel, fillstate.alphaBlend,
+													   r_minx, r_miny, r_maxx, r_maxy));
+
+			if (r_maxx >= r_minx && r_maxy >= r_miny)
+				renderTarget->markDirty(r_minx, r_maxx, r_miny, r_maxy);
+
+			return OpStatus::OK;
+		}
+	}
+#endif // VEGA_TILED_RASTERIZATION
+
 	if (fillstate.fill)
 		RETURN_IF_ERROR(fillstate.fill->prepare());
 
@@ -1493,14 +1523,7 @@ void VEGABackend_SW::drawSpans(VEGASpanInfo* raster_spans, unsigned int span_cou
 				}
 				else
 				{
-					if (span.mask)
-					{
-						VEGACompOverIn(dst.Ptr(), fillstate.ppixel, span.mask, span.length);
-					}
-					else
-					{
-						VEGACompOver(dst.Ptr(), fillstate.ppixel, span.length);
-					}
+					drawSolidSpan(buffer, span, fillstate.ppixel, true);
 				}
 			}
 			else /* !alphaBlend */
@@ -1571,26 +1594,49 @@ void VEGABackend_SW::drawSpans(VEGASpanInfo* raster_spans, unsigned int span_cou
 				}
 				else
 				{
-					if (span.mask)
-					{
-						const UINT8* mask = span.mask;
-
-						unsigned cnt = span.length;
-						while (cnt-- > 0)
-						{
-							dst.Store(VEGACompOverIn(fillstate.ppixel, dst.Load(), 0xff - *mask));
-							++dst;
-							++mask;
-						}
-					}
-					else
-					{
-						dst.Store(fillstate.ppixel, span.length);
-					}
+					drawSolidSpan(buffer, span, fillstate.ppixel, false);
 				}
 			}
 		}
 	}
 }
 
+/* static */
+void VEGABackend_SW::drawSolidSpan(VEGASWBuffer* buffer, const VEGASpanInfo& span, UINT32 ppixel, bool alphaBlend)
+{
+	VEGAPixelAccessor dst = buffer->GetAccessor(span.pos, span.scanline);
+
+	if (alphaBlend)
+	{
+		if (span.mask)
+		{
+			VEGACompOverIn(dst.Ptr(), ppixel, span.mask, span.length);
+		}
+		else
+		{
+			VEGACompOver(dst.Ptr(), ppixel, span.length);
+		}
+	}
+	else
+	{
+		// Blend the dest color to the source color instead.
+		if (span.mask)
+		{
+			const UINT8* mask = span.mask;
+
+			unsigned cnt = span.length;
+			while (cnt-- > 0)
+			{
+				dst.Store(VEGACompOverIn(ppixel, dst.Load(), 0xff - *mask));
+				++dst;
+				++mask;
+			}
+		}
+		else
+		{
+			dst.Store(ppixel, span.length);
+		}
+	}
+}
+
 #endif // VEGA_SUPPORT
@@ -12,6 +12,9 @@
 #ifdef VEGA_SUPPORT
 #include "modules/libvega/src/vegabackend.h"
 #include "modules/libvega/src/vegarasterizer.h"
+#ifdef VEGA_TILED_RASTERIZATION
+# include "modules/libvega/src/vegatiledrasterizer.h"
+#endif // VEGA_TILED_RASTERIZATION
 
 class VEGABackend_SW :
 	public VEGARendererBackend,
@@ -65,8 +68,19 @@ public:
 
 	unsigned calculateArea(VEGA_FIX minx, VEGA_FIX miny, VEGA_FIX maxx, VEGA_FIX maxy);
 
+	/** Draw a span with a solid color to a color buffer.
+	 * @param buffer the destination.
+	 * @param span the span, with its coverage.
+	 * @param ppixel the color, as a packed pixel.
+	 * @param alphaBlend true to blend the color onto the destination,
+	 * false to replace the covered part of the destination. */
+	static void drawSolidSpan(VEGASWBuffer* buffer, const VEGASpanInfo& span, UINT32 ppixel, bool alphaBlend);
+
 protected:
 	VEGARasterizer rasterizer;
+#ifdef VEGA_TILED_RASTERIZATION
+	VEGATiledRasterizer tiled_rasterizer;
+#endif // VEGA_TILED_RASTERIZATION
 	VEGASWBuffer* buffer;
 
 	void drawSpans(VEGASpanInfo* raster_spans, unsigned int span_count);
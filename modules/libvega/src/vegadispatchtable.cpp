@@ -11,6 +11,7 @@
 #if defined(VEGA_SUPPORT) && defined(VEGA_USE_ASM)
 
 #include "modules/libvega/src/vegapixelformat.h"
+#include "modules/libvega/src/vegafiltergaussian.h"
 
 VEGADispatchTable::VEGADispatchTable()
 {
@@ -47,6 +48,8 @@ VEGADispatchTable::VEGADispatchTable()
 	ConvertFrom_BGR565 = VEGA_PIXEL_FORMAT_CLASS::UnpackFormatConvertRGB<VEGAFormatUnpack::BGR565_Unpack, 2>;
 	ConvertFrom_RGB888 = VEGA_PIXEL_FORMAT_CLASS::UnpackFormatConvertRGB<VEGAFormatUnpack::RGB888_Unpack, 3>;
 
+	BoxBlur4_8888 = VEGAFilterGaussian::boxBlur4;
+
 	// Add accelerated hooks depending on CPU architecture and available features.
 	PopulateHooks();
 }
@@ -91,6 +91,15 @@ public:
 	void (*StoreTo_8888)(UINT32* dst, UINT32 s, unsigned len);
 	void (*MoveFromTo_8888)(UINT32* dst, const UINT32* src, unsigned len);
 
+	/*
+	 * Filters
+	 */
+
+	void (*BoxBlur4_8888)(UINT32* dst, unsigned dststride, unsigned dstlanestride,
+						  const UINT32* src, unsigned srcstride, unsigned srclanestride,
+						  unsigned count, unsigned left_count, unsigned right_count,
+						  UINT32* cbuf, unsigned cbuf_mask);
+
 private:
 #ifdef VEGA_VERIFY_SIMD
 	bool VerifySSSE3();
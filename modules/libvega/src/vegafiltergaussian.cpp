@@ -288,10 +288,11 @@ static inline VEGA_PIXEL pack_pixel(unsigned int acc_a, unsigned int acc_r,
 	return VEGA_PACK_ARGB(da, dr, dg, db);
 }
 
-void VEGAFilterGaussian::boxBlurRow(VEGAPixelPtr dstp, unsigned int dststride,
-									VEGAPixelPtr srcp, unsigned int srcstride,
-									unsigned int count,
-									unsigned int left_count, unsigned int right_count)
+static void box_blur_line(VEGAPixelPtr dstp, unsigned int dststride,
+						  VEGAPixelPtr srcp, unsigned int srcstride,
+						  unsigned int count,
+						  unsigned int left_count, unsigned int right_count,
+						  UINT32* cbuf, unsigned int cbuf_mask)
 {
 	unsigned int acc_a;
 	unsigned int acc_r;
@@ -364,6 +365,61 @@ void VEGAFilterGaussian::boxBlurRow(VEGAPixelPtr dstp, unsigned int dststride,
 	}
 }
 
+void VEGAFilterGaussian::boxBlurRow(VEGAPixelPtr dstp, unsigned int dststride,
+									VEGAPixelPtr srcp, unsigned int srcstride,
+									unsigned int count,
+									unsigned int left_count, unsigned int right_count)
+{
+	box_blur_line(dstp, dststride, srcp, srcstride, count, left_count, right_count, cbuf, cbuf_mask);
+}
+
+#ifdef VEGA_USE_ASM
+/* static */
+void VEGAFilterGaussian::boxBlur4(UINT32* dstp, unsigned int dststride, unsigned int dstlanestride,
+								  const UINT32* srcp, unsigned int srcstride, unsigned int srclanestride,
+								  unsigned int count,
+								  unsigned int left_count, unsigned int right_count,
+								  UINT32* cbuf, unsigned int cbuf_mask)
+{
+	// Each lane gets its own part of the ring buffer.
+	for (unsigned int lane = 0; lane < 4; ++lane)
+	{
+		VEGAPixelPtr dst_lane;
+		dst_lane.rgba = dstp + lane * dstlanestride;
+		VEGAPixelPtr src_lane;
+		src_lane.rgba = const_cast<UINT32*>(srcp) + lane * srclanestride;
+
+		box_blur_line(dst_lane, dststride, src_lane, srcstride,
+					  count, left_count, right_count,
+					  cbuf + lane * (cbuf_mask + 1), cbuf_mask);
+	}
+}
+
+void VEGAFilterGaussian::boxBlur4Passes(UINT32* dstp, unsigned int dststride, unsigned int dstlanestride,
+										const UINT32* srcp, unsigned int srcstride, unsigned int srclanestride,
+										unsigned int count, unsigned int half_k, bool odd)
+{
+	unsigned int left_count[3], right_count[3];
+	if (odd)
+	{
+		left_count[0] = left_count[1] = left_count[2] = half_k;
+		right_count[0] = right_count[1] = right_count[2] = half_k;
+	}
+	else
+	{
+		left_count[0] = half_k;   right_count[0] = half_k-1; // d shift left
+		left_count[1] = half_k-1; right_count[1] = half_k;   // d shift right
+		left_count[2] = half_k;   right_count[2] = half_k;   // d+1
+	}
+
+	g_vegaDispatchTable->BoxBlur4_8888(dstp, dststride, dstlanestride, srcp, srcstride, srclanestride,
+									   count, left_count[0], right_count[0], cbuf, cbuf_mask);
+	for (unsigned int pass = 1; pass < 3; ++pass)
+		g_vegaDispatchTable->BoxBlur4_8888(dstp, dststride, dstlanestride, dstp, dststride, dstlanestride,
+										   count, left_count[pass], right_count[pass], cbuf, cbuf_mask);
+}
+#endif // VEGA_USE_ASM
+
 void VEGAFilterGaussian::boxBlurRow_A(VEGAPixelPtr dstp, unsigned int dststride,
 									  VEGAPixelPtr srcp, unsigned int srcstride,
 									  unsigned int count,
@@ -627,10 +683,23 @@ void VEGAFilterGaussian::blur(const VEGASWBuffer& dstbuf, const VEGASWBuffer& sr
 	else
 	{
 		// Large stddevs
+		unsigned int yp = 0;
+#ifdef VEGA_USE_ASM
+		// Four rows at a time, one row per lane.
+		for (; yp + 4 <= height; yp += 4)
+		{
+			boxBlur4Passes(dst.Ptr().rgba, 1, dststride, src.Ptr().rgba, 1, srcstride,
+						   width, half_kw, (kernel_w & 1) != 0);
+
+			dst += 4 * dststride;
+			src += 4 * srcstride;
+		}
+#endif // VEGA_USE_ASM
+
 		if (kernel_w & 1)
 		{
 			// Odd
-			for (unsigned int yp = 0; yp < height; ++yp)
+			for (; yp < height; ++yp)
 			{
 				boxBlurRow(dst.Ptr(), 1, src.Ptr(), 1,
 						   width, half_kw, half_kw);
@@ -646,7 +715,7 @@ void VEGAFilterGaussian::blur(const VEGASWBuffer& dstbuf, const VEGASWBuffer& sr
 		else
 		{
 			// Even
-			for (unsigned int yp = 0; yp < height; ++yp)
+			for (; yp < height; ++yp)
 			{
 				boxBlurRow(dst.Ptr(), 1, src.Ptr(), 1,
 						   width, half_kw, half_kw-1); // d shift left
@@ -683,10 +752,22 @@ void VEGAFilterGaussian::blur(const VEGASWBuffer& dstbuf, const VEGASWBuffer& sr
 	else
 	{
 		// Large stddevs
+		unsigned int xp = 0;
+#ifdef VEGA_USE_ASM
+		// Four columns at a time, one column per lane.
+		for (; xp + 4 <= width; xp += 4)
+		{
+			boxBlur4Passes(dst.Ptr().rgba, dststride, 1, dst.Ptr().rgba, dststride, 1,
+						   height, half_kh, (kernel_h & 1) != 0);
+
+			dst += 4;
+		}
+#endif // VEGA_USE_ASM
+
 		if (kernel_h & 1)
 		{
 			// Odd
-			for (unsigned int xp = 0; xp < width; ++xp)
+			for (; xp < width; ++xp)
 			{
 				boxBlurRow(dst.Ptr(), dststride, dst.Ptr(), dststride,
 						   height, half_kh, half_kh);
@@ -701,7 +782,7 @@ void VEGAFilterGaussian::blur(const VEGASWBuffer& dstbuf, const VEGASWBuffer& sr
 		else
 		{
 			// Even
-			for (unsigned int xp = 0; xp < width; ++xp)
+			for (; xp < width; ++xp)
 			{
 				boxBlurRow(dst.Ptr(), dststride, dst.Ptr(), dststride,
 						   height, half_kh, half_kh-1); // d shift left
@@ -1737,7 +1818,12 @@ OP_STATUS VEGAFilterGaussian::apply(const VEGASWBuffer& dest, const VEGAFilterRe
 
 	if (!sourceAlphaOnly)
 	{
+#ifdef VEGA_USE_ASM
+		// blur() needs room for four lanes.
+		cbuf = OP_NEWA(UINT32, wrap ? cbuf_size : cbuf_size * 4);
+#else
 		cbuf = OP_NEWA(UINT32, cbuf_size);
+#endif // VEGA_USE_ASM
 		if (!cbuf)
 			return OpStatus::ERR_NO_MEMORY;
 
@@ -56,6 +56,27 @@ public:
 	 * The kernel size has to be 2*kernel_width+1 and the kernel must be large enough to hold that many values.
 	 */
 	static void initKernel(VEGA_FIX stdDev, VEGA_FIX* kernel, int kernel_width, int kernel_size);
+
+#ifdef VEGA_USE_ASM
+	/**
+	 * Box blur four lines at once, the C++ version of
+	 * VEGADispatchTable::BoxBlur4_8888.
+	 *
+	 * Line n starts at dstp + n * dstlanestride (srcp + n * srclanestride)
+	 * and steps dststride (srcstride) pixels per pixel, so four adjacent
+	 * columns have a lane stride of one and four rows a lane stride of
+	 * the buffer stride. The source may be the same as the destination.
+	 *
+	 * The ring buffer, cbuf, must hold 4 * (cbuf_mask + 1) pixels and
+	 * cbuf_mask + 1 must be a power of two larger than the kernel
+	 * (1 + left_count + right_count).
+	 */
+	static void boxBlur4(UINT32* dstp, unsigned int dststride, unsigned int dstlanestride,
+						 const UINT32* srcp, unsigned int srcstride, unsigned int srclanestride,
+						 unsigned int count,
+						 unsigned int left_count, unsigned int right_count,
+						 UINT32* cbuf, unsigned int cbuf_mask);
+#endif // VEGA_USE_ASM
 private:
 	virtual OP_STATUS apply(const VEGASWBuffer& dest, const VEGAFilterRegion& region);
 
@@ -85,6 +106,13 @@ private:
 					VEGAPixelPtr srcp, unsigned int srcstride,
 					unsigned int count,
 					unsigned int left_count, unsigned int right_count);
+#ifdef VEGA_USE_ASM
+	/** Run the three box blur passes of a large stddev blur over four
+	 * lines, using VEGADispatchTable::BoxBlur4_8888. */
+	void boxBlur4Passes(UINT32* dstp, unsigned int dststride, unsigned int dstlanestride,
+						const UINT32* srcp, unsigned int srcstride, unsigned int srclanestride,
+						unsigned int count, unsigned int half_k, bool odd);
+#endif // VEGA_USE_ASM
 	void blur(const VEGASWBuffer& dstbuf, const VEGASWBuffer& srcbuf);
 
 	void realGaussRow_A(VEGAPixelPtr dstp, unsigned int dststride,
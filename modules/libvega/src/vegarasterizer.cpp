@@ -307,7 +307,7 @@ void VEGAIntervalList::add(unsigned start, unsigned end)
 }
 
 /* Helper function to find the x point for a given y value and a line. */
-static inline VEGA_FIX findXPointOnLine(VEGA_FIX *line, VEGA_FIX fix_y, VEGA_FIX slope)
+static inline VEGA_FIX findXPointOnLine(const VEGA_FIX *line, VEGA_FIX fix_y, VEGA_FIX slope)
 {
 	if (slope >= VEGA_INFINITY)
 		return VEGA_FIXDIV2(line[VEGALINE_STARTX]+line[VEGALINE_ENDX]);
@@ -315,21 +315,38 @@ static inline VEGA_FIX findXPointOnLine(VEGA_FIX *line, VEGA_FIX fix_y, VEGA_FIX
 	return line[VEGALINE_STARTX] + VEGA_FIXMUL(fix_y-line[VEGALINE_STARTY],slope);
 }
 
-OP_STATUS VEGARasterizer::rasterize(const VEGAPath* path)
+OP_STATUS VEGARasterizer::reserveLines(unsigned int numLines)
 {
-	// The number of lines might change when closing
-	unsigned int numLines = path->getNumLines();
-
-	maskbuffer_ptr = maskbuffer;
-
 	if (allocSortedLines < numLines || !sortedlines)
 	{
 		OP_DELETEA(sortedlines);
 		sortedlines = OP_NEWA(VEGASortedLineList, numLines);
 		if (!sortedlines)
+		{
+			allocSortedLines = 0;
 			return OpStatus::ERR_NO_MEMORY;
+		}
 		allocSortedLines = numLines;
 	}
+	return OpStatus::OK;
+}
+
+OP_STATUS VEGARasterizer::rasterize(const VEGAPath* path)
+{
+	// The number of lines might change when closing
+	return rasterizeLines(path, NULL, path->getNumLines());
+}
+
+OP_STATUS VEGARasterizer::rasterize(const VEGA_FIX* lines, unsigned int numLines)
+{
+	return rasterizeLines(NULL, lines, numLines);
+}
+
+OP_STATUS VEGARasterizer::rasterizeLines(const VEGAPath* path, const VEGA_FIX* lines, unsigned int numLines)
+{
+	maskbuffer_ptr = maskbuffer;
+
+	RETURN_IF_ERROR(reserveLines(numLines));
 
 	const int q_size = VegaSampleSize[quality];
 	const int q_size_mask = q_size - 1;
@@ -350,7 +367,7 @@ OP_STATUS VEGARasterizer::rasterize(const VEGAPath* path)
 	for (unsigned int cl = 0; cl < numLines; ++cl)
 	{
 		// Find all sub paths and at the same time find all top vertices
-		VEGA_FIX* lineData = path->getNonWarpLine(cl);
+		const VEGA_FIX* lineData = lines ? lines + cl*4 : path->getNonWarpLine(cl);
 		if (lineData && lineData[VEGALINE_STARTY] != lineData[VEGALINE_ENDY])
 		{
 			int sample = VEGA_FIXTOINT(lineData[VEGALINE_STARTY] * q_size);
@@ -58,6 +58,16 @@ public:
 
 	OP_STATUS rasterize(const VEGAPath* path);
 
+	/** Rasterize numLines lines, stored as start x, start y, end x and end
+	 * y after each other (see VEGALINE_STARTX etc.). Unlike the path
+	 * version, this only reads the lines, so several rasterizers can
+	 * share them. */
+	OP_STATUS rasterize(const VEGA_FIX* lines, unsigned int numLines);
+
+	/** Allocate what rasterize() needs for paths of up to numLines lines,
+	 * so that it won't allocate memory. */
+	OP_STATUS reserveLines(unsigned int numLines);
+
 	unsigned calculateArea(VEGA_FIX minx, VEGA_FIX miny, VEGA_FIX maxx, VEGA_FIX maxy);
 
 	void rasterRect(unsigned x, unsigned y, unsigned w, unsigned h);
@@ -73,6 +83,10 @@ private:
 		MIN_RASTER_SPAN_LENGTH	= 32	// The minimum length of an opaque span
 	};
 
+	/** Rasterize the lines of path, or if path is NULL, the lines in
+	 * lines. */
+	OP_STATUS rasterizeLines(const VEGAPath* path, const VEGA_FIX* lines, unsigned int numLines);
+
 	void emitMonotoneSpan(struct VEGASpanState& state);
 	void emitMaskSpan(struct VEGASpanState& state);
 	void addSpans(unsigned int line, const struct VEGAIntervalList& ilist);
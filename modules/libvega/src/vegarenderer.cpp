@@ -43,6 +43,9 @@
 #include "modules/libvega/src/vegabackend_hw3d.h"
 
 #include "modules/libvega/vega3ddevice.h"
+#ifdef VEGA_TILED_RASTERIZATION
+# include "modules/libvega/vegatileworkers.h"
+#endif // VEGA_TILED_RASTERIZATION
 #ifdef VEGA_2DDEVICE
 # include "modules/libvega/vega2ddevice.h"
 #endif // VEGA_2DDEVICE
@@ -75,6 +78,9 @@ LibvegaModule::LibvegaModule() :
 #ifdef VEGA_USE_ASM
     , dispatchTable(NULL)
 #endif // VEGA_USE_ASM
+#ifdef VEGA_TILED_RASTERIZATION
+	, tileWorkers(NULL)
+#endif // VEGA_TILED_RASTERIZATION
 {}
 
 void LibvegaModule::InitL(const OperaInitInfo &info)
@@ -82,6 +88,14 @@ void LibvegaModule::InitL(const OperaInitInfo &info)
 #ifdef VEGA_USE_ASM
 	dispatchTable = OP_NEW_L(VEGADispatchTable, ());
 #endif // VEGA_USE_ASM
+
+#ifdef VEGA_TILED_RASTERIZATION
+	OP_STATUS status = VEGATileWorkers::Create(&tileWorkers);
+	if (OpStatus::IsMemoryError(status))
+		LEAVE(status);
+	if (OpStatus::IsError(status))
+		tileWorkers = NULL;
+#endif // VEGA_TILED_RASTERIZATION
 }
 
 void LibvegaModule::Destroy()
@@ -114,6 +128,11 @@ void LibvegaModule::Destroy()
 #ifdef VEGA_USE_ASM
 	OP_DELETE(dispatchTable);
 #endif // VEGA_USE_ASM
+
+#ifdef VEGA_TILED_RASTERIZATION
+	OP_DELETE(tileWorkers);
+	tileWorkers = NULL;
+#endif // VEGA_TILED_RASTERIZATION
 }
 
 #ifdef VEGA_3DDEVICE
@@ -0,0 +1,261 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; c-file-style:"stroustrup" -*-
+**
+** Copyright (C) 1995-2012 Opera Software AS.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#if defined(VEGA_SUPPORT) && defined(VEGA_TILED_RASTERIZATION)
+#include "modules/libvega/src/vegatiledrasterizer.h"
+
+#include "modules/libvega/vegapath.h"
+#include "modules/libvega/src/vegabackend_sw.h"
+#include "modules/libvega/src/vegarasterizer.h"
+
+class VEGATiledRasterizer::Tile :
+	public VEGATileJob,
+	public VEGASpanConsumer
+{
+public:
+	Tile() : lines(NULL), numLines(0), buffer(NULL), ppixel(0), alphaBlend(false), status(OpStatus::OK) {}
+
+	OP_STATUS initialize(unsigned int w, unsigned int h, unsigned int q)
+	{
+		RETURN_IF_ERROR(rasterizer.initialize(w, h));
+		rasterizer.setConsumer(this);
+		rasterizer.setQuality(q);
+		return OpStatus::OK;
+	}
+
+	virtual void run()
+	{
+		minx = UINT_MAX;
+		miny = UINT_MAX;
+		maxx = 0;
+		maxy = 0;
+
+		status = rasterizer.rasterize(lines, numLines);
+	}
+
+	virtual void drawSpans(VEGASpanInfo* raster_spans, unsigned int span_count)
+	{
+		for (unsigned int span_num = 0; span_num < span_count; ++span_num)
+		{
+			const VEGASpanInfo& span = raster_spans[span_num];
+			if (span.length == 0)
+				continue;
+
+			if (span.pos < minx)
+				minx = span.pos;
+			if (span.pos+span.length-1 > maxx)
+				maxx = span.pos+span.length-1;
+			if (span.scanline < miny)
+				miny = span.scanline;
+			if (span.scanline > maxy)
+				maxy = span.scanline;
+
+			VEGABackend_SW::drawSolidSpan(buffer, span, ppixel, alphaBlend);
+		}
+	}
+
+	VEGARasterizer rasterizer;
+
+	const VEGA_FIX* lines;
+	unsigned int numLines;
+	VEGASWBuffer* buffer;
+	UINT32 ppixel;
+	bool alphaBlend;
+
+	unsigned int minx, miny, maxx, maxy;
+	OP_STATUS status;
+};
+
+VEGATiledRasterizer::VEGATiledRasterizer() :
+	tiles(NULL), jobs(NULL), numTiles(0),
+	lines(NULL), numLines(0), allocLines(0),
+	width(0), height(0), quality(0)
+{}
+
+VEGATiledRasterizer::~VEGATiledRasterizer()
+{
+	freeTiles();
+	OP_DELETEA(lines);
+}
+
+void VEGATiledRasterizer::initialize(unsigned int w, unsigned int h)
+{
+	if (w != width || h != height)
+		freeTiles();
+
+	width = w;
+	height = h;
+}
+
+void VEGATiledRasterizer::freeTiles()
+{
+	for (unsigned int i = 0; i < numTiles; ++i)
+		OP_DELETE(tiles[i]);
+	OP_DELETEA(tiles);
+	OP_DELETEA(jobs);
+
+	tiles = NULL;
+	jobs = NULL;
+	numTiles = 0;
+}
+
+void VEGATiledRasterizer::setQuality(unsigned int q)
+{
+	quality = q;
+	for (unsigned int i = 0; i < numTiles; ++i)
+		tiles[i]->rasterizer.setQuality(q);
+}
+
+/* static */
+unsigned int VEGATiledRasterizer::tileCount(VEGATileWorkers* workers, int sy, int ey)
+{
+	if (!workers || ey <= sy)
+		return 0;
+
+	unsigned int count = (unsigned int)(ey - sy) / VEGA_TILED_RASTERIZATION_MIN_TILE_HEIGHT;
+	unsigned int worker_count = workers->getWorkerCount();
+	if (count > worker_count)
+		count = worker_count;
+	if (count > MAX_TILES)
+		count = MAX_TILES;
+
+	return count;
+}
+
+OP_STATUS VEGATiledRasterizer::ensureTiles(unsigned int count)
+{
+	if (count <= numTiles)
+		return OpStatus::OK;
+
+	VEGATileJob** new_jobs = OP_NEWA(VEGATileJob*, count);
+	RETURN_OOM_IF_NULL(new_jobs);
+	OP_DELETEA(jobs);
+	jobs = new_jobs;
+
+	Tile** new_tiles = OP_NEWA(Tile*, count);
+	RETURN_OOM_IF_NULL(new_tiles);
+
+	for (unsigned int i = 0; i < numTiles; ++i)
+		new_tiles[i] = tiles[i];
+
+	OP_DELETEA(tiles);
+	tiles = new_tiles;
+
+	for (; numTiles < count; ++numTiles)
+	{
+		Tile* tile = OP_NEW(Tile, ());
+		RETURN_OOM_IF_NULL(tile);
+
+		OP_STATUS status = tile->initialize(width, height, quality);
+		if (OpStatus::IsError(status))
+		{
+			OP_DELETE(tile);
+			return status;
+		}
+
+		tiles[numTiles] = tile;
+	}
+
+	return OpStatus::OK;
+}
+
+OP_STATUS VEGATiledRasterizer::flattenPath(const VEGAPath* path)
+{
+	unsigned int pathLines = path->getNumLines();
+	if (allocLines < pathLines)
+	{
+		VEGA_FIX* new_lines = OP_NEWA(VEGA_FIX, pathLines*4);
+		RETURN_OOM_IF_NULL(new_lines);
+
+		OP_DELETEA(lines);
+		lines = new_lines;
+		allocLines = pathLines;
+	}
+
+	numLines = 0;
+	for (unsigned int cl = 0; cl < pathLines; ++cl)
+	{
+		const VEGA_FIX* lineData = path->getNonWarpLine(cl);
+		if (lineData)
+		{
+			VEGA_FIX* line = lines + numLines*4;
+			line[VEGALINE_STARTX] = lineData[VEGALINE_STARTX];
+			line[VEGALINE_STARTY] = lineData[VEGALINE_STARTY];
+			line[VEGALINE_ENDX] = lineData[VEGALINE_ENDX];
+			line[VEGALINE_ENDY] = lineData[VEGALINE_ENDY];
+			++numLines;
+		}
+	}
+
+	return OpStatus::OK;
+}
+
+OP_STATUS VEGATiledRasterizer::rasterize(const VEGAPath* path, VEGATileWorkers* workers, unsigned int tile_count,
+										 VEGASWBuffer* buffer, int sx, int sy, int ex, int ey, bool xorFill,
+										 UINT32 ppixel, bool alphaBlend,
+										 unsigned int& minx, unsigned int& miny, unsigned int& maxx, unsigned int& maxy)
+{
+	OP_ASSERT(tile_count > 0 && tile_count <= MAX_TILES && ey > sy);
+
+	RETURN_IF_ERROR(ensureTiles(tile_count));
+
+	RETURN_IF_ERROR(flattenPath(path));
+
+	// Everything that may allocate memory is done before the tiles run.
+	unsigned int scanlines = (unsigned int)(ey - sy);
+	int tile_sy = sy;
+	for (unsigned int i = 0; i < tile_count; ++i)
+	{
+		int tile_ey = sy + (int)(scanlines * (i + 1) / tile_count);
+
+		Tile* tile = tiles[i];
+		RETURN_IF_ERROR(tile->rasterizer.reserveLines(numLines));
+
+		tile->rasterizer.setXORFill(xorFill);
+		tile->rasterizer.setRegion(sx, tile_sy, ex, tile_ey);
+		tile->lines = lines;
+		tile->numLines = numLines;
+		tile->buffer = buffer;
+		tile->ppixel = ppixel;
+		tile->alphaBlend = alphaBlend;
+
+		jobs[i] = tile;
+		tile_sy = tile_ey;
+	}
+
+	workers->run(jobs, tile_count);
+
+	OP_STATUS status = OpStatus::OK;
+	for (unsigned int i = 0; i < tile_count; ++i)
+	{
+		Tile* tile = tiles[i];
+		tile->lines = NULL;
+		tile->buffer = NULL;
+
+		if (OpStatus::IsError(tile->status))
+			status = tile->status;
+
+		if (tile->maxx < tile->minx || tile->maxy < tile->miny)
+			continue;
+
+		if (tile->minx < minx)
+			minx = tile->minx;
+		if (tile->maxx > maxx)
+			maxx = tile->maxx;
+		if (tile->miny < miny)
+			miny = tile->miny;
+		if (tile->maxy > maxy)
+			maxy = tile->maxy;
+	}
+
+	return status;
+}
+
+#endif // VEGA_SUPPORT && VEGA_TILED_RASTERIZATION
@@ -0,0 +1,89 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; c-file-style:"stroustrup" -*-
+**
+** Copyright (C) 1995-2012 Opera Software AS.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#ifndef VEGATILEDRASTERIZER_H
+#define VEGATILEDRASTERIZER_H
+
+#if defined(VEGA_SUPPORT) && defined(VEGA_TILED_RASTERIZATION)
+#include "modules/libvega/vegafixpoint.h"
+#include "modules/libvega/vegatileworkers.h"
+
+class VEGAPath;
+class VEGASWBuffer;
+
+/** Rasterizes solid color fills of large paths in horizontal tiles,
+ * with one VEGARasterizer per tile, and hands the tiles to VEGATileWorkers
+ * to be rasterized concurrently.
+ *
+ * Each tile covers its own range of scanlines of the destination, and
+ * fills are done one at a time, so every pixel gets its spans composited
+ * in the same order as when rasterizing the whole path at once. */
+class VEGATiledRasterizer
+{
+public:
+	VEGATiledRasterizer();
+	~VEGATiledRasterizer();
+
+	/** Set the size of the largest area to rasterize. The per tile
+	 * rasterizers are allocated on first use, and freed when the size
+	 * changes, since their buffers depend on it. */
+	void initialize(unsigned int w, unsigned int h);
+	void setQuality(unsigned int q);
+
+	/** @returns the number of tiles to split a fill of the scanlines from
+	 * sy up to, but not including, ey into. Less than two means that the
+	 * fill should not be tiled. */
+	static unsigned int tileCount(VEGATileWorkers* workers, int sy, int ey);
+
+	/** Rasterize a path with a solid color.
+	 * @param path the path to fill. Must be closed.
+	 * @param workers the workers to rasterize the tiles on.
+	 * @param tile_count the number of tiles, as returned by tileCount().
+	 * @param buffer the destination.
+	 * @param sx, sy, ex, ey the clip rectangle, end exclusive.
+	 * @param xorFill true to use the even-odd fill rule.
+	 * @param ppixel the color, as a packed pixel.
+	 * @param alphaBlend true to blend the color onto the destination.
+	 * @param minx, miny, maxx, maxy grown to include the pixels drawn.
+	 * @returns OpStatus::OK or OpStatus::ERR_NO_MEMORY. */
+	OP_STATUS rasterize(const VEGAPath* path, VEGATileWorkers* workers, unsigned int tile_count,
+						VEGASWBuffer* buffer, int sx, int sy, int ex, int ey, bool xorFill,
+						UINT32 ppixel, bool alphaBlend,
+						unsigned int& minx, unsigned int& miny, unsigned int& maxx, unsigned int& maxy);
+
+private:
+	enum
+	{
+		MAX_TILES = 16	// The maximum number of tiles per fill
+	};
+
+	class Tile;
+
+	OP_STATUS ensureTiles(unsigned int count);
+	void freeTiles();
+
+	/** Copy the lines of path that are not warps into lines, which the
+	 * tiles then share. The tiles can not read the path itself, since
+	 * VEGAPath::getNonWarpLine() writes to it. */
+	OP_STATUS flattenPath(const VEGAPath* path);
+
+	Tile** tiles;
+	VEGATileJob** jobs;	// The same objects as tiles, passed to VEGATileWorkers::run
+	unsigned int numTiles;
+
+	VEGA_FIX* lines;	// 4 values per line, see VEGALINE_STARTX etc.
+	unsigned int numLines;
+	unsigned int allocLines;
+
+	unsigned int width;
+	unsigned int height;
+	unsigned int quality;
+};
+
+#endif // VEGA_SUPPORT && VEGA_TILED_RASTERIZATION
+#endif // !VEGATILEDRASTERIZER_H
@@ -17,6 +17,7 @@ extern "C" {
 	void VEGAInitXmmConstants(void);
 
 	void Store_SSE2(UINT32* dst, UINT32 rgba, unsigned len);
+	void BoxBlur4_SSE2(UINT32* dst, unsigned dststride, unsigned dstlanestride, const UINT32* src, unsigned srcstride, unsigned srclanestride, unsigned count, unsigned left_count, unsigned right_count, UINT32* cbuf, unsigned cbuf_mask);
 
 	void CompOver_SSSE3(UINT32* dst, const UINT32* src, unsigned len);
 	void CompConstOver_SSSE3(UINT32* dst, UINT32 src, unsigned len);
@@ -78,6 +79,8 @@ void VEGADispatchTable::PopulateHooks()
 		Sampler_LerpXY_Opaque_8888 = Sampler_LerpXY_Opaque_SSE2;
 		Sampler_LerpXY_CompOver_8888 = Sampler_LerpXY_CompOver_SSE2;
 		Sampler_LerpXY_CompOverMask_8888 = Sampler_LerpXY_CompOverMask_SSE2;
+
+		BoxBlur4_8888 = BoxBlur4_SSE2;
 	}
 
 	if (g_op_system_info->GetCPUFeatures() & OpSystemInfo::CPU_FEATURES_IA32_SSSE3
@@ -0,0 +1,164 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#if defined(VEGA_USE_ASM) && defined(ARCHITECTURE_IA32)
+
+#include "modules/libvega/src/vegapixelformat.h"
+#include "modules/libvega/src/x86/vegacommon_x86.h"
+
+// Load one pixel from each of the four lanes. Transparent pixels are
+// cleared since they should not contribute to the sums, which matches
+// what the C++ version does.
+static op_force_inline __m128i LoadLanes(const UINT32* src, unsigned lanestride, __m128i alpha_mask, __m128i zero)
+{
+	__m128i pix;
+	if (lanestride == 1)
+		pix = _mm_loadu_si128((const __m128i*)src);
+	else
+	{
+		__m128i p01 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(src[0]), _mm_cvtsi32_si128(src[lanestride]));
+		__m128i p23 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(src[2 * lanestride]), _mm_cvtsi32_si128(src[3 * lanestride]));
+		pix = _mm_unpacklo_epi64(p01, p23);
+	}
+
+	__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(pix, alpha_mask), zero);
+	return _mm_andnot_si128(transparent, pix);
+}
+
+// Store one pixel to each of the four lanes.
+static op_force_inline void StoreLanes(UINT32* dst, unsigned lanestride, __m128i pix)
+{
+	if (lanestride == 1)
+		_mm_storeu_si128((__m128i*)dst, pix);
+	else
+	{
+		dst[0] = _mm_cvtsi128_si32(pix);
+		dst[lanestride] = _mm_cvtsi128_si32(_mm_srli_si128(pix, 4));
+		dst[2 * lanestride] = _mm_cvtsi128_si32(_mm_srli_si128(pix, 8));
+		dst[3 * lanestride] = _mm_cvtsi128_si32(_mm_srli_si128(pix, 12));
+	}
+}
+
+// Expand the pixels to dword components and add them to (or subtract
+// them from) the sums, one register of sums per lane.
+static op_force_inline void AddPixels(__m128i* acc, __m128i pix, __m128i zero)
+{
+	__m128i lo = _mm_unpacklo_epi8(pix, zero);
+	__m128i hi = _mm_unpackhi_epi8(pix, zero);
+	acc[0] = _mm_add_epi32(acc[0], _mm_unpacklo_epi16(lo, zero));
+	acc[1] = _mm_add_epi32(acc[1], _mm_unpackhi_epi16(lo, zero));
+	acc[2] = _mm_add_epi32(acc[2], _mm_unpacklo_epi16(hi, zero));
+	acc[3] = _mm_add_epi32(acc[3], _mm_unpackhi_epi16(hi, zero));
+}
+
+static op_force_inline void SubPixels(__m128i* acc, __m128i pix, __m128i zero)
+{
+	__m128i lo = _mm_unpacklo_epi8(pix, zero);
+	__m128i hi = _mm_unpackhi_epi8(pix, zero);
+	acc[0] = _mm_sub_epi32(acc[0], _mm_unpacklo_epi16(lo, zero));
+	acc[1] = _mm_sub_epi32(acc[1], _mm_unpackhi_epi16(lo, zero));
+	acc[2] = _mm_sub_epi32(acc[2], _mm_unpacklo_epi16(hi, zero));
+	acc[3] = _mm_sub_epi32(acc[3], _mm_unpackhi_epi16(hi, zero));
+}
+
+// (acc * div + (1 << 23)) >> 24 for each dword component. There is no
+// dword multiply in SSE2, so the even and odd components are multiplied
+// separately into quadwords. The product is always less than 2^32.
+static op_force_inline __m128i DivideSums(__m128i acc, __m128i div, __m128i round)
+{
+	__m128i even = _mm_srli_epi64(_mm_add_epi64(_mm_mul_epu32(acc, div), round), 24);
+	__m128i odd = _mm_srli_epi64(_mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(acc, 32), div), round), 24);
+	return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+// Divide the sums and pack them to one pixel per lane.
+static op_force_inline __m128i PackSums(const __m128i* acc, __m128i div, __m128i round)
+{
+	__m128i lo = _mm_packs_epi32(DivideSums(acc[0], div, round), DivideSums(acc[1], div, round));
+	__m128i hi = _mm_packs_epi32(DivideSums(acc[2], div, round), DivideSums(acc[3], div, round));
+	__m128i pix = _mm_packus_epi16(lo, hi);
+
+	// Clamp the color components to alpha, which is in the top byte
+	// in both 8888 formats. This also clears pixels where alpha is zero.
+	__m128i alpha = _mm_srli_epi32(pix, 24);
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+	return _mm_min_epu8(pix, alpha);
+}
+
+extern "C" void BoxBlur4_SSE2(UINT32* dst, unsigned dststride, unsigned dstlanestride,
+							  const UINT32* src, unsigned srcstride, unsigned srclanestride,
+							  unsigned count, unsigned left_count, unsigned right_count,
+							  UINT32* cbuf, unsigned cbuf_mask)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha_mask = _mm_set1_epi32(VEGA_PACK_ARGB(255, 0, 0, 0));
+	const __m128i round = _mm_set_epi32(0, 1 << 23, 0, 1 << 23);
+
+	unsigned kernel_len = 1 + left_count + right_count;
+	const __m128i div = _mm_set1_epi32((1 << 24) / kernel_len);
+
+	// The ring buffer holds the four lanes of each position next to
+	// each other.
+	__m128i* ring = (__m128i*)cbuf;
+	unsigned rd_pos = 0;
+	unsigned wr_pos = 0;
+
+	__m128i acc[4] = { zero, zero, zero, zero };
+
+	const UINT32* src_end = src + count * srcstride;
+
+	// Prefill with zeros before left edge
+	for (unsigned i = 0; i < left_count; ++i)
+		_mm_storeu_si128(ring + wr_pos++, zero);
+
+	// Get source pixels for a half kernel
+	unsigned w = MIN(count, right_count);
+	while (w--)
+	{
+		__m128i pix = LoadLanes(src, srclanestride, alpha_mask, zero);
+		_mm_storeu_si128(ring + wr_pos++, pix);
+		AddPixels(acc, pix, zero);
+
+		src += srcstride;
+	}
+
+	// Process remaining source pixels
+	while (src < src_end)
+	{
+		__m128i pix = LoadLanes(src, srclanestride, alpha_mask, zero);
+		_mm_storeu_si128(ring + wr_pos++, pix);
+		wr_pos &= cbuf_mask;
+		AddPixels(acc, pix, zero);
+		src += srcstride;
+
+		StoreLanes(dst, dstlanestride, PackSums(acc, div, round));
+		dst += dststride;
+
+		count--;
+
+		SubPixels(acc, _mm_loadu_si128(ring + rd_pos++), zero);
+		rd_pos &= cbuf_mask;
+	}
+
+	while (count)
+	{
+		// Right edge consists of zeros => no need to accumulate
+		StoreLanes(dst, dstlanestride, PackSums(acc, div, round));
+		dst += dststride;
+
+		count--;
+
+		SubPixels(acc, _mm_loadu_si128(ring + rd_pos++), zero);
+		rd_pos &= cbuf_mask;
+	}
+}
+
+#endif // defined(VEGA_USE_ASM) && defined(ARCHITECTURE_IA32)
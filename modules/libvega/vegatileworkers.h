@@ -0,0 +1,53 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; c-file-style:"stroustrup" -*-
+**
+** Copyright (C) 1995-2012 Opera Software AS.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#ifndef VEGATILEWORKERS_H
+#define VEGATILEWORKERS_H
+
+#if defined(VEGA_SUPPORT) && defined(VEGA_TILED_RASTERIZATION)
+
+/** A unit of work handed to VEGATileWorkers, typically the rasterization
+ * of one tile of a path. The jobs passed to the same call to
+ * VEGATileWorkers::run never write to the same memory, do not allocate
+ * memory and do not use any core state outside of libvega. */
+class VEGATileJob
+{
+public:
+	virtual ~VEGATileJob() {}
+
+	/** Do the work. May be called on any thread. */
+	virtual void run() = 0;
+};
+
+/** A porting interface for running tile jobs of the software backend
+ * concurrently, typically on a pool of worker threads owned by the
+ * platform. The software backend only splits a fill into tiles when
+ * there is more than one worker. */
+class VEGATileWorkers
+{
+public:
+	/** Create the worker pool. Called once when libvega is initialized.
+	 * @param workers set to the new worker pool.
+	 * @returns OpStatus::OK on success, OpStatus::ERR_NO_MEMORY on OOM.
+	 * Any other error disables tiled rasterization. */
+	static OP_STATUS Create(VEGATileWorkers** workers);
+
+	virtual ~VEGATileWorkers() {}
+
+	/** @returns the number of jobs that may run at the same time. */
+	virtual unsigned int getWorkerCount() = 0;
+
+	/** Run each of the jobs once and return when all of them have
+	 * finished. The calling thread may run some of the jobs itself.
+	 * @param jobs the jobs to run.
+	 * @param count the number of jobs. */
+	virtual void run(VEGATileJob** jobs, unsigned int count) = 0;
+};
+
+#endif // VEGA_SUPPORT && VEGA_TILED_RASTERIZATION
+#endif // !VEGATILEWORKERS_H
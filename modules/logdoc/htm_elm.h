@@ -350,8 +350,12 @@ private:
 			/** TRUE if this element has a class attribute */
 			unsigned int
 					has_class:1;
+			/** TRUE if MarkDirty() deleted the min/max widths of this reflow
+				root, but kept those of its ancestors */
+			unsigned int
+					minmax_kept_above:1;
 
-		} packed1; // 31 bits
+		} packed1; // 32 bits
 		unsigned int
 					packed1_init;
 	};
@@ -1990,6 +1994,7 @@ public:
 		int was_dirty = packed2.dirty;
 		packed2.needs_update = FALSE;
 		packed2.dirty = ELM_NOT_DIRTY;
+		packed1.minmax_kept_above = 0;
 		return was_dirty;
 	}
 
@@ -2951,6 +2956,18 @@ public:
 	 *	@param[IN] user_defined Set to TRUE if the style is user defined.
 	 */
 	OP_STATUS		LoadStyle(const DocumentContext& context, BOOL user_defined);
+
+	/**
+	 * Stores a parsed stylesheet on the element and adds it to the
+	 * document's CSSCollection. Called by LoadStyle(), and when a
+	 * stylesheet parsed in slices is done.
+	 *
+	 * @param css The parsed stylesheet. Deleted if not stored.
+	 * @param store_css FALSE if the stylesheet should just be deleted.
+	 * @param stat The status of parsing the stylesheet.
+	 * @return stat, or the status of the AfterCSS user javascript event.
+	 */
+	OP_STATUS		AddParsedCSS(const DocumentContext& context, CSS* css, BOOL store_css, OP_STATUS stat);
 	/** Removes child style elements imported by a stylesheet */
 	void			RemoveImportedStyleElements(const DocumentContext &context);
 
@@ -567,6 +567,13 @@ void HEListElm::Display(FramesDocument* doc, const AffinePos& pos, long width, l
 		{
 			if (background)
 				GetElm()->SetHasBgImage(TRUE);
+#ifdef IMG_SCALED_DECODING
+			// An image shown smaller than its size may be decoded to a
+			// reduced size. Background images are tiled, so they are not.
+			else if (!pos.IsTransform())
+				if (VisualDevice* vis_dev = doc->GetVisualDevice())
+					img.SetDecodeSizeHint(vis_dev->ScaleToScreen(width), vis_dev->ScaleToScreen(height));
+#endif // IMG_SCALED_DECODING
 
 			OP_STATUS status = img.IncVisible(this);
 			if (OpStatus::IsError(status))
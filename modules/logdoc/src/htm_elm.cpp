@@ -6665,7 +6665,12 @@ void HTML_Element::RemoveCSS(const DocumentContext& context)
 	RemoveImportedStyleElements(context);
 
 	if (context.hld_profile)
+	{
+#ifdef CSS_SLICED_PARSING
+		context.hld_profile->GetCSSCollection()->CancelSlicedParsing(this);
+#endif // CSS_SLICED_PARSING
 		context.hld_profile->GetCSSCollection()->RemoveCollectionElement(this);
+	}
 
 	RemoveSpecialAttribute(ATTR_CSS, SpecialNs::NS_LOGDOC);
 }
@@ -6777,32 +6782,21 @@ OP_STATUS HTML_Element::LoadStyle(const DocumentContext& context, BOOL user_defi
 
 			if (!suspicious_origin)
 			{
-				stat = css->Load(context.hld_profile, src_head, line_no_start, line_character_start);
+#ifdef CSS_SLICED_PARSING
+				/* Large external stylesheets are parsed from the message
+				   loop, and added by AddParsedCSS() when done. */
+				if (store_css && context.hld_profile && IsLinkElement() && !IsCssImport() &&
+					OpStatus::IsSuccess(context.hld_profile->GetCSSCollection()->StartSlicedParsing(this, css, src_head, line_no_start)))
+					return OpStatus::OK;
+#endif // CSS_SLICED_PARSING
 
-				if (OpStatus::IsMemoryError(stat))
-				{
-					RemoveImportedStyleElements(context);
-					store_css = FALSE;
-				}
+				stat = css->Load(context.hld_profile, src_head, line_no_start, line_character_start);
 			}
 			else
 				store_css = FALSE;
 		}
 
-		if (store_css && SetSpecialAttr(ATTR_CSS, ITEM_TYPE_CSS, css, TRUE, SpecialNs::NS_LOGDOC) >= 0)
-		{
-			if (context.hld_profile)
-			{
-				context.hld_profile->AddCSS(css);
-#ifdef USER_JAVASCRIPT
-				if (IsLinkElement())
-					if (DOM_Environment *environment = context.frames_doc->GetDOMEnvironment())
-						stat = environment->HandleCSSFinished(this, context.hld_profile->GetESLoadManager()->GetInterruptedThread(this));
-#endif // USER_JAVASCRIPT
-			}
-		}
-		else
-			OP_DELETE(css);
+		stat = AddParsedCSS(context, css, store_css, stat);
 
 		// For inline style elements, discard the DataSrc we created in the beginning of this method.
 		if (IsStyleElement())
@@ -6815,6 +6809,32 @@ OP_STATUS HTML_Element::LoadStyle(const DocumentContext& context, BOOL user_defi
 	return OpStatus::OK;
 }
 
+OP_STATUS HTML_Element::AddParsedCSS(const DocumentContext& context, CSS* css, BOOL store_css, OP_STATUS stat)
+{
+	if (OpStatus::IsMemoryError(stat))
+	{
+		RemoveImportedStyleElements(context);
+		store_css = FALSE;
+	}
+
+	if (store_css && SetSpecialAttr(ATTR_CSS, ITEM_TYPE_CSS, css, TRUE, SpecialNs::NS_LOGDOC) >= 0)
+	{
+		if (context.hld_profile)
+		{
+			context.hld_profile->AddCSS(css);
+#ifdef USER_JAVASCRIPT
+			if (IsLinkElement())
+				if (DOM_Environment *environment = context.frames_doc->GetDOMEnvironment())
+					stat = environment->HandleCSSFinished(this, context.hld_profile->GetESLoadManager()->GetInterruptedThread(this));
+#endif // USER_JAVASCRIPT
+		}
+	}
+	else
+		OP_DELETE(css);
+
+	return stat;
+}
+
 void HTML_Element::RemoveImportedStyleElements(const DocumentContext& context)
 {
 	HTML_Element* child = FirstChild();
@@ -7181,6 +7201,11 @@ void HTML_Element::CleanLocal(const DocumentContext &context)
 
 		if (context.hld_profile)
 		{
+#ifdef CSS_SLICED_PARSING
+			if (IsLinkElement())
+				context.hld_profile->GetCSSCollection()->CancelSlicedParsing(this);
+#endif // CSS_SLICED_PARSING
+
 			if ((IsStyleElement() || IsLinkElement()) && GetCSS())
 				RemoveCSS(context);
 #ifdef SVG_SUPPORT
@@ -13017,6 +13042,12 @@ OP_STATUS HTML_Element::BeforeAttributeChange(const DocumentContext &context, ES
 
 	BOOL name_or_id_changed = FALSE;
 
+#ifdef CSS_INVALIDATION_SETS
+	// Forget the previous change, also if this one fails before it is recorded.
+	if (context.hld_profile)
+		context.hld_profile->GetCSSCollection()->EndAttributeChange();
+#endif // CSS_INVALIDATION_SETS
+
 	if (g_ns_manager->GetNsTypeAt(ResolveNsIdx(ns_idx)) == NS_HTML)
 	{
 		if (!is_same_value)
@@ -13082,6 +13113,13 @@ OP_STATUS HTML_Element::BeforeAttributeChange(const DocumentContext &context, ES
 				// removed.
 				RemoveCSS(context);
 			}
+
+#ifdef CSS_SLICED_PARSING
+			// A stylesheet still being parsed for the old href or rel has no
+			// CSS yet, but must not be added when the parsing finishes.
+			if ((attr == ATTR_HREF || attr == ATTR_REL) && context.hld_profile && IsMatchingType(HE_LINK, NS_HTML))
+				context.hld_profile->GetCSSCollection()->CancelSlicedParsing(this);
+#endif // CSS_SLICED_PARSING
 		}
 
 		if (attr == ATTR_SRC)
@@ -13147,9 +13185,14 @@ OP_STATUS HTML_Element::BeforeAttributeChange(const DocumentContext &context, ES
 		name_or_id_changed = TRUE;
 
 	if (name_or_id_changed && logdoc)
-		return logdoc->RemoveNamedElement(this, FALSE);
-	else
-		return OpStatus::OK;
+		RETURN_IF_ERROR(logdoc->RemoveNamedElement(this, FALSE));
+
+#ifdef CSS_INVALIDATION_SETS
+	if (context.hld_profile && !is_same_value)
+		context.hld_profile->GetCSSCollection()->BeginAttributeChange(this, attr, g_ns_manager->GetNsTypeAt(ResolveNsIdx(ns_idx)));
+#endif // CSS_INVALIDATION_SETS
+
+	return OpStatus::OK;
 }
 
 OP_STATUS HTML_Element::AfterAttributeChange(const DocumentContext &context, ES_Thread *thread, int attr_idx, short attr, int ns_idx, BOOL is_same_value)
@@ -13160,6 +13203,11 @@ OP_STATUS HTML_Element::AfterAttributeChange(const DocumentContext &context, ES_
 
 	NS_Type ns = g_ns_manager->GetNsTypeAt(ResolveNsIdx(ns_idx));
 
+#ifdef CSS_INVALIDATION_SETS
+	if (context.hld_profile)
+		context.hld_profile->GetCSSCollection()->EndAttributeChange();
+#endif // CSS_INVALIDATION_SETS
+
 	HTML_Element *root = logdoc ? logdoc->GetRoot() : NULL;
 	BOOL is_in_document = root && root->IsAncestorOf(this);
 
@@ -17433,8 +17481,13 @@ void HTML_Element::MarkDirty(FramesDocument* doc, BOOL delete_minmax_widths, BOO
 		}
 #endif // SVG_SUPPORT
 
+		/* If the min/max widths of a reflow root were deleted for a change
+		   in its content, those of its ancestors were kept. A change of the
+		   reflow root itself may change its size, so go on deleting. */
+
 		if (!(elm->packed2.dirty & ELM_DIRTY) ||
-			(delete_minmax_widths && !(elm->packed2.dirty & ELM_MINMAX_DELETED)))
+			(delete_minmax_widths && !(elm->packed2.dirty & ELM_MINMAX_DELETED)) ||
+			(delete_minmax_widths && elm == this && elm->packed1.minmax_kept_above))
 		{
 			elm->packed2.dirty |= ELM_DIRTY;
 
@@ -17444,6 +17497,16 @@ void HTML_Element::MarkDirty(FramesDocument* doc, BOOL delete_minmax_widths, BOO
 					elm->layout_box->ClearMinMaxWidth();
 
 				elm->packed2.dirty |= ELM_MINMAX_DELETED;
+				elm->packed1.minmax_kept_above = 0;
+
+				if (elm != this && elm->layout_box && elm->layout_box->IsReflowRoot())
+				{
+					/* The size of a reflow root doesn't depend on its content, so
+					   the min/max widths of its ancestors are still valid. */
+
+					elm->packed1.minmax_kept_above = 1;
+					delete_minmax_widths = FALSE;
+				}
 			}
 
 			HTML_Element* parent = elm->Parent();
@@ -912,6 +912,12 @@ GetFontInt(MDE_FONT* font, MDF_FontEngine* engine)
 
 #ifdef MDF_FONT_ADVANCE_CACHE
 	font->m_advance_cache = 0;
+#endif // MDF_FONT_ADVANCE_CACHE
+#ifdef MDF_SHAPED_RUN_CACHE
+	font->m_shaped_run_cache = 0;
+#endif // MDF_SHAPED_RUN_CACHE
+
+#ifdef MDF_FONT_ADVANCE_CACHE
 	MDF_AdvanceCache* advance_cache;
 	// possibly, size of advance cache should be made to vary
 	// depending on script likely to be used, since eg CJK text
@@ -924,6 +930,16 @@ GetFontInt(MDE_FONT* font, MDF_FontEngine* engine)
 	font->m_advance_cache = advance_cache;
 #endif // MDF_FONT_ADVANCE_CACHE
 
+#ifdef MDF_SHAPED_RUN_CACHE
+	MDF_ShapedRunCache* shaped_run_cache;
+	if (OpStatus::IsError(MDF_ShapedRunCache::Create(&shaped_run_cache, MDF_SHAPED_RUN_CACHE_SIZE, MDF_SHAPED_RUN_CACHE_HASH_SIZE)))
+	{
+		MDF_ReleaseFont(font);
+		return 0;
+	}
+	font->m_shaped_run_cache = shaped_run_cache;
+#endif // MDF_SHAPED_RUN_CACHE
+
 #ifdef DEBUG_ENABLE_OPASSERT
 	++ font->engine->m_created_font_count;
 #endif // DEBUG_ENABLE_OPASSERT
@@ -957,6 +973,9 @@ void MDF_ReleaseFont(MDE_FONT* font)
 #ifdef MDF_FONT_ADVANCE_CACHE
 	OP_DELETE(font->m_advance_cache);
 #endif // MDF_FONT_ADVANCE_CACHE
+#ifdef MDF_SHAPED_RUN_CACHE
+	OP_DELETE(font->m_shaped_run_cache);
+#endif // MDF_SHAPED_RUN_CACHE
 	font->engine->ReleaseFont(font);
 }
 
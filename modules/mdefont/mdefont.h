@@ -130,6 +130,9 @@ struct MDE_FONT {
 #ifdef MDF_FONT_ADVANCE_CACHE
 	class MDF_AdvanceCache* m_advance_cache;
 #endif // MDF_FONT_ADVANCE_CACHE
+#ifdef MDF_SHAPED_RUN_CACHE
+	class MDF_ShapedRunCache* m_shaped_run_cache;
+#endif // MDF_SHAPED_RUN_CACHE
 
 	MDF_FontEngine* engine;
 };
@@ -698,7 +701,12 @@ inline OP_STATUS MDF_ProcessString(MDE_FONT* font,
 								   const short word_width/* = -1*/,
 								   const int flags/* = MDF_PROCESS_FLAG_NONE*/)
 {
+#ifdef MDF_SHAPED_RUN_CACHE
+	OP_ASSERT(font->m_shaped_run_cache);
+	return font->m_shaped_run_cache->ProcessString(font, processed_string, str, len, extra_space, word_width, flags);
+#else
 	return font->engine->ProcessString(font, processed_string, str, len, extra_space, word_width, flags);
+#endif // MDF_SHAPED_RUN_CACHE
 }
 inline OP_STATUS MDF_LayoutString(MDE_FONT* font,
 								  ProcessedString& processed_string,
@@ -460,6 +460,145 @@ OP_STATUS MDF_AdvanceCache::LoadData(unsigned short slot, UINT32 id, MDE_FONT* f
 }
 #  endif // MDF_FONT_ADVANCE_CACHE
 
+
+
+////////// Shaped run cache //////////
+#  ifdef MDF_SHAPED_RUN_CACHE
+OP_STATUS MDF_ShapedRunCache::Create(MDF_ShapedRunCache** cache, unsigned short size, unsigned short hash_size)
+{
+	OP_ASSERT(cache);
+	OP_ASSERT(size % 2 == 0);
+
+	OpAutoArray<MDF_TwoLevelCacheEntry> entries(OP_NEWA(MDF_TwoLevelCacheEntry, size));
+	if (!entries.get())
+		return OpStatus::ERR_NO_MEMORY;
+	OpAutoArray<unsigned short> hash(OP_NEWA(unsigned short, 2 * hash_size));
+	if (!hash.get())
+		return OpStatus::ERR_NO_MEMORY;
+	OpAutoArray<Run> runs(OP_NEWA(Run, size));
+	if (!runs.get())
+		return OpStatus::ERR_NO_MEMORY;
+	for (unsigned short i = 0; i < size; ++i)
+	{
+		runs[i].text = 0;
+		runs[i].glyphs = 0;
+	}
+	MDF_ShapedRunCache* rc = OP_NEW(MDF_ShapedRunCache, (size, hash_size, entries.get(), hash.get(), runs.get()));
+	if (!rc)
+		return OpStatus::ERR_NO_MEMORY;
+	*cache = rc;
+	entries.release();
+	hash.release();
+	runs.release();
+	return OpStatus::OK;
+}
+// static
+UINT32 MDF_ShapedRunCache::Hash(const Args& args)
+{
+	UINT32 hash = args.len;
+	hash = hash * 31 + (UINT32)args.extra_space;
+	hash = hash * 31 + (UINT32)args.word_width;
+	hash = hash * 31 + (UINT32)args.flags;
+	for (unsigned int i = 0; i < args.len; ++i)
+		hash = hash * 31 + args.str[i];
+	return hash;
+}
+BOOL ShapedRunMatch(MDF_TwoLevelCache* _cache, unsigned short slot, const void* _args)
+{
+	OP_ASSERT(_args);
+	const MDF_ShapedRunCache* cache = (const MDF_ShapedRunCache*)_cache;
+	const MDF_ShapedRunCache::Args& args = *(const MDF_ShapedRunCache::Args*)_args;
+	const MDF_ShapedRunCache::Run& run = cache->m_runs[slot];
+	return run.len == args.len &&
+		run.extra_space == args.extra_space &&
+		run.word_width == args.word_width &&
+		run.flags == args.flags &&
+		!op_memcmp(run.text, args.str, args.len * sizeof(uni_char));
+}
+OP_STATUS MDF_ShapedRunCache::ProcessString(MDE_FONT* font,
+											ProcessedString& processed_string,
+											const uni_char* str, const unsigned int len,
+											const int extra_space, const short word_width, const int flags)
+{
+	if (len == 0 || len > MAX_RUN_LENGTH)
+		return font->engine->ProcessString(font, processed_string, str, len, extra_space, word_width, flags);
+
+	Args args;
+	args.str = str;
+	args.len = len;
+	args.extra_space = extra_space;
+	args.word_width = word_width;
+	args.flags = flags;
+	args.result = &processed_string;
+	args.processed = FALSE;
+
+	unsigned short slot;
+	OP_STATUS status = GetData(slot, Hash(args), font, &args);
+	if (args.processed)
+	{
+		// not in cache - processed_string holds the result even if it
+		// could not be stored (OOM), and caching is just a bonus
+		++m_misses;
+		return OpStatus::OK;
+	}
+	RETURN_IF_ERROR(status);
+
+	++m_hits;
+	const Run& run = m_runs[slot];
+	RETURN_IF_ERROR(font->engine->glyph_buffer.Grow(run.glyph_count));
+	ProcessedGlyph* glyphs = font->engine->glyph_buffer.Storage();
+	op_memcpy(glyphs, run.glyphs, run.glyph_count * sizeof(*glyphs));
+
+	processed_string.m_length = run.glyph_count;
+	processed_string.m_advance = run.advance;
+	processed_string.m_processed_glyphs = glyphs;
+	processed_string.m_is_glyph_indices = run.is_glyph_indices;
+	processed_string.m_top_left_positioned = FALSE;
+	return OpStatus::OK;
+}
+OP_STATUS MDF_ShapedRunCache::LoadData(unsigned short slot, UINT32 id, MDE_FONT* font, const void* _args)
+{
+	OP_ASSERT(_args);
+	Args& args = *(Args*)_args;
+	ProcessedString& processed_string = *args.result;
+	RETURN_IF_ERROR(font->engine->ProcessString(font, processed_string, args.str, args.len, args.extra_space, args.word_width, args.flags));
+	args.processed = TRUE;
+
+	OpAutoArray<uni_char> text(OP_NEWA(uni_char, args.len));
+	if (!text.get())
+		return OpStatus::ERR_NO_MEMORY;
+	OpAutoArray<ProcessedGlyph> glyphs;
+	if (processed_string.m_length)
+	{
+		glyphs.reset(OP_NEWA(ProcessedGlyph, processed_string.m_length));
+		if (!glyphs.get())
+			return OpStatus::ERR_NO_MEMORY;
+		op_memcpy(glyphs.get(), processed_string.m_processed_glyphs, processed_string.m_length * sizeof(ProcessedGlyph));
+	}
+	op_memcpy(text.get(), args.str, args.len * sizeof(uni_char));
+
+	Run& run = m_runs[slot];
+	run.text = text.release();
+	run.len = args.len;
+	run.extra_space = args.extra_space;
+	run.word_width = args.word_width;
+	run.flags = args.flags;
+	run.glyphs = glyphs.release();
+	run.glyph_count = processed_string.m_length;
+	run.advance = processed_string.m_advance;
+	run.is_glyph_indices = processed_string.m_is_glyph_indices;
+	return OpStatus::OK;
+}
+void MDF_ShapedRunCache::Free(unsigned short slot)
+{
+	Run& run = m_runs[slot];
+	OP_DELETEA(run.text);
+	run.text = 0;
+	OP_DELETEA(run.glyphs);
+	run.glyphs = 0;
+}
+#  endif // MDF_SHAPED_RUN_CACHE
+
 # undef MDF_TL_EMPTY
 # undef MDF_TL_HASH
 
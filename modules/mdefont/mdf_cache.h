@@ -247,4 +247,95 @@ private:
 };
 # endif // MDF_FONT_ADVANCE_CACHE
 
+
+
+
+# ifdef MDF_SHAPED_RUN_CACHE
+struct ProcessedString;
+struct ProcessedGlyph;
+
+// compares the text and processing parameters of entries, since the id is just a hash of them
+BOOL ShapedRunMatch(MDF_TwoLevelCache* cache, unsigned short slot, const void* args);
+/**
+   the shaped run cache stores the result of MDF_ProcessString - glyph
+   id:s and positions, and the advance - for short runs of text in a
+   font, so that a word that is measured during layout and then
+   painted, or measured again when relayouting, is only processed
+   once. runs are identified by their text and the parameters passed
+   to MDF_ProcessString.
+ */
+class MDF_ShapedRunCache : public MDF_TwoLevelCache
+{
+public:
+	// comparison function needs access to members
+	friend BOOL ShapedRunMatch(MDF_TwoLevelCache* cache, unsigned short slot, const void* args);
+
+	/** runs longer than this (in uni_char:s) are not cached */
+	enum { MAX_RUN_LENGTH = 64 };
+
+	~MDF_ShapedRunCache() { Shutdown(); OP_DELETEA(m_runs); }
+	static OP_STATUS Create(MDF_ShapedRunCache** cache, unsigned short size, unsigned short hash_size);
+
+	/**
+	   same as MDF_ProcessString, but looks the run up in the cache
+	   first. on a hit, the cached glyphs are copied to the glyph
+	   buffer of the font engine, so processed_string is valid until
+	   the next call to MDF_ProcessString, just like on a miss.
+	*/
+	OP_STATUS ProcessString(MDE_FONT* font,
+							ProcessedString& processed_string,
+							const uni_char* str, const unsigned int len,
+							const int extra_space, const short word_width, const int flags);
+
+	unsigned int GetHits() const { return m_hits; }
+	unsigned int GetMisses() const { return m_misses; }
+
+protected:
+	/** a cached run */
+	struct Run
+	{
+		uni_char* text;
+		unsigned int len;
+		int extra_space;
+		short word_width;
+		int flags;
+
+		ProcessedGlyph* glyphs;
+		size_t glyph_count;
+		INT32 advance;
+		BOOL is_glyph_indices;
+	};
+
+	MDF_ShapedRunCache(size_t cache_size, size_t hash_size,
+					   MDF_TwoLevelCacheEntry* slots, unsigned short* hashes,
+					   Run* runs)
+		: MDF_TwoLevelCache(cache_size, hash_size, slots, hashes, ShapedRunMatch)
+		, m_runs(runs), m_hits(0), m_misses(0)
+	{}
+
+	virtual OP_STATUS LoadData(unsigned short slot, UINT32 id, MDE_FONT* font, const void* args);
+	virtual void Free(unsigned short slot);
+
+private:
+	struct Args
+	{
+		const uni_char* str;
+		unsigned int len;
+		int extra_space;
+		short word_width;
+		int flags;
+
+		/** set by LoadData when the run has been processed */
+		ProcessedString* result;
+		BOOL processed;
+	};
+
+	static UINT32 Hash(const Args& args);
+
+	Run* const m_runs;
+	unsigned int m_hits;
+	unsigned int m_misses;
+};
+# endif // MDF_SHAPED_RUN_CACHE
+
 #endif // MDF_CACHE_H
@@ -7,6 +7,10 @@
 #include "modules/minpng/minpng.h"
 #include "modules/minpng/png_int.h"
 
+#ifdef MINPNG_USE_SSE2
+#include "modules/pi/OpSystemInfo.h"
+#endif // MINPNG_USE_SSE2
+
 #ifndef MINPNG_NO_GAMMA_SUPPORT
 static void _set_gamma(float gamma, minpng_state* s)
 {
@@ -243,6 +247,19 @@ static int convert_to_rgba(RGBAGroup* w1, int type, int bpp, unsigned char* s,
 			return 1;
 
 		case 6: /* 8 or 16 bit r,g,b,a */
+#ifdef MINPNG_USE_SSE2
+			if (bpp == 8 && (g_op_system_info->GetCPUFeatures() & OpSystemInfo::CPU_FEATURES_IA32_SSE2))
+			{
+				for (yp = 0; yp < height; yp++)
+				{
+					s++;
+					minpng_rgba_to_rgbagroup_sse2(d1, s, width);
+					d1 += width;
+					s += width * 4;
+				}
+				return 1;
+			}
+#endif // MINPNG_USE_SSE2
 			if (bpp == 8)
 			{
 				for (yp = 0; yp < height; yp++)
@@ -279,13 +296,85 @@ static int convert_to_rgba(RGBAGroup* w1, int type, int bpp, unsigned char* s,
 	return -1;
 }
 
+void minpng_defilter_row(unsigned char filter, unsigned char* d, const unsigned char* prev,
+						 unsigned int linew, unsigned int bps)
+{
+	unsigned int xp;
+	switch (filter)
+	{
+		case 0: /* No filter */
+			break;
+
+		case 1: /* Subtract left. */
+			for (xp = bps; xp < linew; xp++)
+				d[xp] += d[xp - bps];
+			break;
+
+		case 2: /* Subtract up. */
+			if (!prev)
+				break; // Ignore if it's the first line...
+			for (xp = 0; xp < linew; xp++)
+				d[xp] += prev[xp];
+			break;
+
+		case 3: /* Average left/up. */
+			if (prev)
+				for (xp = 0; xp < linew; xp++)
+					d[xp] += (prev[xp] + (xp < bps ? 0 : d[xp - bps])) >> 1;
+			else
+				for (xp = bps; xp < linew; xp++)
+					d[xp] += d[xp - bps] >> 1;
+			break;
+
+		case 4: /* paeth (left up) */
+			for (xp = 0 ; xp < linew; xp++)
+			{
+				int a, q, c, pa, pb, pc;
+
+				if (xp >= bps)
+					a = d[xp - bps];
+				else
+					a = 0;
+				if (prev)
+				{
+					q = prev[xp];
+					if (xp >= bps)
+						c = prev[xp - bps];
+					else
+						c = 0;
+					pa= (q - c);
+					if (pa < 0)
+						pa = -pa;
+				}
+				else
+					pa = c = q = 0;
+
+				pb = (a - c);
+				if (pb < 0)
+					pb = -pb;
+
+				pc = (a + q - (c << 1));
+				if (pc < 0)
+					pc = -pc;
+
+				if (pa <= pb && pa <= pc)
+					d[xp] += a;
+				else if (pb <= pc)
+					d[xp] += q;
+				else
+					d[xp] += c;
+			}
+			break;
+	}
+}
+
 static void _defilter(minpng_buffer* ps, unsigned int linew, unsigned int height,
 					  char type, char bpp, unsigned int* last_line, unsigned int* left,
 					  unsigned char** line_start)
 {
 	unsigned char* row;
 	unsigned int len = ps->size();
-	unsigned int yp, xp;
+	unsigned int yp;
 	unsigned int bps;
 	char upp = 1;
 
@@ -326,76 +415,21 @@ static void _defilter(minpng_buffer* ps, unsigned int linew, unsigned int height
 		*left -= (linew + 1) * (height - 1);
 	}
 
+#ifdef MINPNG_USE_SSE2
+	BOOL use_sse2 = (bps == 3 || bps == 4) &&
+		(g_op_system_info->GetCPUFeatures() & OpSystemInfo::CPU_FEATURES_IA32_SSE2);
+#endif // MINPNG_USE_SSE2
+
 	for (yp = 0; yp < height; yp++, row += linew + 1)
 	{
-		unsigned char *d = row + 1;
-		switch (*row) // Defilter a single row of data.
-		{
-			case 0: /* No filter */
-				break;
-
-			case 1: /* Subtract left. */
-				d += bps;
-				for ( xp = bps; xp < linew; xp++, d++)
-					*d = d[0] + d[-(int)bps];
-				break;
-
-			case 2: /* Subtract up. */
- 				if (!yp)
-					break; // Ignore if it's the first line...
-				for (xp = 0; xp < linew; xp++)
-					d[xp] += d[(int)xp - (int)linew - 1];
-				break;
-
-			case 3: /* Average left/up. */
-				if (yp > 0)
-					for (xp = 0; xp < linew; xp++, d++)
-						*d += (d[-((int)linew + 1)] + (xp < bps ? 0 : d[-(int)bps])) >> 1;
-				else
-					for (xp = bps; xp < linew; xp++)
-						d[xp] += d[(int)xp - (int)bps] >> 1;
-				break;
-
-			case 4: /* paeth (left up) */
-				for (xp = 0 ; xp < linew; xp++, d++)
-				{
-					int a, q, c, pa, pb, pc;
-
-					if (xp >= (unsigned)bps)
-						a = d[-(int)bps];
-					else
-						a = 0;
-					if (yp > 0)
-					{
-						q = d[-(int)(linew + 1)];
-						if (xp >= (unsigned)bps)
-							c = d[-(int)linew - 1 - (int)bps];
-						else
-							c = 0;
-						pa= (q - c);
-						if (pa < 0)
-							pa = -pa;
-					}
-					else
-						pa = c = q = 0;
-
-					pb = (a - c);
-					if (pb < 0)
-						pb = -pb;
-
-					pc = (a + q - (c << 1));
-					if (pc < 0)
-						pc = -pc;
-
-					if (pa <= pb && pa <= pc)
-						*d += a;
-					else if (pb <= pc)
-						*d += q;
-					else
-						*d += c;
-				}
-				break;
-		}
+		// Defilter a single row of data.
+		const unsigned char* prev = yp ? row - linew : NULL;
+#ifdef MINPNG_USE_SSE2
+		if (use_sse2 && prev)
+			minpng_defilter_row_sse2(*row, row + 1, prev, linew, bps);
+		else
+#endif // MINPNG_USE_SSE2
+			minpng_defilter_row(*row, row + 1, prev, linew, bps);
 		// Set filter to 0 for this row for the next pass, if any.
 		// Sometimes rows are looked at twice with the current algorithm.
 		*row = 0;
@@ -0,0 +1,190 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#if defined(_PNG_SUPPORT_) && defined(MINPNG_USE_SSE2)
+
+#include "modules/zlib/zlib.h"
+#include "modules/minpng/minpng.h"
+#include "modules/minpng/png_int.h"
+
+#include <emmintrin.h>
+
+// Sub, Average and Paeth depend on the pixel to the left, so those filters
+// are done one pixel at a time with all the samples of the pixel in one
+// register. Nothing is read or written past the end of the row. Three byte
+// pixels are moved one byte at a time, since a copy through memory stalls
+// on store forwarding.
+
+template <unsigned int bps>
+static op_force_inline __m128i LoadPixel(const unsigned char* p)
+{
+	UINT32 v;
+	if (bps == 4)
+		op_memcpy(&v, p, 4);
+	else
+		v = p[0] | (p[1] << 8) | (p[2] << 16);
+	return _mm_cvtsi32_si128(v);
+}
+
+template <unsigned int bps>
+static op_force_inline void StorePixel(unsigned char* p, __m128i v)
+{
+	UINT32 w = _mm_cvtsi128_si32(v);
+	if (bps == 4)
+		op_memcpy(p, &w, 4);
+	else
+	{
+		p[0] = (unsigned char)w;
+		p[1] = (unsigned char)(w >> 8);
+		p[2] = (unsigned char)(w >> 16);
+	}
+}
+
+// mask ? x : y
+static op_force_inline __m128i Select(__m128i mask, __m128i x, __m128i y)
+{
+	return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y));
+}
+
+static op_force_inline __m128i Abs16(__m128i v)
+{
+	return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+}
+
+template <unsigned int bps>
+static void DefilterSub(unsigned char* d, unsigned int linew)
+{
+	__m128i a = _mm_setzero_si128();
+	for (unsigned int xp = 0; xp < linew; xp += bps)
+	{
+		a = _mm_add_epi8(a, LoadPixel<bps>(d + xp));
+		StorePixel<bps>(d + xp, a);
+	}
+}
+
+static void DefilterUp(unsigned char* d, const unsigned char* prev, unsigned int linew)
+{
+	unsigned int xp = 0;
+	for (; xp + 16 <= linew; xp += 16)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(d + xp));
+		__m128i b = _mm_loadu_si128((const __m128i*)(prev + xp));
+		_mm_storeu_si128((__m128i*)(d + xp), _mm_add_epi8(x, b));
+	}
+	for (; xp < linew; xp++)
+		d[xp] += prev[xp];
+}
+
+template <unsigned int bps>
+static void DefilterAverage(unsigned char* d, const unsigned char* prev, unsigned int linew)
+{
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i a = _mm_setzero_si128();
+	for (unsigned int xp = 0; xp < linew; xp += bps)
+	{
+		__m128i b = LoadPixel<bps>(prev + xp);
+		// _mm_avg_epu8 rounds up, the filter rounds down.
+		__m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+		a = _mm_add_epi8(LoadPixel<bps>(d + xp), avg);
+		StorePixel<bps>(d + xp, a);
+	}
+}
+
+template <unsigned int bps>
+static void DefilterPaeth(unsigned char* d, const unsigned char* prev, unsigned int linew)
+{
+	// The samples are widened to words so the predictor distances fit.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low_byte = _mm_set1_epi16(0xff);
+	__m128i a = zero;
+	__m128i c = zero;
+	for (unsigned int xp = 0; xp < linew; xp += bps)
+	{
+		__m128i b = _mm_unpacklo_epi8(LoadPixel<bps>(prev + xp), zero);
+		__m128i x = _mm_unpacklo_epi8(LoadPixel<bps>(d + xp), zero);
+
+		__m128i pa = _mm_sub_epi16(b, c);
+		__m128i pb = _mm_sub_epi16(a, c);
+		__m128i pc = Abs16(_mm_add_epi16(pa, pb));
+		pa = Abs16(pa);
+		pb = Abs16(pb);
+		__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+		// Ties are broken in the order a, b, c.
+		__m128i nearest = Select(_mm_cmpeq_epi16(smallest, pa), a,
+								 Select(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+		a = _mm_and_si128(_mm_add_epi16(x, nearest), low_byte);
+		StorePixel<bps>(d + xp, _mm_packus_epi16(a, a));
+		c = b;
+	}
+}
+
+void minpng_defilter_row_sse2(unsigned char filter, unsigned char* row, const unsigned char* prev,
+							  unsigned int linew, unsigned int bps)
+{
+	OP_ASSERT(prev && (bps == 3 || bps == 4) && linew % bps == 0);
+
+	switch (filter)
+	{
+		case 1:
+			if (bps == 3)
+				DefilterSub<3>(row, linew);
+			else
+				DefilterSub<4>(row, linew);
+			break;
+
+		case 2:
+			DefilterUp(row, prev, linew);
+			break;
+
+		case 3:
+			if (bps == 3)
+				DefilterAverage<3>(row, prev, linew);
+			else
+				DefilterAverage<4>(row, prev, linew);
+			break;
+
+		case 4:
+			if (bps == 3)
+				DefilterPaeth<3>(row, prev, linew);
+			else
+				DefilterPaeth<4>(row, prev, linew);
+			break;
+	}
+}
+
+void minpng_rgba_to_rgbagroup_sse2(RGBAGroup* dest, const unsigned char* src, unsigned int width)
+{
+#ifdef PLATFORM_COLOR_IS_RGBA
+	op_memcpy(dest, src, width * 4);
+#else
+	// Swap the red and blue samples of four pixels at a time.
+	const __m128i ag_mask = _mm_set1_epi32((int)0xff00ff00);
+	unsigned int x = 0;
+	for (; x + 4 <= width; x += 4)
+	{
+		__m128i p = _mm_loadu_si128((const __m128i*)(src + x * 4));
+		__m128i ag = _mm_and_si128(p, ag_mask);
+		__m128i rb = _mm_andnot_si128(ag_mask, p);
+		rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+		_mm_storeu_si128((__m128i*)(dest + x), _mm_or_si128(ag, rb));
+	}
+	for (; x < width; x++)
+	{
+		dest[x].r = src[x * 4];
+		dest[x].g = src[x * 4 + 1];
+		dest[x].b = src[x * 4 + 2];
+		dest[x].a = src[x * 4 + 3];
+	}
+#endif // PLATFORM_COLOR_IS_RGBA
+}
+
+#endif // _PNG_SUPPORT_ && MINPNG_USE_SSE2
@@ -594,4 +594,28 @@ enum
 	STATE_CRC
 };
 
+/**
+ * Reverses the filter of one row of image data.
+ * @param filter The filter type byte of the row.
+ * @param row The filtered bytes of the row, defiltered in place.
+ * @param prev The defiltered previous row, or NULL for the first row of the image.
+ * @param linew Number of bytes in the row, not counting the filter type byte.
+ * @param bps Number of bytes per pixel, rounded up to 1 for less than 8 bits per pixel.
+ */
+void minpng_defilter_row(unsigned char filter, unsigned char* row, const unsigned char* prev,
+						 unsigned int linew, unsigned int bps);
+
+#ifdef MINPNG_USE_SSE2
+/**
+ * Same as minpng_defilter_row, for 3 or 4 bytes per pixel and a non-NULL prev.
+ */
+void minpng_defilter_row_sse2(unsigned char filter, unsigned char* row, const unsigned char* prev,
+							  unsigned int linew, unsigned int bps);
+
+/**
+ * Converts width pixels of 8 bit RGBA samples to RGBAGroup.
+ */
+void minpng_rgba_to_rgbagroup_sse2(RGBAGroup* dest, const unsigned char* src, unsigned int width);
+#endif // MINPNG_USE_SSE2
+
 #endif // !MINPNG_PNG_INT_H
@@ -773,6 +773,7 @@ public:
 		, CPU_FEATURES_IA32_SSSE3  = (1 << 2)
 		, CPU_FEATURES_IA32_SSE4_1 = (1 << 3)
 		, CPU_FEATURES_IA32_SSE4_2 = (1 << 4)
+		, CPU_FEATURES_IA32_PCLMULQDQ = (1 << 5)	///< Carry-less multiplication (PCLMULQDQ)
 #endif
 	};
 
@@ -24,6 +24,7 @@
 #include "modules/style/css_webfont.h"
 #include "modules/style/src/css_rule.h"
 #include "modules/style/css_viewport.h"
+#include "modules/style/src/css_invalidation.h"
 
 class URL;
 class HLDocProfile;
@@ -122,6 +123,12 @@ public:
 
 	int GetSuccessiveAdjacent() { return m_succ_adj; }
 
+#ifdef CSS_INVALIDATION_SETS
+	/** @return The class, id and attribute invalidation sets for the
+				selectors in this stylesheet. */
+	const CSS_InvalidationSet& GetInvalidationSet() const { return m_invalidation_set; }
+#endif // CSS_INVALIDATION_SETS
+
 #ifdef DOM_FULLSCREEN_MODE
 	/** @return TRUE if there is a selector in this stylesheet which has
 		:fullscreen or :fullscreen-ancestor in other places than
@@ -422,6 +429,29 @@ public:
 	BOOL HasViewportRules() { return m_viewport_rules.First() != NULL; }
 #endif // CSS_VIEWPORT_SUPPORT
 
+#ifdef CSS_ANCESTOR_FILTER
+	/** @return The number of selectors checked against the ancestor filter
+				in GetProperties since the last ResetAncestorFilterStats. */
+	unsigned int GetAncestorFilterChecks() const { return m_ancestor_filter_checks; }
+
+	/** @return The number of selectors rejected by the ancestor filter
+				in GetProperties since the last ResetAncestorFilterStats. */
+	unsigned int GetAncestorFilterRejects() const { return m_ancestor_filter_rejects; }
+
+	/** Reset the ancestor filter statistics for this stylesheet. */
+	void ResetAncestorFilterStats() { m_ancestor_filter_checks = m_ancestor_filter_rejects = 0; }
+#endif // CSS_ANCESTOR_FILTER
+
+#ifdef CSS_RULE_BUCKETS
+	/** @return The number of attribute names that selectors are hashed on
+				in this stylesheet. */
+	int GetAttrBucketCount() const { return m_attr_rules.GetCount(); }
+
+	/** @return The number of dynamic pseudo classes that selectors are
+				hashed on in this stylesheet. */
+	int GetDynamicBucketCount() const { return m_dynamic_rules.GetCount(); }
+#endif // CSS_RULE_BUCKETS
+
 private:
 
 	/** Is this a user stylesheet? */
@@ -456,6 +486,11 @@ private:
 	/** The maximum number of successive adjacent selectors in this stylesheet. */
 	int m_succ_adj;
 
+#ifdef CSS_INVALIDATION_SETS
+	/** Which elements may be affected by class, id and attribute changes. */
+	CSS_InvalidationSet m_invalidation_set;
+#endif // CSS_INVALIDATION_SETS
+
 #ifdef DOM_FULLSCREEN_MODE
 	/** Set to TRUE if there is a selector in this collection which has
 		:fullscreen or :fullscreen-ancestor in other places than
@@ -549,8 +584,27 @@ private:
 	/** Helper method for CSS::GetProperties. */
 	CSS_RuleElm** MakeDynamicRuleElmList(CSS_RuleElm** elm_list, unsigned int i, const ClassAttribute* class_attr, unsigned int& list_count) const;
 
+	/** @return TRUE if the stylesheet has any style rules in its hash tables. */
+	BOOL HasStyleRules() const;
+
+	/** Get the hash table and key for a selector which is not hashed on a
+		single id or class in its rightmost simple selector.
+
+		@param sel The selector.
+		@param[out] key Set to the key of the selector in the returned table.
+		@return The hash table the selector belongs in. */
+	OpINT32HashTable<CSS_RuleElmList>& GetRuleTable(CSS_Selector* sel, UINT32& key);
+
 	unsigned int m_next_rule_number;
 
+#ifdef CSS_ANCESTOR_FILTER
+	/** Number of selectors checked against the ancestor filter. Updated during matching. */
+	mutable unsigned int m_ancestor_filter_checks;
+
+	/** Number of selectors rejected by the ancestor filter. Updated during matching. */
+	mutable unsigned int m_ancestor_filter_rejects;
+#endif // CSS_ANCESTOR_FILTER
+
 	/** Hash table for rules with type selector in rightmost simple selector. */
 	OpINT32HashTable<CSS_RuleElmList> m_type_rules;
 
@@ -560,6 +614,18 @@ private:
 	/** Hash table for rules with universal class selector in rightmost simple selector. */
 	OpStringHashTable<CSS_RuleElmList> m_class_rules;
 
+#ifdef CSS_RULE_BUCKETS
+	/** Hash table for rules with universal attribute selector in rightmost
+		simple selector. Keyed on the case-insensitive hash of the attribute
+		name, so a list may hold rules for more than one name. */
+	OpINT32HashTable<CSS_RuleElmList> m_attr_rules;
+
+	/** Hash table for rules with universal :hover, :active or :focus in
+		rightmost simple selector. Keyed on the CSSPseudoClassType bit. The
+		rules are only matched against elements in that state. */
+	OpINT32HashTable<CSS_RuleElmList> m_dynamic_rules;
+#endif // CSS_RULE_BUCKETS
+
 	/** The list of @page rules in this stylesheet */
 	CSS_RuleElmList m_page_rules;
 
@@ -21,6 +21,7 @@
 #include "modules/style/css_animations.h"
 #include "modules/util/OpHashTable.h"
 #include "modules/hardcore/timer/optimer.h"
+#include "modules/style/src/css_sliced_parser.h"
 
 class CSS_WebFont;
 
@@ -348,6 +349,11 @@ public:
 		m_has_transitions(FALSE),
 		m_has_animations(FALSE),
 #endif // CSS_TRANSITIONS
+#ifdef CSS_INVALIDATION_SETS
+		m_attr_change_elm(NULL),
+		m_attr_change_attr(Markup::HA_NULL),
+		m_attr_change_flags(0),
+#endif // CSS_INVALIDATION_SETS
 		m_match_first_child(FALSE),
 		m_font_prefetch_limit(-1)
 	{
@@ -401,6 +407,33 @@ public:
 		AddCollectionElement with commit=FALSE. */
 	void CommitAdded();
 
+#ifdef CSS_SLICED_PARSING
+	/** Start parsing a large external stylesheet in slices from the message
+		loop. The stylesheet is not added to the collection by this method.
+		When the last slice has been parsed, it is handed to
+		HTML_Element::AddParsedCSS() for the link element, and the document
+		stops waiting for it.
+
+		@param elm The link element of the stylesheet.
+		@param css The stylesheet to parse into. The collection takes over
+				   the ownership if this method succeeds.
+		@param src_head The source of the stylesheet.
+		@param start_line_number Line number of the first line of the source.
+		@return OK if sliced parsing was started. ERR_NO_MEMORY on OOM, or ERR
+				if the stylesheet is too small to be sliced. The stylesheet
+				must then be parsed in one go by the caller. */
+	OP_STATUS StartSlicedParsing(HTML_Element* elm, CSS* css, DataSrc* src_head, unsigned start_line_number);
+
+	/** Stop parsing the stylesheet of an element in slices, if in
+		progress. The partially parsed stylesheet is deleted. */
+	void CancelSlicedParsing(HTML_Element* elm);
+
+	/** @return TRUE if the stylesheet of an element is being parsed in
+				slices. The load event of the element is then sent when
+				the stylesheet is added. */
+	BOOL IsSlicedParsing(HTML_Element* elm);
+#endif // CSS_SLICED_PARSING
+
 	/** Change bits used for the StyleChanged() method. */
 	enum StyleChange
 	{
@@ -454,6 +487,51 @@ public:
 		all stylesheets in this collection. */
 	int GetSuccessiveAdjacent() const;
 
+#ifdef CSS_INVALIDATION_SETS
+	/** Which elements, relative to an element whose class, id or attribute
+		changes, may need to have their css properties reloaded. */
+	enum InvalidationFlags
+	{
+		/** The element itself. */
+		INVALIDATE_SELF = 0x1,
+
+		/** The descendants of the element. */
+		INVALIDATE_DESCENDANTS = 0x2,
+
+		/** The element's subtree and its successive siblings and their
+			subtrees, as limited by GetSuccessiveAdjacent(). */
+		INVALIDATE_SIBLINGS = 0x4,
+
+		INVALIDATE_ALL = INVALIDATE_SELF | INVALIDATE_DESCENDANTS | INVALIDATE_SIBLINGS
+	};
+
+	/** Called before an attribute on an element changes, while the old value
+		is still present, so that elements affected by the old value can be
+		included in the result of GetAttributeInvalidation(). Must be followed
+		by a call to EndAttributeChange().
+
+		@param element The element whose attribute is about to change.
+		@param attr The attribute.
+		@param attr_ns The namespace of the attribute. */
+	void BeginAttributeChange(HTML_Element* element, short attr, NS_Type attr_ns);
+
+	/** Called when the attribute change announced with BeginAttributeChange()
+		has been handled. */
+	void EndAttributeChange() { m_attr_change_elm = NULL; }
+
+	/** Look up the stylesheets' invalidation sets for an attribute change.
+		Only the class and id attributes and attributes unknown to the html
+		parser on html elements are tracked; any other change affects all.
+		INVALIDATE_SELF is always included since the element's properties may
+		depend on the attribute without any selector, like for attr().
+
+		@param element The element whose attribute changed.
+		@param attr The attribute that changed.
+		@param attr_ns The namespace of the attribute.
+		@return A combination of InvalidationFlags. */
+	int GetAttributeInvalidation(HTML_Element* element, short attr, NS_Type attr_ns);
+#endif // CSS_INVALIDATION_SETS
+
 	/** Find a web-font by font family and media type using cascading order. Returns NULL if not found. */
 	CSS_WebFont* GetWebFont(const uni_char* family_name, CSS_MediaType media_type);
 
@@ -667,6 +745,11 @@ private:
 	/** A linked list of the collection elements added with commit=FALSE */
 	List<CSSCollectionElement> m_pending_elements;
 
+#ifdef CSS_SLICED_PARSING
+	/** Stylesheets being parsed in slices. */
+	AutoDeleteList<CSS_SlicedParser> m_sliced_parsers;
+#endif // CSS_SLICED_PARSING
+
 	/** Constants defining indices into the m_stylesheet_array. */
 	enum StyleSheetIndex
 	{
@@ -733,6 +816,21 @@ private:
 	BOOL m_has_animations;
 #endif // CSS_ANIMATIONS
 
+#ifdef CSS_INVALIDATION_SETS
+	/** @return The InvalidationFlags for the current value of attr on element
+				from all stylesheets that apply to this collection's document. */
+	int GetValueInvalidation(HTML_Element* element, short attr);
+
+	/** The element passed to BeginAttributeChange(), or NULL. */
+	HTML_Element* m_attr_change_elm;
+
+	/** The attribute passed to BeginAttributeChange(). */
+	short m_attr_change_attr;
+
+	/** The InvalidationFlags for the attribute value before the change. */
+	int m_attr_change_flags;
+#endif // CSS_INVALIDATION_SETS
+
 	/** Set to TRUE if we have ever tried to match :first-child or :not(:first-child).
 		Used for MarkPropsDirty optimization. */
 	BOOL m_match_first_child;
@@ -86,6 +86,123 @@ struct CSS_NthCache
 	NS_Type m_ns_types[NTH_TYPE_ARRAY_SIZE];
 };
 
+#ifdef CSS_ANCESTOR_FILTER
+
+/** A counting Bloom filter of the element types, ids and classes of the
+	ancestors of the element currently being matched in a TOP_DOWN
+	CSS_MatchContext operation.
+
+	Selectors store the hashes of the simple selectors which must match an
+	ancestor element (the ones to the left of a descendant or child
+	combinator). If one of those hashes is not in the filter, no ancestor
+	can match and the selector can be rejected without walking up the
+	context path. The filter may give false positives, never false
+	negatives. */
+
+class CSS_AncestorFilter
+{
+public:
+
+	enum
+	{
+		/** Number of bits used for each of the two indices into the filter. */
+		FILTER_BITS = 12,
+
+		/** Number of counters in the filter. */
+		FILTER_SIZE = 1 << FILTER_BITS,
+
+		/** Mask for an index into the filter. */
+		FILTER_MASK = FILTER_SIZE - 1,
+
+		/** Counter value that is never incremented or decremented. */
+		COUNTER_MAX = 255
+	};
+
+	/** Construct. Empty filter. */
+
+	CSS_AncestorFilter() { Reset(); }
+
+	/** Remove all elements from the filter. */
+
+	void Reset()
+	{
+		op_memset(m_counters, 0, sizeof(m_counters));
+		m_foreign_count = 0;
+	}
+
+	/** Add the type, id and classes of a context element to the filter. */
+
+	void PushElement(CSS_MatchContextElm* context_elm) { UpdateElement(context_elm, TRUE); }
+
+	/** Remove the type, id and classes of a context element from the filter.
+		Must be called with the same element as a previous PushElement. */
+
+	void PopElement(CSS_MatchContextElm* context_elm) { UpdateElement(context_elm, FALSE); }
+
+	/** @return FALSE if no ancestor can have the id or class for the given hash. */
+
+	BOOL MayContain(UINT32 hash) const
+	{
+		return m_counters[hash & FILTER_MASK] != 0 && m_counters[(hash >> FILTER_BITS) & FILTER_MASK] != 0;
+	}
+
+	/** @return FALSE if no ancestor can match the element type for the given hash.
+				Elements outside the html namespace, or with unknown types, may be
+				matched by tag name, so any such ancestor makes all types possible. */
+
+	BOOL MayContainType(UINT32 hash) const { return m_foreign_count > 0 || MayContain(hash); }
+
+	/** Hash functions for element types, ids, and classes. The ids and
+		classes are hashed case-insensitively since they are matched
+		case-insensitively in quirks mode. Never returns 0. */
+
+	static UINT32 TypeHash(Markup::Type type) { return NonZero((static_cast<UINT32>(type) + 1) * 0x9e3779b1u); }
+	static UINT32 IdHash(const uni_char* id) { return NonZero(StringHash(id) * 0x85ebca6bu); }
+	static UINT32 ClassHash(const uni_char* cls) { return NonZero(StringHash(cls) * 0xc2b2ae35u); }
+
+private:
+
+	/** Add or remove the hashes for a context element. */
+
+	void UpdateElement(CSS_MatchContextElm* context_elm, BOOL add);
+
+	/** Add or remove a single hash. Saturated counters are left alone. */
+
+	void Update(UINT32 hash, BOOL add)
+	{
+		UpdateCounter(m_counters[hash & FILTER_MASK], add);
+		UpdateCounter(m_counters[(hash >> FILTER_BITS) & FILTER_MASK], add);
+	}
+
+	static void UpdateCounter(UINT8& counter, BOOL add)
+	{
+		if (counter == COUNTER_MAX)
+			return;
+
+		if (add)
+			counter++;
+		else
+		{
+			OP_ASSERT(counter > 0);
+			counter--;
+		}
+	}
+
+	static UINT32 StringHash(const uni_char* str);
+
+	static UINT32 NonZero(UINT32 hash) { return hash ? hash : 1; }
+
+	/** The counters. */
+
+	UINT8 m_counters[FILTER_SIZE];
+
+	/** Number of ancestors outside the html namespace, or with unknown element types. */
+
+	unsigned int m_foreign_count;
+};
+
+#endif // CSS_ANCESTOR_FILTER
+
 
 /** An element of the CSS_MatchContext. Each element represents an HTML_Element
 	in a path down the document tree, with the most accessed properties/attributes
@@ -611,6 +728,12 @@ public:
 			{
 				leaf->Init(m_current_leaf, NULL, html_elm, m_fullscreen_elm, LinkState());
 
+#ifdef CSS_ANCESTOR_FILTER
+				/* The previous leaf is now an ancestor of the element being matched. */
+				if (m_current_leaf && m_packed.mode == TOP_DOWN)
+					m_ancestor_filter.PushElement(m_current_leaf);
+#endif // CSS_ANCESTOR_FILTER
+
 				if (!m_current_leaf && m_packed.mode == TOP_DOWN)
 					leaf->SetIsRoot();
 
@@ -719,6 +842,10 @@ public:
 			CleanComputedStyles();
 #endif // CSS_TRANSITIONS
 			m_current_leaf = commit_leaf->Parent();
+#ifdef CSS_ANCESTOR_FILTER
+			if (m_current_leaf)
+				m_ancestor_filter.PopElement(m_current_leaf);
+#endif // CSS_ANCESTOR_FILTER
 			if (m_next-- > m_size)
 				OP_DELETE(commit_leaf);
 		}
@@ -864,6 +991,14 @@ public:
 	CSS_MatchRuleListener* Listener() const { return m_listener; }
 #endif // STYLE_GETMATCHINGRULES_API
 
+#ifdef CSS_ANCESTOR_FILTER
+	/** @return The filter of the ancestors of the current leaf element, or NULL
+				if it's not available. The filter is only maintained in the
+				TOP_DOWN mode where the full context path is known. */
+
+	const CSS_AncestorFilter* GetAncestorFilter() const { return m_packed.mode == TOP_DOWN ? &m_ancestor_filter : NULL; }
+#endif // CSS_ANCESTOR_FILTER
+
 	/** @return The cache used for matching :nth-* selectors. */
 
 	CSS_NthCache& GetNthCache() { return m_nth_cache; }
@@ -1013,6 +1148,13 @@ private:
 
 	CSS_NthCache m_nth_cache;
 
+#ifdef CSS_ANCESTOR_FILTER
+	/** Filter of the elements in the context path above the current leaf.
+		Only maintained in the TOP_DOWN mode. */
+
+	CSS_AncestorFilter m_ancestor_filter;
+#endif // CSS_ANCESTOR_FILTER
+
 	/** The index of the next CSS_MatchContextElm to available for allocation from the pool.
 		If m_next is larger than or equal to m_size, the next CSS_MatchContextElm requested
 		will be allocated from the heap. m_next will continuously grow with heap allocated
@@ -48,6 +48,11 @@
 #include "modules/probetools/probetimeline.h"
 #endif // SCOPE_PROFILER
 
+#ifdef CSS_RULE_BUCKETS
+#include "modules/style/src/css_pseudo_stack.h"
+#include "modules/util/hash.h"
+#endif // CSS_RULE_BUCKETS
+
 #include "modules/stdlib/include/double_format.h"
 
 // ***************************
@@ -513,6 +518,10 @@ CSS::CSS(HTML_Element* he, const URL& base_url, BOOL user_defined)
 	  m_xml(FALSE),
 	  m_skip(FALSE), m_modified(FALSE),
 	  m_next_rule_number(0)
+#ifdef CSS_ANCESTOR_FILTER
+	  , m_ancestor_filter_checks(0),
+	  m_ancestor_filter_rejects(0)
+#endif // CSS_ANCESTOR_FILTER
 {
 	const uni_char* rel = he->GetLinkRel();
 	const uni_char* ttl = he->GetStringAttr(Markup::HA_TITLE);
@@ -560,6 +569,10 @@ CSS::~CSS()
 	m_id_rules.DeleteAll();
 	m_class_rules.DeleteAll();
 	m_type_rules.DeleteAll();
+#ifdef CSS_RULE_BUCKETS
+	m_attr_rules.DeleteAll();
+	m_dynamic_rules.DeleteAll();
+#endif // CSS_RULE_BUCKETS
 	m_webfonts.DeleteAll();
 }
 
@@ -568,9 +581,7 @@ CSS::Added(CSSCollection* collection, FramesDocument* doc)
 {
 	OP_ASSERT(collection);
 
-	if (m_type_rules.GetCount() > 0 ||
-		m_id_rules.GetCount() > 0 ||
-		m_class_rules.GetCount() > 0)
+	if (HasStyleRules())
 		collection->MarkAffectedElementsPropsDirty(this);
 
 	unsigned int changes = CSSCollection::CHANGED_NONE;
@@ -619,9 +630,7 @@ CSS::Removed(CSSCollection* collection, FramesDocument* doc)
 
 	unsigned int changes = CSSCollection::CHANGED_NONE;
 
-	if (m_type_rules.GetCount() > 0 ||
-		m_id_rules.GetCount() > 0 ||
-		m_class_rules.GetCount() > 0)
+	if (HasStyleRules())
 		changes |= CSSCollection::CHANGED_PROPS;
 	if (m_page_rules.First())
 		changes |= CSSCollection::CHANGED_PAGEPROPS;
@@ -837,6 +846,44 @@ static BOOL LegalCueProperty(short property, Markup::Type type, BOOL has_past_or
 
 #endif // MEDIA_HTML_SUPPORT
 
+#ifdef CSS_RULE_BUCKETS
+
+/** Helper function for CSS::GetProperties. Append a rule list to the lists
+	to match, moving them to a larger array when full.
+
+	@param elm_list The lists to match. May be changed to a new array.
+	@param elm_array The stack allocated array of GetProperties.
+	@param list_count The number of lists in elm_list.
+	@param capacity The number of lists that fit in elm_list, excluding the
+					terminating NULL.
+	@param first The first element of the list to append.
+	@return FALSE on OOM, otherwise TRUE. */
+
+static BOOL
+AppendRuleElmList(CSS::CSS_RuleElm**& elm_list, CSS::CSS_RuleElm** elm_array, unsigned int& list_count, unsigned int& capacity, CSS::CSS_RuleElm* first)
+{
+	if (list_count == capacity)
+	{
+		unsigned int new_capacity = capacity * 2;
+		CSS::CSS_RuleElm** new_elm_list = OP_NEWA(CSS::CSS_RuleElm*, new_capacity + 1);
+		if (!new_elm_list)
+			return FALSE;
+
+		op_memcpy(new_elm_list, elm_list, list_count * sizeof(CSS::CSS_RuleElm*));
+
+		if (elm_list != elm_array)
+			OP_DELETEA(elm_list);
+
+		elm_list = new_elm_list;
+		capacity = new_capacity;
+	}
+
+	elm_list[list_count++] = first;
+	return TRUE;
+}
+
+#endif // CSS_RULE_BUCKETS
+
 BOOL CSS::GetProperties(CSS_MatchContext* match_context,
 						CSS_Properties* css_properties,
 						unsigned int stylesheet_number) const
@@ -937,12 +984,104 @@ BOOL CSS::GetProperties(CSS_MatchContext* match_context,
 	if (OpStatus::IsSuccess(m_type_rules.GetData(Markup::HTE_ANY, &list)) && list->First())
 		rule_lists[list_count++] = list->First();
 
+#ifdef CSS_RULE_BUCKETS
+	// A dynamically allocated array has no room left after the type lists.
+	unsigned int list_capacity = rule_lists == rule_list_array ? MAX_LIST_COUNT : list_count;
+	BOOL oom = FALSE;
+
+	if (m_attr_rules.GetCount() > 0)
+	{
+		HTML_Element* he = context_elm->HtmlElement();
+		unsigned int first_attr_list = list_count;
+		int attr_size = he->GetAttrSize();
+
+		for (int i = 0; i < attr_size && !oom; i++)
+		{
+			if (he->GetAttrItem(i) == Markup::HA_NULL || he->GetAttrIsSpecial(i))
+				continue;
+
+			const uni_char* name = he->GetAttrNameString(i);
+			if (!name || OpStatus::IsError(m_attr_rules.GetData(static_cast<UINT32>(djb2hash_nocase(name)), &list)) || !list->First())
+				continue;
+
+			// Attributes in different namespaces, or hash collisions, may share a list.
+			unsigned int j = first_attr_list;
+			while (j < list_count && rule_lists[j] != list->First())
+				j++;
+
+			if (j == list_count)
+				oom = !AppendRuleElmList(rule_lists, rule_list_array, list_count, list_capacity, list->First());
+		}
+	}
+
+	if (m_dynamic_rules.GetCount() > 0)
+	{
+		/* Rules hashed on a dynamic pseudo class are a bare :hover, :active
+		   or :focus, and can only match elements in that state, except when
+		   a listener forces the state. For other elements, it is enough to
+		   set the pseudo bits that matching would have committed, so that
+		   the properties are reloaded when the state changes. Affected
+		   elements (css_properties == NULL) are found by matching, since
+		   any set pseudo bit would mark them dirty. */
+
+		BOOL match_any_state = !css_properties;
+#ifdef STYLE_GETMATCHINGRULES_API
+		if (match_context->Listener())
+			match_any_state = TRUE;
+#endif // STYLE_GETMATCHINGRULES_API
+
+		const int dynamic_bits[] = { CSS_PSEUDO_CLASS_HOVER, CSS_PSEUDO_CLASS_ACTIVE, CSS_PSEUDO_CLASS_FOCUS };
+		int skipped_bits = 0;
+
+		context_elm->CacheDynamicState();
+
+		for (unsigned int i = 0; i < ARRAY_SIZE(dynamic_bits) && !oom; i++)
+		{
+			if (OpStatus::IsError(m_dynamic_rules.GetData(dynamic_bits[i], &list)) || !list->First())
+				continue;
+
+			BOOL in_state = dynamic_bits[i] == CSS_PSEUDO_CLASS_HOVER && context_elm->IsHovered() ||
+							dynamic_bits[i] == CSS_PSEUDO_CLASS_ACTIVE && context_elm->IsActivated() ||
+							dynamic_bits[i] == CSS_PSEUDO_CLASS_FOCUS && context_elm->IsFocused();
+
+			if (in_state || match_any_state)
+				oom = !AppendRuleElmList(rule_lists, rule_list_array, list_count, list_capacity, list->First());
+			else
+				skipped_bits |= dynamic_bits[i];
+		}
+
+		/* Matching a bare :hover or :active only commits the bit for links
+		   in quirks mode, and a selector without a pseudo element never
+		   matches a pseudo element. See CSS_SimpleSelector::MatchAttrs and
+		   CSS_Selector::Match. */
+
+		if ((skipped_bits & (CSS_PSEUDO_CLASS_HOVER | CSS_PSEUDO_CLASS_ACTIVE)) && !match_context->StrictMode())
+		{
+			context_elm->CacheLinkState(match_context->Document());
+			if (!context_elm->IsLink())
+				skipped_bits &= ~(CSS_PSEUDO_CLASS_HOVER | CSS_PSEUDO_CLASS_ACTIVE);
+		}
+
+		if (skipped_bits && match_context->MarkPseudoBits() && !match_context->PseudoElm())
+		{
+			context_elm->HtmlElement()->SetCheckForPseudo(skipped_bits);
+			g_css_pseudo_stack->AddHasPseudo(skipped_bits);
+		}
+	}
+
+	if (oom)
+		match_context->Document()->GetHLDocProfile()->SetIsOutOfMemory(TRUE);
+#endif // CSS_RULE_BUCKETS
+
 	rule_lists[list_count] = NULL;
 
 	if (list_count > 0)
 	{
 		CSS_StyleRule* current = NULL;
 		BOOL prefetch = match_context->PrefetchMode();
+#ifdef CSS_ANCESTOR_FILTER
+		const CSS_AncestorFilter* ancestor_filter = match_context->GetAncestorFilter();
+#endif // CSS_ANCESTOR_FILTER
 
 		RuleElmIterator iter(match_context->Document(), rule_lists, match_context->MediaType());
 		CSS_RuleElm* rule_elm;
@@ -1000,6 +1139,18 @@ BOOL CSS::GetProperties(CSS_MatchContext* match_context,
 
 			CSS_Selector::MatchResult match(CSS_Selector::NO_MATCH);
 
+#ifdef CSS_ANCESTOR_FILTER
+			if (ancestor_filter)
+			{
+				m_ancestor_filter_checks++;
+				if (!css_sel->MayMatchAncestors(ancestor_filter))
+				{
+					m_ancestor_filter_rejects++;
+					continue;
+				}
+			}
+#endif // CSS_ANCESTOR_FILTER
+
 			if ((!css_sel->HasClassInTarget() || context_elm->GetClassAttribute()) &&
 				(!css_sel->HasIdInTarget() || context_elm->GetIdAttribute()))
 			{
@@ -2519,6 +2670,114 @@ OP_STATUS CSS::InsertFontFaceRule(CSS_FontfaceRule* font_rule)
 	return OpStatus::OK;
 }
 
+BOOL CSS::HasStyleRules() const
+{
+	if (m_type_rules.GetCount() > 0 ||
+		m_id_rules.GetCount() > 0 ||
+		m_class_rules.GetCount() > 0)
+		return TRUE;
+
+#ifdef CSS_RULE_BUCKETS
+	if (m_attr_rules.GetCount() > 0 ||
+		m_dynamic_rules.GetCount() > 0)
+		return TRUE;
+#endif // CSS_RULE_BUCKETS
+
+	return FALSE;
+}
+
+#ifdef CSS_RULE_BUCKETS
+
+/** @return The CSSPseudoClassType bit for :hover, :active and :focus,
+			otherwise 0. */
+static int
+GetDynamicPseudoBit(unsigned short pseudo_class)
+{
+	switch (pseudo_class)
+	{
+	case PSEUDO_CLASS_HOVER:
+		return CSS_PSEUDO_CLASS_HOVER;
+	case PSEUDO_CLASS_ACTIVE:
+		return CSS_PSEUDO_CLASS_ACTIVE;
+	case PSEUDO_CLASS_FOCUS:
+		return CSS_PSEUDO_CLASS_FOCUS;
+	default:
+		return 0;
+	}
+}
+
+#endif // CSS_RULE_BUCKETS
+
+OpINT32HashTable<CSS::CSS_RuleElmList>& CSS::GetRuleTable(CSS_Selector* sel, UINT32& key)
+{
+	key = sel->GetTargetElmType();
+
+#ifdef CSS_RULE_BUCKETS
+	if (key == Markup::HTE_ANY)
+	{
+		for (CSS_SelectorAttribute* sel_attr = sel->FirstSelector()->GetFirstAttr(); sel_attr; sel_attr = sel_attr->Suc())
+		{
+			if (sel_attr->IsNegated())
+				continue;
+
+			switch (sel_attr->GetType())
+			{
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_EQUAL:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_INCLUDES:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_DEFINED:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_DASHMATCH:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_PREFIXMATCH:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_SUFFIXMATCH:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_SUBSTRMATCH:
+				{
+					/* Id and class attributes are matched against the values
+					   cached by the match context, which need not come from an
+					   attribute with that name. */
+
+					unsigned short attr = sel_attr->GetAttr();
+					if (sel_attr->GetNsIdx() == NS_IDX_DEFAULT && attr != Markup::HA_ID && attr != Markup::HA_CLASS)
+					{
+						const uni_char* name = attr == Markup::HA_XML ? sel_attr->GetValue() : HTM_Lex::GetAttrString(static_cast<Markup::AttrType>(attr));
+						if (name && *name)
+						{
+							key = static_cast<UINT32>(djb2hash_nocase(name));
+							return m_attr_rules;
+						}
+					}
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		/* GetProperties only sets the pseudo bits of elements not in the
+		   state, without matching. That is only correct when nothing else
+		   in the selector can fail, so only a bare :hover, :active or
+		   :focus is hashed on the dynamic pseudo class. */
+
+		CSS_SimpleSelector* simple_sel = sel->FirstSelector();
+		CSS_SelectorAttribute* sel_attr = simple_sel->GetFirstAttr();
+
+		if (!simple_sel->Suc() && sel->GetPseudoElm() == ELM_NOT_PSEUDO &&
+			simple_sel->GetNameSpaceIdx() == NS_IDX_ANY_NAMESPACE && !simple_sel->GetElmName() &&
+			sel_attr && !sel_attr->Suc() && !sel_attr->IsNegated() &&
+			sel_attr->GetType() == CSS_SEL_ATTR_TYPE_PSEUDO_CLASS)
+		{
+			int dynamic_bit = GetDynamicPseudoBit(sel_attr->GetPseudoClass());
+			if (dynamic_bit)
+			{
+				key = static_cast<UINT32>(dynamic_bit);
+				return m_dynamic_rules;
+			}
+		}
+	}
+#endif // CSS_RULE_BUCKETS
+
+	return m_type_rules;
+}
+
 OP_STATUS CSS::AddRule(HLDocProfile* hld_prof, CSS_Rule* rule, CSS_ConditionalRule* current_conditional)
 {
 	OP_STATUS stat = OpStatus::OK;
@@ -2589,14 +2848,15 @@ OP_STATUS CSS::AddRule(HLDocProfile* hld_prof, CSS_Rule* rule, CSS_ConditionalRu
 			}
 			else
 			{
-				UINT32 idx = sel->GetTargetElmType();
+				UINT32 idx;
+				OpINT32HashTable<CSS_RuleElmList>& rule_table = GetRuleTable(sel, idx);
 				CSS_RuleElmList* rule_list;
-				if (OpStatus::IsError(m_type_rules.GetData(idx, &rule_list)))
+				if (OpStatus::IsError(rule_table.GetData(idx, &rule_list)))
 				{
 					rule_list = OP_NEW(CSS_RuleElmList, ());
 					if (rule_list)
 					{
-						stat = m_type_rules.Add(idx, rule_list);
+						stat = rule_table.Add(idx, rule_list);
 						if (stat != OpStatus::OK)
 						{
 							OP_DELETE(rule_list);
@@ -2614,6 +2874,11 @@ OP_STATUS CSS::AddRule(HLDocProfile* hld_prof, CSS_Rule* rule, CSS_ConditionalRu
 			if (m_succ_adj < succ_adj)
 				m_succ_adj = succ_adj;
 
+#ifdef CSS_INVALIDATION_SETS
+			if (OpStatus::IsMemoryError(m_invalidation_set.AddSelector(sel)))
+				stat = OpStatus::ERR_NO_MEMORY;
+#endif // CSS_INVALIDATION_SETS
+
 #ifdef DOM_FULLSCREEN_MODE
 			if (sel->HasComplexFullscreen())
 				m_complex_fullscreen = TRUE;
@@ -2785,14 +3050,15 @@ void CSS::RuleRemoved(HLDocProfile* hld_prof, CSS_Rule* rule)
 				}
 				else
 				{
-					UINT32 idx = sel->GetTargetElmType();
+					UINT32 idx;
+					OpINT32HashTable<CSS_RuleElmList>& rule_table = GetRuleTable(sel, idx);
 					CSS_RuleElmList* rule_list;
-					if (OpStatus::IsSuccess(m_type_rules.GetData(idx, &rule_list)))
+					if (OpStatus::IsSuccess(rule_table.GetData(idx, &rule_list)))
 					{
 						rule_list->DeleteRule(rule);
 						if (!rule_list->First())
 						{
-							m_type_rules.Remove(idx, &rule_list);
+							rule_table.Remove(idx, &rule_list);
 							OP_DELETE(rule_list);
 						}
 					}
@@ -2958,14 +3224,15 @@ CSS::RuleInserted(HLDocProfile* hld_prof, CSS_Rule* rule)
 				}
 				else
 				{
-					UINT32 idx = sel->GetTargetElmType();
+					UINT32 idx;
+					OpINT32HashTable<CSS_RuleElmList>& rule_table = GetRuleTable(sel, idx);
 					CSS_RuleElmList* rule_list;
-					if (OpStatus::IsError(m_type_rules.GetData(idx, &rule_list)))
+					if (OpStatus::IsError(rule_table.GetData(idx, &rule_list)))
 					{
 						rule_list = OP_NEW(CSS_RuleElmList, ());
 						if (rule_list)
 						{
-							stat = m_type_rules.Add(idx, rule_list);
+							stat = rule_table.Add(idx, rule_list);
 							if (stat != OpStatus::OK)
 							{
 								OP_DELETE(rule_list);
@@ -2984,6 +3251,10 @@ CSS::RuleInserted(HLDocProfile* hld_prof, CSS_Rule* rule)
 				if (m_succ_adj < succ_adj)
 					m_succ_adj = succ_adj;
 
+#ifdef CSS_INVALIDATION_SETS
+				RETURN_IF_MEMORY_ERROR(m_invalidation_set.AddSelector(sel));
+#endif // CSS_INVALIDATION_SETS
+
 #ifdef DOM_FULLSCREEN_MODE
 				if (sel->HasComplexFullscreen())
 					m_complex_fullscreen = TRUE;
@@ -80,7 +80,10 @@ void CSSCollection::AddCollectionElement(CSSCollectionElement* new_elm, BOOL com
 	while (elm)
 	{
 		HTML_Element* he = elm->GetHtmlElement();
-		if (he && ((is_import && he->IsAncestorOf(new_he)) || new_he->Precedes(he)))
+		/* Imports go before the sheet importing them. They may be added
+		   first, when the parent sheet is parsed in slices, so a sheet
+		   must not be put in front of its own imports. */
+		if (he && ((is_import && he->IsAncestorOf(new_he)) || (new_he->Precedes(he) && !new_he->IsAncestorOf(he))))
 		{
 			new_elm->Precede(elm);
 			break;
@@ -192,6 +195,47 @@ void CSSCollection::CommitAdded()
 	OP_ASSERT(m_pending_elements.Empty());
 }
 
+#ifdef CSS_SLICED_PARSING
+
+OP_STATUS CSSCollection::StartSlicedParsing(HTML_Element* elm, CSS* css, DataSrc* src_head, unsigned start_line_number)
+{
+	if (!m_doc || !CSS_SlicedParser::WantsSlicing(src_head))
+		return OpStatus::ERR;
+
+	CancelSlicedParsing(elm);
+
+	CSS_SlicedParser* parser;
+	RETURN_IF_ERROR(CSS_SlicedParser::Create(parser, this, elm, css, src_head, start_line_number));
+
+	parser->Into(&m_sliced_parsers);
+
+	return OpStatus::OK;
+}
+
+void CSSCollection::CancelSlicedParsing(HTML_Element* elm)
+{
+	for (CSS_SlicedParser* parser = m_sliced_parsers.First(); parser; parser = parser->Suc())
+		if (parser->GetHtmlElement() == elm)
+		{
+			if (parser->IsWaitingForStyles() && !m_doc->IsBeingFreed())
+				m_doc->DecWaitForStyles();
+
+			OP_DELETE(parser);
+			return;
+		}
+}
+
+BOOL CSSCollection::IsSlicedParsing(HTML_Element* elm)
+{
+	for (CSS_SlicedParser* parser = m_sliced_parsers.First(); parser; parser = parser->Suc())
+		if (parser->GetHtmlElement() == elm)
+			return TRUE;
+
+	return FALSE;
+}
+
+#endif // CSS_SLICED_PARSING
+
 void CSSCollection::StyleChanged(unsigned int changes)
 {
 	if (m_doc->IsBeingFreed())
@@ -1166,6 +1210,120 @@ int CSSCollection::GetSuccessiveAdjacent() const
 	return max_successive_adj;
 }
 
+#ifdef CSS_INVALIDATION_SETS
+
+void
+CSSCollection::BeginAttributeChange(HTML_Element* element, short attr, NS_Type attr_ns)
+{
+	m_attr_change_elm = NULL;
+
+	if (attr_ns == NS_HTML && element->GetNsType() == NS_HTML && (attr == Markup::HA_CLASS || attr == Markup::HA_ID))
+	{
+		m_attr_change_elm = element;
+		m_attr_change_attr = attr;
+		m_attr_change_flags = GetValueInvalidation(element, attr);
+	}
+}
+
+int
+CSSCollection::GetAttributeInvalidation(HTML_Element* element, short attr, NS_Type attr_ns)
+{
+	if (attr_ns != NS_HTML || element->GetNsType() != NS_HTML)
+		return INVALIDATE_ALL;
+
+	int flags;
+
+	if (attr == Markup::HA_CLASS || attr == Markup::HA_ID)
+	{
+		/* Without the flags for the old value, anything may be affected. */
+		if (element != m_attr_change_elm || attr != m_attr_change_attr)
+			return INVALIDATE_ALL;
+
+		flags = m_attr_change_flags | GetValueInvalidation(element, attr);
+	}
+	else if (attr == Markup::HA_XML && !m_doc->GetHLDocProfile()->IsXml())
+		/* Unknown attributes may be declared as ids in xml documents. */
+		flags = GetValueInvalidation(element, attr);
+	else
+		return INVALIDATE_ALL;
+
+	return flags | INVALIDATE_SELF;
+}
+
+static int
+GetStyleSheetInvalidation(CSS* css, short attr, const ClassAttribute* class_attr, const uni_char* id)
+{
+	const CSS_InvalidationSet& invalidation_set = css->GetInvalidationSet();
+	int flags = invalidation_set.GetAttrFlags(attr);
+
+	if (class_attr)
+	{
+		const ReferencedHTMLClass* class_ref;
+		for (unsigned int i = 0; (class_ref = class_attr->GetClassRef(i)) != NULL; i++)
+			flags |= invalidation_set.GetClassFlags(class_ref->GetString());
+	}
+
+	if (id && *id)
+		flags |= invalidation_set.GetIdFlags(id);
+
+	return flags;
+}
+
+/** The flags from css and all its imports. */
+static int
+GetStyleSheetTreeInvalidation(CSS* css, short attr, const ClassAttribute* class_attr, const uni_char* id)
+{
+	int flags = 0;
+	for (; css; css = css->GetNextImport(FALSE))
+		flags |= GetStyleSheetInvalidation(css, attr, class_attr, id);
+	return flags;
+}
+
+int
+CSSCollection::GetValueInvalidation(HTML_Element* element, short attr)
+{
+	const ClassAttribute* class_attr = attr == Markup::HA_CLASS ? element->GetClassAttribute() : NULL;
+	const uni_char* id = attr == Markup::HA_ID ? element->GetId() : NULL;
+	int flags = 0;
+
+	/* m_stylesheet_array is only regenerated when properties are loaded,
+	   and may refer to author stylesheets that have been removed since.
+	   The author stylesheets, including imports, are taken from the
+	   element list, and the others from where the array gets them. Media
+	   and preferences are not checked, which only gives more flags. */
+
+	for (CSSCollectionElement* elm = m_element_list.First(); elm; elm = elm->Suc())
+		if (elm->IsStyleSheet())
+		{
+			CSS* css = static_cast<CSS*>(elm);
+			if (css->IsEnabled())
+				flags |= GetStyleSheetInvalidation(css, attr, class_attr, id);
+		}
+
+	unsigned int local_count = CSSManager::FirstUserStyle;
+#ifdef LOCAL_CSS_FILES_SUPPORT
+	local_count += g_pcfiles->GetLocalCSSCount();
+#endif // LOCAL_CSS_FILES_SUPPORT
+
+	for (unsigned int i = 0; i < local_count; i++)
+		flags |= GetStyleSheetTreeInvalidation(g_cssManager->GetCSS(i), attr, class_attr, id);
+
+#ifdef PREFS_HOSTOVERRIDE
+	for (unsigned int i = 0; i < CSSManager::FirstUserStyle; i++)
+		flags |= GetStyleSheetTreeInvalidation(m_host_overrides[i].css, attr, class_attr, id);
+#endif // PREFS_HOSTOVERRIDE
+
+#if defined LOCAL_CSS_FILES_SUPPORT && defined EXTENSION_SUPPORT
+	for (CSSManager::ExtensionStylesheet* extcss = g_cssManager->GetExtensionUserCSS(); extcss;
+		 extcss = reinterpret_cast<CSSManager::ExtensionStylesheet*>(extcss->Suc()))
+		flags |= GetStyleSheetTreeInvalidation(extcss->css, attr, class_attr, id);
+#endif // LOCAL_CSS_FILES_SUPPORT && EXTENSION_SUPPORT
+
+	return flags;
+}
+
+#endif // CSS_INVALIDATION_SETS
+
 CSSCollection::Iterator::Iterator(CSSCollection* coll, Type type)
 {
 	OP_ASSERT(coll);
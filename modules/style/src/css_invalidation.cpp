@@ -0,0 +1,133 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 1995-2011 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#ifdef CSS_INVALIDATION_SETS
+
+#include "modules/style/src/css_invalidation.h"
+#include "modules/style/src/css_selector.h"
+#include "modules/style/css_collection.h"
+#include "modules/logdoc/htm_lex.h"
+#include "modules/util/hash.h"
+
+OP_STATUS
+CSS_InvalidationSet::AddSelector(CSS_Selector* sel)
+{
+	/* The rightmost simple selector matches the element itself. Each simple
+	   selector further left matches an element which has everything matched
+	   to its right either in its subtree, if its combinator is a descendant
+	   or child combinator, or in the subtrees of its following siblings. */
+
+	int scope = CSSCollection::INVALIDATE_SELF;
+
+	for (CSS_SimpleSelector* simple = sel->FirstSelector(); simple; simple = simple->Suc())
+	{
+		for (CSS_SelectorAttribute* sel_attr = simple->GetFirstAttr(); sel_attr; sel_attr = sel_attr->Suc())
+		{
+			switch (sel_attr->GetType())
+			{
+			case CSS_SEL_ATTR_TYPE_CLASS:
+				if (sel_attr->GetClass())
+					RETURN_IF_ERROR(AddFlags(MakeKey(KEY_CLASS, djb2hash_nocase(sel_attr->GetClass())), scope));
+				break;
+
+			case CSS_SEL_ATTR_TYPE_ID:
+				if (sel_attr->GetId())
+					RETURN_IF_ERROR(AddFlags(MakeKey(KEY_ID, djb2hash_nocase(sel_attr->GetId())), scope));
+				break;
+
+			case CSS_SEL_ATTR_TYPE_PSEUDO_CLASS:
+				/* Whether an element is the :target depends on its id. */
+				if (sel_attr->GetPseudoClass() == PSEUDO_CLASS_TARGET)
+					RETURN_IF_ERROR(AddFlags(MakeKey(KEY_ATTR, Markup::HA_ID), scope));
+				break;
+
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_EQUAL:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_INCLUDES:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_DEFINED:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_DASHMATCH:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_PREFIXMATCH:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_SUFFIXMATCH:
+			case CSS_SEL_ATTR_TYPE_HTMLATTR_SUBSTRMATCH:
+				{
+					short attr = sel_attr->GetAttr();
+					if (attr == Markup::HA_XML)
+					{
+						/* Attribute names are not resolved for xml stylesheets,
+						   so the name may still be one the html parser knows. */
+						m_unknown_attr_flags |= scope;
+						attr = HTM_Lex::GetAttrType(sel_attr->GetValue(), NS_HTML, FALSE);
+					}
+					if (attr != Markup::HA_XML)
+						RETURN_IF_ERROR(AddFlags(MakeKey(KEY_ATTR, attr), scope));
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		if (CSS_SimpleSelector* next = simple->Suc())
+		{
+			unsigned short combinator = next->GetCombinator();
+			if (combinator == CSS_COMBINATOR_ADJACENT || combinator == CSS_COMBINATOR_ADJACENT_INDIRECT)
+				scope = CSSCollection::INVALIDATE_SIBLINGS;
+			else
+				scope = CSSCollection::INVALIDATE_DESCENDANTS;
+		}
+	}
+
+	return OpStatus::OK;
+}
+
+int
+CSS_InvalidationSet::GetAttrFlags(short attr) const
+{
+	if (m_incomplete)
+		return CSSCollection::INVALIDATE_ALL;
+
+	if (attr == Markup::HA_XML)
+		return m_unknown_attr_flags;
+
+	UINT32 flags;
+	if (OpStatus::IsSuccess(m_flags.GetData(MakeKey(KEY_ATTR, attr), &flags)))
+		return flags;
+	return 0;
+}
+
+int
+CSS_InvalidationSet::GetFlags(KeyType type, const uni_char* str) const
+{
+	if (m_incomplete)
+		return CSSCollection::INVALIDATE_ALL;
+
+	UINT32 flags;
+	if (OpStatus::IsSuccess(m_flags.GetData(MakeKey(type, djb2hash_nocase(str)), &flags)))
+		return flags;
+	return 0;
+}
+
+OP_STATUS
+CSS_InvalidationSet::AddFlags(UINT32 key, int flags)
+{
+	UINT32 old_flags;
+	if (OpStatus::IsSuccess(m_flags.GetData(key, &old_flags)))
+	{
+		if ((old_flags | flags) == old_flags)
+			return OpStatus::OK;
+		flags |= old_flags;
+	}
+	OP_STATUS status = m_flags.Update(key, flags);
+	if (OpStatus::IsError(status))
+		m_incomplete = TRUE;
+	return status;
+}
+
+#endif // CSS_INVALIDATION_SETS
@@ -0,0 +1,82 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 1995-2011 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#ifndef CSS_INVALIDATION_H
+#define CSS_INVALIDATION_H
+
+#ifdef CSS_INVALIDATION_SETS
+
+#include "modules/util/OpHashTable.h"
+
+class CSS_Selector;
+
+/** Invalidation sets for a stylesheet.
+
+	For each class name, id and attribute used in the selectors of a
+	stylesheet, this records which elements relative to the element that
+	changes may need to have their properties reloaded. The values are the
+	CSSCollection::INVALIDATE_* flags.
+
+	Class names and ids are stored by their case-insensitive hash only. A hash
+	collision or a selector removed from the stylesheet can only make the set
+	report more than necessary, never less, so the sets are never shrunk. */
+class CSS_InvalidationSet
+{
+public:
+
+	CSS_InvalidationSet() : m_unknown_attr_flags(0), m_incomplete(FALSE) {}
+
+	/** Add the class names, ids and attributes of a selector to the sets.
+		If this fails, the sets report every change as affecting all
+		elements from then on.
+
+		@return OpStatus::ERR_NO_MEMORY on OOM, otherwise OpStatus::OK. */
+	OP_STATUS AddSelector(CSS_Selector* sel);
+
+	/** @return The flags for elements affected by adding or removing
+				the class cls on an element. */
+	int GetClassFlags(const uni_char* cls) const { return GetFlags(KEY_CLASS, cls); }
+
+	/** @return The flags for elements affected by an element getting
+				or losing the id. */
+	int GetIdFlags(const uni_char* id) const { return GetFlags(KEY_ID, id); }
+
+	/** @return The flags for elements affected by any change to an
+				attribute, regardless of its value. For Markup::HA_XML,
+				these are the flags for all attributes unknown to the
+				html parser. */
+	int GetAttrFlags(short attr) const;
+
+private:
+
+	enum KeyType
+	{
+		KEY_CLASS,
+		KEY_ID,
+		KEY_ATTR
+	};
+
+	static UINT32 MakeKey(KeyType type, UINT32 value) { return (value << 2) | type; }
+
+	int GetFlags(KeyType type, const uni_char* str) const;
+
+	OP_STATUS AddFlags(UINT32 key, int flags);
+
+	/** The flags for each class, id or attribute, keyed by MakeKey(). */
+	OpUINT32ToUINT32HashTable m_flags;
+
+	/** The flags for attribute selectors with names unknown to the html parser. */
+	int m_unknown_attr_flags;
+
+	/** TRUE if adding a selector failed on OOM. */
+	BOOL m_incomplete;
+};
+
+#endif // CSS_INVALIDATION_SETS
+
+#endif // CSS_INVALIDATION_H
@@ -12,6 +12,8 @@
 #include "modules/style/css_matchcontext.h"
 #include "modules/style/src/css_selector.h"
 #include "modules/logdoc/htm_elm.h"
+#include "modules/logdoc/class_attribute.h"
+#include "modules/util/hash.h"
 #include "modules/url/url_api.h"
 #include "modules/layout/cascade.h"
 #include "modules/layout/layoutprops.h"
@@ -110,6 +112,43 @@ CSS_MatchContextElm::RetrieveDynamicState()
 	m_packed.focused = m_html_elm->IsFocused();
 }
 
+#ifdef CSS_ANCESTOR_FILTER
+
+/* static */ UINT32
+CSS_AncestorFilter::StringHash(const uni_char* str)
+{
+	return static_cast<UINT32>(djb2hash_nocase(str));
+}
+
+void
+CSS_AncestorFilter::UpdateElement(CSS_MatchContextElm* context_elm, BOOL add)
+{
+	Markup::Type type = context_elm->Type();
+
+	if (type != Markup::HTE_UNKNOWN && context_elm->GetNsType() == NS_HTML)
+		Update(TypeHash(type), add);
+	else if (add)
+		m_foreign_count++;
+	else
+	{
+		OP_ASSERT(m_foreign_count > 0);
+		m_foreign_count--;
+	}
+
+	const uni_char* id = context_elm->GetIdAttribute();
+	if (id && *id)
+		Update(IdHash(id), add);
+
+	if (const ClassAttribute* class_attr = context_elm->GetClassAttribute())
+	{
+		const ReferencedHTMLClass* class_ref;
+		for (unsigned int i = 0; (class_ref = class_attr->GetClassRef(i)) != NULL; i++)
+			Update(ClassHash(class_ref->GetString()), add);
+	}
+}
+
+#endif // CSS_ANCESTOR_FILTER
+
 HTML_Element*
 CSS_MatchContext::Operation::Next(HTML_Element* current, BOOL skip_children) const
 {
@@ -193,6 +232,11 @@ void CSS_MatchContext::Begin(FramesDocument* doc, Mode mode, CSS_MediaType media
 	m_sibling->Reset();
 	m_nth_cache.Reset();
 
+#ifdef CSS_ANCESTOR_FILTER
+	if (mode == TOP_DOWN)
+		m_ancestor_filter.Reset();
+#endif // CSS_ANCESTOR_FILTER
+
 	/* Set up various flags and retrieve stylesheet list. */
 
 	const uni_char* hostname = doc->GetURL().GetAttribute(URL::KUniHostName).CStr();
@@ -246,6 +290,10 @@ CSS_MatchContext::InitTopDownRootInternal(HTML_Element* html_elm)
 		context_elm->Init(parent_context_elm, NULL, html_elm, m_fullscreen_elm, LinkState());
 		if (!parent_context_elm)
 			context_elm->SetIsRoot();
+#ifdef CSS_ANCESTOR_FILTER
+		else
+			m_ancestor_filter.PushElement(parent_context_elm);
+#endif // CSS_ANCESTOR_FILTER
 	}
 	return context_elm;
 }
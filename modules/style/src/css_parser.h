@@ -347,6 +347,9 @@ public:
 		For instance, if you try to insert a StyleRule before an ImportRule. */
 	BOOL AllowRuleset() { return m_allow_max == ALLOW_STYLE; }
 
+	/** Returns the minimum allow level reached by the rules parsed so far. */
+	AllowLevel GetAllowMin() const { return m_allow_min; }
+
 	/** Returns TRUE if the document is in strict mode. User and browser stylesheets are always in strict mode. */
 	BOOL StrictMode() { return (!m_hld_prof || m_hld_prof->IsInStrictMode()); }
 
@@ -1775,8 +1775,64 @@ void CSS_Selector::CalculateSpecificity()
 	if (c > 24) c = 24;
 	if (b > 24) b = 24;
 	m_packed.specificity = a*625 + b*25 + c;
+
+#ifdef CSS_ANCESTOR_FILTER
+	CalculateAncestorHashes();
+#endif // CSS_ANCESTOR_FILTER
 }
 
+#ifdef CSS_ANCESTOR_FILTER
+
+void CSS_Selector::CalculateAncestorHashes()
+{
+	int count = 0;
+	m_packed.ancestor_type_hashes = 0;
+
+	/* Ids and classes in the first pass, element types in the second. A simple
+	   selector with a descendant or child combinator always matches an
+	   ancestor of the element being matched, even if it's to the left of a
+	   sibling combinator. Negated selector attributes say nothing about the
+	   ancestors. */
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (CSS_SimpleSelector* sel = FirstSelector()->Suc(); sel && count < ANCESTOR_HASH_COUNT; sel = sel->Suc())
+		{
+			unsigned short combinator = sel->GetCombinator();
+			if (combinator != CSS_COMBINATOR_DESCENDANT && combinator != CSS_COMBINATOR_CHILD)
+				continue;
+
+			if (pass == 0)
+			{
+				for (CSS_SelectorAttribute* sel_attr = sel->GetFirstAttr(); sel_attr && count < ANCESTOR_HASH_COUNT; sel_attr = sel_attr->Suc())
+				{
+					if (sel_attr->IsNegated())
+						continue;
+
+					if (sel_attr->GetType() == CSS_SEL_ATTR_TYPE_ID && sel_attr->GetId())
+						m_ancestor_hashes[count++] = CSS_AncestorFilter::IdHash(sel_attr->GetId());
+					else if (sel_attr->GetType() == CSS_SEL_ATTR_TYPE_CLASS && sel_attr->GetClass())
+						m_ancestor_hashes[count++] = CSS_AncestorFilter::ClassHash(sel_attr->GetClass());
+				}
+			}
+			else
+			{
+				Markup::Type type = sel->GetElm();
+				if (type != Markup::HTE_ANY && type != Markup::HTE_UNKNOWN)
+				{
+					m_packed.ancestor_type_hashes |= 1 << count;
+					m_ancestor_hashes[count++] = CSS_AncestorFilter::TypeHash(type);
+				}
+			}
+		}
+	}
+
+	if (count < ANCESTOR_HASH_COUNT)
+		m_ancestor_hashes[count] = 0;
+}
+
+#endif // CSS_ANCESTOR_FILTER
+
 int CSS_Selector::GetMaxSuccessiveAdjacent()
 {
 	// maximum number of successive adjacent combinators in a selector
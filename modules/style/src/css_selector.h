@@ -366,7 +366,13 @@ public:
 		MATCH_SELECTION
 	};
 
-	CSS_Selector() { m_packed_init = 0; }
+	CSS_Selector()
+	{
+		m_packed_init = 0;
+#ifdef CSS_ANCESTOR_FILTER
+		m_ancestor_hashes[0] = 0;
+#endif // CSS_ANCESTOR_FILTER
+	}
 	virtual ~CSS_Selector() { m_simple_selectors.Clear(); }
 
 	void AddSimpleSelector(CSS_SimpleSelector* sel, unsigned short combinator = CSS_COMBINATOR_DESCENDANT);
@@ -410,6 +416,30 @@ public:
 
 	MatchResult Match(CSS_MatchContext* context, CSS_MatchContextElm* context_elm) const;
 
+#ifdef CSS_ANCESTOR_FILTER
+	/** Check the ancestor hashes of this selector against an ancestor filter.
+
+		@param filter The filter for the ancestors of the element to be matched.
+		@return FALSE if the selector can not match because one of the simple
+				selectors that must match an ancestor has a type, id, or
+				class which none of the ancestors have. TRUE otherwise. */
+
+	BOOL MayMatchAncestors(const CSS_AncestorFilter* filter) const
+	{
+		for (int i = 0; i < ANCESTOR_HASH_COUNT && m_ancestor_hashes[i]; i++)
+			if (m_packed.ancestor_type_hashes & (1 << i))
+			{
+				if (!filter->MayContainType(m_ancestor_hashes[i]))
+					return FALSE;
+			}
+			else
+				if (!filter->MayContain(m_ancestor_hashes[i]))
+					return FALSE;
+
+		return TRUE;
+	}
+#endif // CSS_ANCESTOR_FILTER
+
 	Markup::Type GetTargetElmType() { return static_cast<CSS_SimpleSelector*>(m_simple_selectors.First())->GetElm(); }
 
 	int GetMaxSuccessiveAdjacent();
@@ -458,6 +488,19 @@ private:
 	void SetHasSingleClassInTarget() { m_packed.has_single_class_in_target = 1; }
 	void SetHasComplexFullscreen() { m_packed.complex_fullscreen = 1; }
 
+#ifdef CSS_ANCESTOR_FILTER
+	/** Collect the hashes checked by MayMatchAncestors. Called from CalculateSpecificity. */
+	void CalculateAncestorHashes();
+
+	/** Max number of ancestor hashes stored per selector. */
+	enum { ANCESTOR_HASH_COUNT = 4 };
+
+	/** Hashes for types, ids and classes in simple selectors to the left of
+		descendant and child combinators. Ids and classes first since they
+		are more selective. Terminated by 0 if less than ANCESTOR_HASH_COUNT. */
+	UINT32 m_ancestor_hashes[ANCESTOR_HASH_COUNT];
+#endif // CSS_ANCESTOR_FILTER
+
 	Head m_simple_selectors;
 
 	union
@@ -474,7 +517,9 @@ private:
 			unsigned int match_prefetch:1;
 			unsigned int complex_fullscreen:1;
 			unsigned int dont_serialize:1;
-		} m_packed; /* 27 bits in use. */
+			/** Bit i is set if m_ancestor_hashes[i] is an element type hash. */
+			unsigned int ancestor_type_hashes:4;
+		} m_packed; /* 31 bits in use. */
 		unsigned int m_packed_init;
 	};
 };
@@ -0,0 +1,287 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 1995-2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#ifdef CSS_SLICED_PARSING
+
+#include "modules/style/src/css_sliced_parser.h"
+#include "modules/style/css.h"
+#include "modules/style/css_collection.h"
+#include "modules/style/src/css_buffer.h"
+#include "modules/style/src/css_parser.h"
+#include "modules/doc/frm_doc.h"
+#include "modules/logdoc/datasrcelm.h"
+#include "modules/logdoc/htm_elm.h"
+
+/* static */ BOOL
+CSS_SlicedParser::WantsSlicing(DataSrc* src_head)
+{
+	unsigned length = 0;
+
+	for (DataSrcElm* src_elm = src_head->First(); src_elm; src_elm = src_elm->Suc())
+	{
+		length += src_elm->GetSrcLen();
+		if (length > CSS_SLICED_PARSING_SLICE_SIZE)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* static */ OP_STATUS
+CSS_SlicedParser::Create(CSS_SlicedParser*& parser, CSSCollection* coll, HTML_Element* elm, CSS* css, DataSrc* src_head, unsigned start_line_number)
+{
+	parser = OP_NEW(CSS_SlicedParser, (coll, elm, css, start_line_number));
+	if (!parser)
+		return OpStatus::ERR_NO_MEMORY;
+
+	DataSrcElm* src_elm;
+
+	for (src_elm = src_head->First(); src_elm; src_elm = src_elm->Suc())
+		parser->m_src_len += src_elm->GetSrcLen();
+
+	parser->m_src = OP_NEWA(uni_char, parser->m_src_len);
+
+	OP_STATUS stat = parser->m_src ? OpStatus::OK : OpStatus::ERR_NO_MEMORY;
+
+	if (OpStatus::IsSuccess(stat))
+	{
+		uni_char* dst = parser->m_src;
+
+		for (src_elm = src_head->First(); src_elm; src_elm = src_elm->Suc())
+		{
+			op_memcpy(dst, src_elm->GetSrc(), src_elm->GetSrcLen() * sizeof(uni_char));
+			dst += src_elm->GetSrcLen();
+		}
+
+		stat = parser->m_mh->SetCallBack(parser, MSG_CSS_PARSE_SLICE, (MH_PARAM_1) parser);
+
+		if (OpStatus::IsSuccess(stat))
+			stat = parser->PostSliceMessage();
+	}
+
+	if (OpStatus::IsError(stat))
+	{
+		/* The caller keeps the stylesheet. */
+
+		parser->m_css = NULL;
+		OP_DELETE(parser);
+		parser = NULL;
+		return stat;
+	}
+
+	FramesDocument* doc = coll->GetFramesDocument();
+
+	doc->IncWaitForStyles();
+	parser->m_waiting_for_styles = doc->IsWaitingForStyles();
+
+	return OpStatus::OK;
+}
+
+CSS_SlicedParser::CSS_SlicedParser(CSSCollection* coll, HTML_Element* elm, CSS* css, unsigned start_line_number)
+	: m_coll(coll),
+	  m_mh(coll->GetFramesDocument()->GetMessageHandler()),
+	  m_elm(elm),
+	  m_css(css),
+	  m_src(NULL),
+	  m_src_len(0),
+	  m_pos(0),
+	  m_line_number(start_line_number),
+	  m_allow_level(CSS_Parser::ALLOW_CHARSET),
+	  m_waiting_for_styles(FALSE)
+{
+}
+
+/* virtual */
+CSS_SlicedParser::~CSS_SlicedParser()
+{
+	Out();
+
+	m_mh->UnsetCallBacks(this);
+
+	OP_DELETE(m_css);
+	OP_DELETEA(m_src);
+}
+
+unsigned
+CSS_SlicedParser::FindSliceEnd(unsigned& newlines) const
+{
+	/* Only the tokens that may hide or change the nesting of blocks matter
+	   here: comments, strings and escapes. A top-level rule ends with the
+	   '}' closing its block, or with a ';' outside of any block for
+	   statements like @import. */
+
+	unsigned min_end = m_pos + CSS_SLICED_PARSING_SLICE_SIZE;
+	int depth = 0;
+	uni_char quote = 0;
+	BOOL in_comment = FALSE;
+
+	newlines = 0;
+
+	for (unsigned i = m_pos; i < m_src_len; i++)
+	{
+		uni_char c = m_src[i];
+
+		if (c == '\n')
+			newlines++;
+
+		if (in_comment)
+		{
+			if (c == '*' && i + 1 < m_src_len && m_src[i + 1] == '/')
+			{
+				in_comment = FALSE;
+				i++;
+			}
+		}
+		else if (c == '\\')
+		{
+			if (i + 1 < m_src_len && m_src[i + 1] == '\n')
+				newlines++;
+			i++;
+		}
+		else if (quote)
+		{
+			if (c == quote || c == '\n')
+				quote = 0;
+		}
+		else
+			switch (c)
+			{
+			case '"':
+			case '\'':
+				quote = c;
+				break;
+
+			case '/':
+				if (i + 1 < m_src_len && m_src[i + 1] == '*')
+				{
+					in_comment = TRUE;
+					i++;
+				}
+				break;
+
+			case '{':
+				depth++;
+				break;
+
+			case '}':
+				if (depth > 0 && --depth == 0 && i + 1 >= min_end)
+					return i + 1;
+				break;
+
+			case ';':
+				if (depth == 0 && i + 1 >= min_end)
+					return i + 1;
+				break;
+			}
+	}
+
+	return m_src_len;
+}
+
+OP_STATUS
+CSS_SlicedParser::ParseSlice()
+{
+	unsigned newlines;
+	unsigned end = FindSliceEnd(newlines);
+
+	CSS_Buffer css_buf;
+
+	if (!css_buf.AllocBufferArrays(1))
+		return OpStatus::ERR_NO_MEMORY;
+
+	css_buf.AddBuffer(m_src + m_pos, end - m_pos);
+
+	CSS_Parser* parser = OP_NEW(CSS_Parser, (m_css, &css_buf, m_css->GetBaseURL(), m_coll->GetFramesDocument()->GetHLDocProfile(), m_line_number));
+	if (!parser)
+		return OpStatus::ERR_NO_MEMORY;
+
+	/* @charset, @import and @namespace are only allowed before the rules
+	   of the previous slices. */
+
+	parser->SetAllowLevel(static_cast<CSS_Parser::AllowLevel>(m_allow_level));
+
+	CSS_PARSE_STATUS stat;
+	TRAP(stat, parser->ParseL());
+
+	m_allow_level = parser->GetAllowMin();
+
+	OP_DELETE(parser);
+
+	m_pos = end;
+	m_line_number += newlines;
+
+	return OpStatus::IsMemoryError(stat) ? stat : OpStatus::OK;
+}
+
+OP_STATUS
+CSS_SlicedParser::PostSliceMessage()
+{
+	if (!m_mh->PostMessage(MSG_CSS_PARSE_SLICE, (MH_PARAM_1) this, 0))
+		return OpStatus::ERR_NO_MEMORY;
+
+	return OpStatus::OK;
+}
+
+/* virtual */ void
+CSS_SlicedParser::HandleCallback(OpMessage msg, MH_PARAM_1 par1, MH_PARAM_2 par2)
+{
+	OP_ASSERT(msg == MSG_CSS_PARSE_SLICE);
+
+	OP_STATUS stat = ParseSlice();
+
+	if (OpStatus::IsSuccess(stat) && m_pos < m_src_len)
+	{
+		stat = PostSliceMessage();
+		if (OpStatus::IsSuccess(stat))
+			return;
+	}
+
+	Finish(stat);
+}
+
+void
+CSS_SlicedParser::Finish(OP_STATUS stat)
+{
+	FramesDocument* doc = m_coll->GetFramesDocument();
+	HTML_Element* elm = m_elm;
+	CSS* css = m_css;
+	BOOL waiting_for_styles = m_waiting_for_styles;
+
+	/* Adding the stylesheet may load it again, so this parser must be gone
+	   before that. */
+
+	m_css = NULL;
+	OP_DELETE(this);
+
+	HTML_Element::DocumentContext context(doc);
+
+	/* CSS::Load does this before parsing; the media attribute may have
+	   changed while slicing, so do it when the sheet is adopted. */
+	if (OpStatus::IsSuccess(stat))
+		stat = css->MediaAttrChanged();
+
+	stat = elm->AddParsedCSS(context, css, TRUE, stat);
+
+	if (elm->HasSpecialAttr(ATTR_STYLESHEET_DISABLED, SpecialNs::NS_LOGDOC))
+		elm->SetStylesheetDisabled(doc, elm->GetSpecialBoolAttr(ATTR_STYLESHEET_DISABLED, SpecialNs::NS_LOGDOC));
+
+	/* FramesDocument::HandleInlineDataLoaded() skipped the load event while
+	   the sheet was being parsed. */
+	if (OpStatus::IsMemoryError(doc->HandleEvent(ONLOAD, NULL, elm, SHIFTKEY_NONE)))
+		stat = OpStatus::ERR_NO_MEMORY;
+
+	if (waiting_for_styles)
+		doc->DecWaitForStyles();
+
+	if (OpStatus::IsMemoryError(stat))
+		g_memory_manager->RaiseCondition(stat);
+}
+
+#endif // CSS_SLICED_PARSING
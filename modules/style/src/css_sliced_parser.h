@@ -0,0 +1,155 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 1995-2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#ifndef CSS_SLICED_PARSER_H
+#define CSS_SLICED_PARSER_H
+
+#ifdef CSS_SLICED_PARSING
+
+#include "modules/hardcore/mh/messobj.h"
+#include "modules/util/simset.h"
+
+class CSS;
+class CSSCollection;
+class DataSrc;
+class HTML_Element;
+class MessageHandler;
+
+/** Parses a large external stylesheet in slices from the message loop.
+
+	The stylesheet source is split into slices at the ends of top-level rules
+	and each slice is parsed by a separate CSS_Parser run, one slice per
+	MSG_CSS_PARSE_SLICE message, so that html parsing, scripts and painting
+	get to run in between. The rules are added to a CSS object which is not
+	part of the CSSCollection while parsing. When the last slice is parsed,
+	the stylesheet is handed back to its link element, which adds it to the
+	collection just like a stylesheet parsed in one go.
+
+	Core has no portable way of running the parser on another thread (the
+	parser allocates from, and registers with, document and global state
+	that is only safe to touch from the main thread), so slicing the work on
+	the main thread is what keeps it responsive.
+
+	Sliced parsers are owned by the CSSCollection of the document. */
+
+class CSS_SlicedParser
+	: public ListElement<CSS_SlicedParser>,
+	  public MessageObject
+{
+public:
+
+	/** Check if a stylesheet is large enough to be parsed in slices.
+
+		@param src_head The source of the stylesheet.
+		@return TRUE if the source is larger than one slice. */
+
+	static BOOL WantsSlicing(DataSrc* src_head);
+
+	/** Create a sliced parser and post the message for the first slice.
+
+		@param[out] parser Set to the new parser.
+		@param coll The collection the stylesheet will be added to.
+		@param elm The link element of the stylesheet.
+		@param css The stylesheet to parse into. Owned by the parser, unless
+		creating it fails.
+		@param src_head The source of the stylesheet. Copied, so it may be
+		changed or deleted after this call.
+		@param start_line_number Line number of the first line of the source.
+		@return ERR_NO_MEMORY on OOM, ERR if the message couldn't be posted,
+		otherwise OK. */
+
+	static OP_STATUS Create(CSS_SlicedParser*& parser, CSSCollection* coll, HTML_Element* elm, CSS* css, DataSrc* src_head, unsigned start_line_number);
+
+	virtual ~CSS_SlicedParser();
+
+	/** @return The link element the stylesheet is parsed for. */
+
+	HTML_Element* GetHtmlElement() const { return m_elm; }
+
+	/** @return TRUE if the parser made the document wait for styles. */
+
+	BOOL IsWaitingForStyles() const { return m_waiting_for_styles; }
+
+	/** From MessageObject. */
+
+	virtual void HandleCallback(OpMessage msg, MH_PARAM_1 par1, MH_PARAM_2 par2);
+
+private:
+
+	CSS_SlicedParser(CSSCollection* coll, HTML_Element* elm, CSS* css, unsigned start_line_number);
+
+	/** Find the end of the slice starting at m_pos. A slice ends after
+		the first top-level rule ending at or beyond the slice size.
+
+		@param[out] newlines The number of line breaks in the slice.
+		@return The offset of the end of the slice. */
+
+	unsigned FindSliceEnd(unsigned& newlines) const;
+
+	/** Parse the next slice.
+
+		@return ERR_NO_MEMORY on OOM, otherwise OK. */
+
+	OP_STATUS ParseSlice();
+
+	/** Post the message for the next slice. */
+
+	OP_STATUS PostSliceMessage();
+
+	/** Hand the stylesheet back to the link element and delete this
+		parser.
+
+		@param stat The status of parsing. */
+
+	void Finish(OP_STATUS stat);
+
+	/** The collection that owns this parser. */
+
+	CSSCollection* m_coll;
+
+	/** The message handler of the document. */
+
+	MessageHandler* m_mh;
+
+	/** The link element of the stylesheet. */
+
+	HTML_Element* m_elm;
+
+	/** The stylesheet being parsed. */
+
+	CSS* m_css;
+
+	/** Copy of the stylesheet source. */
+
+	uni_char* m_src;
+
+	/** The length of m_src. */
+
+	unsigned m_src_len;
+
+	/** Offset of the next slice in m_src. */
+
+	unsigned m_pos;
+
+	/** Line number of the start of the next slice. */
+
+	unsigned m_line_number;
+
+	/** The minimum allow level (CSS_Parser::AllowLevel) reached by the
+		slices parsed so far. */
+
+	int m_allow_level;
+
+	/** TRUE if the document was made to wait for this stylesheet. */
+
+	BOOL m_waiting_for_styles;
+};
+
+#endif // CSS_SLICED_PARSING
+
+#endif // CSS_SLICED_PARSER_H
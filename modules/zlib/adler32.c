@@ -8,6 +8,7 @@
 #if defined USE_ZLIB && !defined USE_SYSTEM_ZLIB
 
 #include "modules/zlib/zlib.h"
+#include "modules/zlib/x86/zlib_x86.h"
 
 #define BASE 65521UL    /* largest prime smaller than 65536 */
 #define NMAX 5552
@@ -62,6 +63,16 @@
 /* ========================================================================= */
 uLong ZEXPORT adler32(uLong adler, const Bytef *buf, uInt len)
 {
+#ifdef ZLIB_USE_X86_SIMD
+    if (buf != Z_NULL && len >= ZLIB_X86_SIMD_MIN_LENGTH && zlib_x86_has_ssse3())
+        return adler32_ssse3(adler, buf, len);
+    return adler32_scalar(adler, buf, len);
+}
+
+/* ========================================================================= */
+unsigned long adler32_scalar(unsigned long adler, const unsigned char *buf, unsigned len)
+{
+#endif // ZLIB_USE_X86_SIMD
     unsigned long sum2;
 #ifndef ZLIB_REDUCE_FOOTPRINT
     unsigned n;
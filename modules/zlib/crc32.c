@@ -22,6 +22,7 @@
 #if defined USE_ZLIB && !defined USE_SYSTEM_ZLIB
 
 #include "modules/zlib/zutil.h"      /* for STDC and FAR definitions */
+#include "modules/zlib/x86/zlib_x86.h"
 
 #define local static
 
@@ -64,6 +65,22 @@ local void gf2_matrix_square OF((unsigned long *square, unsigned long *mat));
 /* ========================================================================= */
 unsigned long ZEXPORT crc32(unsigned long crc, const unsigned char FAR *buf, unsigned len)
 {
+#ifdef ZLIB_USE_X86_SIMD
+    /* fold whole 16 byte blocks, the tables take the rest */
+    if (buf != Z_NULL && len >= ZLIB_X86_SIMD_MIN_LENGTH && zlib_x86_has_pclmulqdq()) {
+        unsigned blocks = len & ~15U;
+        crc = crc32_pclmul(crc ^ 0xffffffffUL, buf, blocks) ^ 0xffffffffUL;
+        buf += blocks;
+        len -= blocks;
+        if (len == 0) return crc;
+    }
+    return crc32_scalar(crc, buf, len);
+}
+
+/* ========================================================================= */
+unsigned long crc32_scalar(unsigned long crc, const unsigned char FAR *buf, unsigned len)
+{
+#endif // ZLIB_USE_X86_SIMD
     if (buf == Z_NULL) return 0UL;
 #ifndef ZLIB_REDUCE_FOOTPRINT
 # ifndef OPERA_BIG_ENDIAN
@@ -73,6 +73,9 @@ void inflate_fast(z_streamp strm, unsigned start) /* start - inflate()'s startin
     struct inflate_state FAR *state;
     unsigned char FAR *in;      /* local strm->next_in */
     unsigned char FAR *last;    /* while in < last, enough input available */
+#ifdef ZLIB_USE_X86_SIMD
+    unsigned char FAR *last_wide; /* while in < last_wide, eight bytes available */
+#endif // ZLIB_USE_X86_SIMD
     unsigned char FAR *out;     /* local strm->next_out */
     unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
     unsigned char FAR *end;     /* while out < end, enough space available */
@@ -100,6 +103,9 @@ void inflate_fast(z_streamp strm, unsigned start) /* start - inflate()'s startin
     state = (struct inflate_state FAR *)strm->state;
     in = strm->next_in - OFF;
     last = in + (strm->avail_in - 5);
+#ifdef ZLIB_USE_X86_SIMD
+    last_wide = last - 2;
+#endif // ZLIB_USE_X86_SIMD
     out = strm->next_out - OFF;
     beg = out - (start - strm->avail_out);
     end = out + (strm->avail_out - 257);
@@ -120,6 +126,21 @@ void inflate_fast(z_streamp strm, unsigned start) /* start - inflate()'s startin
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
+#ifdef ZLIB_USE_X86_SIMD
+        /* x86 is little endian and loads unaligned words cheaply, so with a
+           64 bit hold, load eight bytes and keep the whole ones that
+           fit; that leaves at least 56 bits, more than a length/distance pair
+           uses, so none of the byte-wise refills below are needed */
+        if (sizeof(hold) == 8 && in < last_wide) {
+            unsigned long next;
+            op_memcpy(&next, in + OFF, sizeof(next));
+            hold |= next << bits;
+            in += (63 - bits) >> 3;
+            bits |= 56;
+            hold &= ~0UL >> (64 - bits);
+        }
+        else
+#endif // ZLIB_USE_X86_SIMD
         if (bits < 15) {
             hold += (unsigned long)(PUP(in)) << bits;
             bits += 8;
@@ -0,0 +1,90 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#if defined(USE_ZLIB) && !defined(USE_SYSTEM_ZLIB) && defined(ZLIB_USE_X86_SIMD)
+
+#include "modules/zlib/x86/zlib_x86.h"
+
+#include <tmmintrin.h>
+
+#define ADLER_BASE 65521	// Largest prime smaller than 65536.
+#define ADLER_NMAX 5552		// Most bytes that can be summed before the sums overflow.
+#define ADLER_BLOCK 32		// Bytes summed per iteration.
+
+// Over a block of 32 bytes s1 grows by the sum of the bytes, which
+// _mm_sad_epu8 gives, and s2 grows by 32 * s1 plus the bytes weighted
+// 32, 31, ..., 1, which _mm_maddubs_epi16 gives. The 32 * s1 terms are
+// collected in a separate sum and multiplied at the end of each chunk.
+extern "C" unsigned long adler32_ssse3(unsigned long adler, const unsigned char* buf, unsigned len)
+{
+	UINT32 s1 = adler & 0xffff;
+	UINT32 s2 = adler >> 16;
+
+	unsigned int blocks = len / ADLER_BLOCK;
+	len -= blocks * ADLER_BLOCK;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi16(1);
+	const __m128i taps_lo = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+	const __m128i taps_hi = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+
+	while (blocks)
+	{
+		unsigned int n = MIN(blocks, ADLER_NMAX / ADLER_BLOCK);
+		blocks -= n;
+
+		// The initial s1 is added to s2 once per block.
+		__m128i v_ps = _mm_cvtsi32_si128(s1 * n);
+		__m128i v_s2 = _mm_cvtsi32_si128(s2);
+		__m128i v_s1 = zero;
+
+		do
+		{
+			__m128i bytes_lo = _mm_loadu_si128((const __m128i*)buf);
+			__m128i bytes_hi = _mm_loadu_si128((const __m128i*)(buf + 16));
+
+			v_ps = _mm_add_epi32(v_ps, v_s1);
+
+			v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes_lo, zero));
+			v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes_lo, taps_lo), ones));
+			v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes_hi, zero));
+			v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes_hi, taps_hi), ones));
+
+			buf += ADLER_BLOCK;
+		}
+		while (--n);
+
+		v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+		// Add up the lanes.
+		v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+		v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+		v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+		v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		s1 = (s1 + _mm_cvtsi128_si32(v_s1)) % ADLER_BASE;
+		s2 = (UINT32)_mm_cvtsi128_si32(v_s2) % ADLER_BASE;
+	}
+
+	if (len)
+	{
+		while (len--)
+		{
+			s1 += *buf++;
+			s2 += s1;
+		}
+		s1 %= ADLER_BASE;
+		s2 %= ADLER_BASE;
+	}
+
+	return s1 | (s2 << 16);
+}
+
+#endif // USE_ZLIB && !USE_SYSTEM_ZLIB && ZLIB_USE_X86_SIMD
@@ -0,0 +1,83 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#if defined(USE_ZLIB) && !defined(USE_SYSTEM_ZLIB) && defined(ZLIB_USE_X86_SIMD)
+
+#include "modules/zlib/x86/zlib_x86.h"
+
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+// Multiplies the low quadword of x with the low quadword of k and the high
+// quadword of x with the high quadword of k, and adds both to y.
+static op_force_inline __m128i Fold(__m128i x, __m128i k, __m128i y)
+{
+	__m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+	__m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+	return _mm_xor_si128(_mm_xor_si128(lo, hi), y);
+}
+
+// The bit-reflected folding constants and Barrett reduction from "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Gopal et
+// al, Intel 2009), for the CRC-32 polynomial 0x04c11db7. Four lanes of 16
+// bytes are folded in parallel 64 bytes ahead, then folded into one lane,
+// which is reduced to 32 bits at the end.
+extern "C" unsigned long crc32_pclmul(unsigned long crc, const unsigned char* buf, unsigned len)
+{
+	OP_ASSERT(len >= 64 && len % 16 == 0);
+
+	// The 33 bit constants are split in 32 bit halves, low half first.
+	const __m128i k1k2 = _mm_setr_epi32(0x54442bd4, 0x1, (int)0xc6e41596, 0x1);	// 0x154442bd4, 0x1c6e41596
+	const __m128i k3k4 = _mm_setr_epi32(0x751997d0, 0x1, (int)0xccaa009e, 0x0);	// 0x1751997d0, 0x0ccaa009e
+	const __m128i k5k0 = _mm_setr_epi32(0x63cd6124, 0x1, 0x0, 0x0);			// 0x163cd6124, 0
+	const __m128i poly = _mm_setr_epi32((int)0xdb710641, 0x1, (int)0xf7011641, 0x1);	// P', mu
+	const __m128i low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	__m128i x1 = _mm_loadu_si128((const __m128i*)buf);
+	__m128i x2 = _mm_loadu_si128((const __m128i*)(buf + 16));
+	__m128i x3 = _mm_loadu_si128((const __m128i*)(buf + 32));
+	__m128i x4 = _mm_loadu_si128((const __m128i*)(buf + 48));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)(UINT32)crc));
+	buf += 64;
+	len -= 64;
+
+	for (; len >= 64; buf += 64, len -= 64)
+	{
+		x1 = Fold(x1, k1k2, _mm_loadu_si128((const __m128i*)buf));
+		x2 = Fold(x2, k1k2, _mm_loadu_si128((const __m128i*)(buf + 16)));
+		x3 = Fold(x3, k1k2, _mm_loadu_si128((const __m128i*)(buf + 32)));
+		x4 = Fold(x4, k1k2, _mm_loadu_si128((const __m128i*)(buf + 48)));
+	}
+
+	x1 = Fold(x1, k3k4, x2);
+	x1 = Fold(x1, k3k4, x3);
+	x1 = Fold(x1, k3k4, x4);
+
+	for (; len >= 16; buf += 16, len -= 16)
+		x1 = Fold(x1, k3k4, _mm_loadu_si128((const __m128i*)buf));
+
+	// Fold 128 bits to 64.
+	__m128i t = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), t);
+	t = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, low32);
+	x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k5k0, 0x00), t);
+
+	// Barrett reduce to 32 bits.
+	t = _mm_and_si128(x1, low32);
+	t = _mm_clmulepi64_si128(t, poly, 0x10);
+	t = _mm_and_si128(t, low32);
+	t = _mm_clmulepi64_si128(t, poly, 0x00);
+	x1 = _mm_xor_si128(x1, t);
+
+	return (UINT32)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+
+#endif // USE_ZLIB && !USE_SYSTEM_ZLIB && ZLIB_USE_X86_SIMD
@@ -0,0 +1,27 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#include "core/pch.h"
+
+#if defined(USE_ZLIB) && !defined(USE_SYSTEM_ZLIB) && defined(ZLIB_USE_X86_SIMD)
+
+#include "modules/zlib/x86/zlib_x86.h"
+#include "modules/pi/OpSystemInfo.h"
+
+int zlib_x86_has_ssse3(void)
+{
+	return (g_op_system_info->GetCPUFeatures() & OpSystemInfo::CPU_FEATURES_IA32_SSSE3) != 0;
+}
+
+int zlib_x86_has_pclmulqdq(void)
+{
+	const unsigned int needed = OpSystemInfo::CPU_FEATURES_IA32_SSE2 | OpSystemInfo::CPU_FEATURES_IA32_PCLMULQDQ;
+	return (g_op_system_info->GetCPUFeatures() & needed) == needed;
+}
+
+#endif // USE_ZLIB && !USE_SYSTEM_ZLIB && ZLIB_USE_X86_SIMD
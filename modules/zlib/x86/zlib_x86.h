@@ -0,0 +1,46 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+**
+** Copyright (C) 2012 Opera Software ASA.  All rights reserved.
+**
+** This file is part of the Opera web browser.  It may not be distributed
+** under any circumstances.
+*/
+
+#ifndef MODULES_ZLIB_X86_ZLIB_X86_H
+#define MODULES_ZLIB_X86_ZLIB_X86_H
+
+#ifdef ZLIB_USE_X86_SIMD
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/* Shorter buffers are left to the table driven and scalar versions, the
+   setup of the SIMD versions does not pay off for them. */
+#define ZLIB_X86_SIMD_MIN_LENGTH 64
+
+/* Run-time checks of the CPU features the SIMD versions need. They are in
+   a C++ file since the zlib sources can not include the pi headers. */
+int zlib_x86_has_ssse3(void);
+int zlib_x86_has_pclmulqdq(void);
+
+/* The table driven and scalar versions, which crc32() and adler32() use for
+   short buffers and when the CPU lacks the features. */
+unsigned long crc32_scalar(unsigned long crc, const unsigned char *buf, unsigned len);
+unsigned long adler32_scalar(unsigned long adler, const unsigned char *buf, unsigned len);
+
+/* Returns the Adler-32 of buf, continuing from adler. Any len is fine. */
+unsigned long adler32_ssse3(unsigned long adler, const unsigned char *buf, unsigned len);
+
+/* Folds buf into crc with carry-less multiplication and returns the result.
+   crc is the register value, that is the inverted CRC-32, both on entry and
+   on return. len must be a multiple of 16, and at least 64. */
+unsigned long crc32_pclmul(unsigned long crc, const unsigned char *buf, unsigned len);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // ZLIB_USE_X86_SIMD
+
+#endif // MODULES_ZLIB_X86_ZLIB_X86_H
@@ -1572,6 +1572,17 @@ unsigned int MacOpSystemInfo::GetCPUFeatures()
 		}
 	}
 
+	// There is no hw.optional entry for PCLMULQDQ, look in the cpuid feature string.
+	char cpu_features[1024];
+	size_t cpu_features_size = sizeof(cpu_features);
+	if (sysctlbyname("machdep.cpu.features", cpu_features, &cpu_features_size, NULL, 0) == 0 &&
+		cpu_features_size <= sizeof(cpu_features) && cpu_features_size > 0)
+	{
+		cpu_features[cpu_features_size - 1] = 0;
+		if (op_strstr(cpu_features, "PCLMULQDQ"))
+			capabilities |= CPU_FEATURES_IA32_PCLMULQDQ;
+	}
+
 	return capabilities;
 }
 #endif
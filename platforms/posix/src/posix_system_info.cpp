@@ -734,6 +734,7 @@ void PosixSystemInfo::InitCPUInfo()
                             else if (r->Equals("ssse3"))  cpu_features_tmp |= CPU_FEATURES_IA32_SSSE3;
                             else if (r->Equals("sse4_1")) cpu_features_tmp |= CPU_FEATURES_IA32_SSE4_1;
                             else if (r->Equals("sse4_2")) cpu_features_tmp |= CPU_FEATURES_IA32_SSE4_2;
+                            else if (r->Equals("pclmulqdq")) cpu_features_tmp |= CPU_FEATURES_IA32_PCLMULQDQ;
 #  endif // ARCHITECTURE_ARM || ARCHITECTURE_IA32
                         }
 
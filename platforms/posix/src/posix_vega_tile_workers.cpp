@@ -0,0 +1,164 @@
+/* -*- Mode: c++; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*-
+ *
+ * Copyright (C) 2012 Opera Software AS.  All rights reserved.
+ *
+ * This file is part of the Opera web browser.
+ * It may not be distributed under any circumstances.
+ */
+#include "core/pch.h"
+#ifdef POSIX_OK_VEGA_TILE_WORKERS
+
+#include "modules/libvega/vegatileworkers.h"
+#include "platforms/posix/posix_thread_util.h"
+
+#include <unistd.h>
+
+/** Run tile jobs on a pool of threads, one fewer than the number of online
+ * processors. The thread calling run() takes jobs too, so all processors are
+ * busy while a fill is rasterized.
+ *
+ * All members below m_cond are only used with m_cond grabbed.
+ */
+class PosixVEGATileWorkers : public VEGATileWorkers
+{
+public:
+	PosixVEGATileWorkers()
+		: m_threads(NULL), m_thread_count(0),
+		  m_jobs(NULL), m_job_count(0), m_next_job(0), m_unfinished(0),
+		  m_quit(false) {}
+	virtual ~PosixVEGATileWorkers();
+
+	/** Start the worker threads.
+	 * @param thread_count the number of threads to start.
+	 * @return OpStatus::OK if at least one thread was started,
+	 * OpStatus::ERR_NO_MEMORY on OOM, otherwise OpStatus::ERR. */
+	OP_STATUS Start(unsigned int thread_count);
+
+	virtual unsigned int getWorkerCount() { return m_thread_count + 1; }
+	virtual void run(VEGATileJob** jobs, unsigned int count);
+
+private:
+	static void* ThreadMain(void* self);
+
+	/** Run jobs of the current run() until none are left to take. Called
+	 * and returns with m_cond grabbed. */
+	void RunJobs();
+
+	THREAD_HANDLE* m_threads;
+	unsigned int m_thread_count;
+
+	/** Wakes the workers when there are jobs, and run() when the last
+	 * job has finished. */
+	PosixCondition m_cond;
+
+	VEGATileJob** m_jobs;
+	unsigned int m_job_count;
+	unsigned int m_next_job;
+	unsigned int m_unfinished;
+	bool m_quit;
+};
+
+PosixVEGATileWorkers::~PosixVEGATileWorkers()
+{
+	m_cond.Grab();
+	m_quit = true;
+	m_cond.WakeAll();
+	m_cond.Give();
+
+	for (unsigned int i = 0; i < m_thread_count; ++i)
+		PosixThread::Join(m_threads[i]);
+
+	OP_DELETEA(m_threads);
+}
+
+OP_STATUS PosixVEGATileWorkers::Start(unsigned int thread_count)
+{
+	m_threads = OP_NEWA(THREAD_HANDLE, thread_count);
+	RETURN_OOM_IF_NULL(m_threads);
+
+	while (m_thread_count < thread_count)
+	{
+		THREAD_HANDLE handle = PosixThread::CreateThread(ThreadMain, this);
+		if (handle == THREAD_HANDLE_NULL)
+			break;
+		m_threads[m_thread_count++] = handle;
+	}
+
+	return m_thread_count ? OpStatus::OK : OpStatus::ERR;
+}
+
+void PosixVEGATileWorkers::run(VEGATileJob** jobs, unsigned int count)
+{
+	m_cond.Grab();
+
+	m_jobs = jobs;
+	m_job_count = count;
+	m_next_job = 0;
+	m_unfinished = count;
+	m_cond.WakeAll();
+
+	RunJobs();
+	while (m_unfinished)
+		m_cond.Wait(false);
+
+	m_jobs = NULL;
+	m_job_count = m_next_job = 0;
+
+	m_cond.Give();
+}
+
+void PosixVEGATileWorkers::RunJobs()
+{
+	while (m_next_job < m_job_count)
+	{
+		VEGATileJob* job = m_jobs[m_next_job++];
+
+		m_cond.Give();
+		job->run();
+		m_cond.Grab();
+
+		if (--m_unfinished == 0)
+			m_cond.WakeAll();
+	}
+}
+
+/* static */
+void* PosixVEGATileWorkers::ThreadMain(void* self)
+{
+	PosixVEGATileWorkers* workers = static_cast<PosixVEGATileWorkers*>(self);
+
+	workers->m_cond.Grab();
+	while (!workers->m_quit)
+	{
+		if (workers->m_next_job < workers->m_job_count)
+			workers->RunJobs();
+		else
+			workers->m_cond.Wait(false);
+	}
+	workers->m_cond.Give();
+
+	return NULL;
+}
+
+/* static */
+OP_STATUS VEGATileWorkers::Create(VEGATileWorkers** workers)
+{
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+	if (processors < 2)
+		return OpStatus::ERR;
+
+	PosixVEGATileWorkers* pool = OP_NEW(PosixVEGATileWorkers, ());
+	RETURN_OOM_IF_NULL(pool);
+
+	OP_STATUS status = pool->Start(static_cast<unsigned int>(processors - 1));
+	if (OpStatus::IsError(status))
+	{
+		OP_DELETE(pool);
+		return status;
+	}
+
+	*workers = pool;
+	return OpStatus::OK;
+}
+
+#endif // POSIX_OK_VEGA_TILE_WORKERS
@@ -796,6 +796,7 @@ unsigned int UnixOpSystemInfo::GetCPUFeatures()
 	const int SSE2_MASK = 0x4000000; // sse2 capability is written on the 27th bit of edx
 	const int SSE3_MASK = 1; // // sse3 capability is written on the first bit of ecx
 	const int SSSE3_MASK = 0x200; // // ssse3 capability is written on the 10th bit of ecx
+	const int PCLMULQDQ_MASK = 2; // pclmulqdq capability is written on the second bit of ecx
 
 
 	asm ("mov $1, %%eax\n\t"
@@ -822,6 +823,10 @@ unsigned int UnixOpSystemInfo::GetCPUFeatures()
 	{
 		result |= CPU_FEATURES_IA32_SSSE3;
 	}
+	if (ecx & PCLMULQDQ_MASK)
+	{
+		result |= CPU_FEATURES_IA32_PCLMULQDQ;
+	}
 	if (edx & SSE2_MASK)
 	{
 		result |= CPU_FEATURES_IA32_SSE2;
@@ -3320,6 +3320,9 @@ unsigned int WindowsOpSystemInfo::GetCPUFeatures()
 
 		if (registers[2] & (1 <<  9))
 			ret |= CPU_FEATURES_IA32_SSSE3;
+
+		if (registers[2] & (1 <<  1))
+			ret |= CPU_FEATURES_IA32_PCLMULQDQ;
 	}
 
 	return ret;